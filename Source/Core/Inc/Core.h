@@ -101,6 +101,7 @@ CORE_API extern FOutputDevice*			GLogHook;
 CORE_API extern FExec*					GExecHook;
 CORE_API extern USystem*				GSys;
 CORE_API extern UProperty*				GProperty;
+CORE_API extern UObject*				GPropObject;
 CORE_API extern DWORD*					GBoolAddr;
 CORE_API extern char				    GErrorHist[4096];
 CORE_API extern char                    GComputerName[32];
@@ -148,11 +149,11 @@ extern "C" DLL_EXPORT char THIS_PACKAGE[];
 #include "UnClass.h"		// Class definition.
 #include "UnType.h"			// Base property type.
 #include "UnScript.h"		// Script class.
+#include "UnThread.h"		// Multithreading.
 #include "UnCache.h"		// Cache based memory management.
 #include "UnMem.h"			// Stack based memory management.
 #include "UnCId.h"			// Cache ID's.
 #include "UnConfig.h"		// Config cache.
-#include "UnThread.h"		// Multithreading.
 #include "UnStaticExports.h"	// Package exports for static builds.
 
 /*-----------------------------------------------------------------------------
@@ -22,11 +22,6 @@
 #define STATS 1
 #endif
 
-// Whether to check for memory leaks.
-#ifndef CHECK_ALLOCS
-#define CHECK_ALLOCS 0
-#endif
-
 // Whether to perform CPU-intensive timing of critical loops.
 #ifndef DO_SLOW_CLOCK
 #define DO_SLOW_CLOCK 0
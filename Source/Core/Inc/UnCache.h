@@ -33,7 +33,10 @@ public:
 			if( Cost < COST_INFINITE )
 				appErrorf( "Unlock: Item %08X.%08X is not locked", (DWORD)(Id>>32), (DWORD)Id );
 #endif
-			Cost -= COST_INFINITE;
+			if( Shared )
+				appInterlockedAdd( &Cost, -COST_INFINITE );
+			else
+				Cost -= COST_INFINITE;
 		}
 		QWORD GetId()
 		{
@@ -58,21 +61,24 @@ public:
 		}
 		typedef _WORD TCacheTime;
 	private:
-		// Private variables: Note 32-byte alignment.
+		// Private variables.
 		QWORD		Id;				// This item's cache id, 0=unused.
 		BYTE*		Data;			// Pointer to the item's data.
 		TCacheTime	Time;			// Last Get() time.
 		BYTE		Segment;		// Number of the segment this item resides in.
 		BYTE		Extra;			// Extra space for use.
+		BYTE		Shared;			// Whether it belongs to a concurrent cache.
 		INT			Cost;			// Cost to flush this item.
 		FCacheItem*	LinearNext;		// Next cache item in linear list, or NULL if last.
 		FCacheItem*	LinearPrev;		// Previous cache item in linear list, or NULL if first.
 		FCacheItem*	HashNext;		// Next cache item in hash table, or NULL if last.
+		FCacheItem*	FreeNext;		// Next free space item of the same size class.
+		FCacheItem**FreePrevLink;	// Link pointing to this item in its free list, or NULL if not listed.
 	};
 
 	// FMemCache interface.
-	FMemCache() {Initialized=0;}
-    void Init( INT BytesToAllocate, INT MaxItems, void* Start=NULL, INT SegSize=0 );
+	FMemCache() {Initialized=0; Concurrent=0;}
+    void Init( INT BytesToAllocate, INT MaxItems, void* Start=NULL, INT SegSize=0, UBOOL InConcurrent=0 );
 	void Exit( INT FreeMemory );
 	void Flush( QWORD Id=0, DWORD Mask=~0, UBOOL IgnoreLocked=0 );
 	BYTE* Create( QWORD Id, FCacheItem *&Item, INT CreateSize, INT Alignment=DEFAULT_ALIGNMENT, INT SafetyPad=0 );
@@ -90,8 +96,11 @@ public:
 	BYTE* Get( QWORD Id, FCacheItem*& Item, INT Alignment=DEFAULT_ALIGNMENT )
 	{	
 		guardSlow(FMemCache::Get);
+		if( Concurrent )
+			return GetConcurrent( Id, Item, Alignment );
 		clockSlow(GetCycles);
 		NumGets++;
+		TotalGets++;
 		if( Id==MruId )
 		{
 			Item = MruItem;
@@ -112,6 +121,7 @@ public:
 				return Align( HashItem->Data, Alignment );
 			}
 		}
+		NumMisses++;
 		unclockSlow(GetCycles);
 		return NULL;
 		unguardSlow;
@@ -122,10 +132,14 @@ private:
 	enum {COST_INFINITE=0x1000000};
 	enum {HASH_COUNT=16384};
 	enum {IGNORE_SIZE=256};
+	enum {FREE_CLASSES=32};
+	enum {SHARDS=16};
+	enum {EVICT_SCAN=128};
 
 	// Variables.
 	INT Initialized;
 	INT Time;
+	UBOOL Concurrent;
 	QWORD MruId;
 	FCacheItem* MruItem;
 
@@ -133,6 +147,8 @@ private:
 	INT NumGets,NumCreates,CreateCycles,GetCycles,TickCycles;
 	INT ItemsFresh,ItemsStale,ItemsTotal,ItemGaps;
 	INT MemFresh,MemStale,MemTotal;
+	INT NumMisses,TotalGets,TotalCreates,FreeFits,Evictions;
+	QWORD EvictedBytes;
 
 	// Linked list of item associated with cache memory, linked via LinearNext and
 	// LinearPrev order of memory.
@@ -141,6 +157,29 @@ private:
 	FCacheItem* LastItem;
 	void CreateNewFreeSpace( BYTE* Start, BYTE* End, FCacheItem* Prev, FCacheItem* Next, INT Segment );
 
+	// Free space items, listed by the highest bit of their size.
+	FCacheItem* FreeItems[FREE_CLASSES];
+	void LinkFree( FCacheItem* Item );
+	void UnlinkFree( FCacheItem* Item );
+	FCacheItem* FindFree( INT Size, INT Alignment );
+
+	// Where the next search for items to evict starts.
+	FCacheItem* EvictHand;
+
+	// Locking for concurrent use.  AllocMutex guards the item lists and
+	// every change to the hash table; each shard's mutex covers lookups and
+	// pins of the ids hashing to it, so a pin can't race an eviction.
+	UMUTEX AllocMutex;
+	UMUTEX ShardMutex[SHARDS];
+	INT GetShard( QWORD Id ) {return GHash(Id) & (SHARDS-1);}
+	void LockShards( DWORD Shards );
+	void UnlockShards( DWORD Shards );
+	BYTE* GetConcurrent( QWORD Id, FCacheItem*& Item, INT Alignment, UBOOL Count=1 );
+	UBOOL LockRun( FCacheItem* First, FCacheItem* Last, DWORD& Shards );
+	void DecayCost( FCacheItem* Item, INT Cost, UBOOL FirstStale );
+	void CountStat( INT& Stat, INT Amount );
+	friend class FCacheLock;
+
 	// First item in unused item list (these items are not associated with cache
 	// memory). Linked via LinearNext in FIFO order.
 	FCacheItem* UnusedItems;
@@ -61,6 +61,21 @@ public:
 	{}
 };
 
+//
+// One replicated property element in a class's flattened
+// replication layout, covering the whole superclass chain.
+//
+struct FRepRecord
+{
+	UProperty*	Property;		// Replicated property.
+	INT			Index;			// Array element.
+	INT			Offset;			// Byte offset of element within object.
+	INT			Size;			// Element size in bytes.
+	DWORD		BitMask;		// Bit mask if a bool, otherwise 0.
+	INT			iCondition;		// Index into the class's RepConditions.
+	UBOOL		Plain;			// Whether element can be compared bitwise.
+};
+
 /*-----------------------------------------------------------------------------
 	FLabelEntry.
 -----------------------------------------------------------------------------*/
@@ -302,6 +317,11 @@ class CORE_API UFunction : public UStruct
 	UState.
 -----------------------------------------------------------------------------*/
 
+//
+// Marks an EventCache entry which hasn't been looked up yet.
+//
+#define UNRESOLVED_EVENT ((UField*)-1)
+
 //
 // An UnrealScript state.
 //
@@ -317,6 +337,14 @@ class CORE_API UState : public UStruct
 	DWORD StateFlags;
 	_WORD LabelTableOffset;
 
+	// Event lookup cache: fields found in VfHash, indexed by event slot.
+	UField** EventCache;
+	INT EventCacheNum;
+
+	// Event slots, indexed by name index.
+	static TArray<INT> EventSlots;
+	static INT NumEventSlots;
+
 	// Constructors.
 	UState( EIntrinsicConstructor, INT InSize, FName InName, FName InPackageName );
 	UState( UState* InSuperState );
@@ -337,6 +365,22 @@ class CORE_API UState : public UStruct
 		return (UState*)SuperField;
 		unguardSlow;
 	}
+	static INT GetEventSlot( FName InName )
+	{
+		return InName.GetIndex()<EventSlots.Num() ? EventSlots(InName.GetIndex()) : INDEX_NONE;
+	}
+	static void AddEventSlot( FName InName );
+	static void RemoveEventSlot( INT NameIndex );
+	void ClearEventCache();
+	UField* FindEvent( INT iEvent, FName InName )
+	{
+		guardSlow(UState::FindEvent);
+		if( iEvent<EventCacheNum && EventCache[iEvent]!=UNRESOLVED_EVENT )
+			return EventCache[iEvent];
+		return ResolveEvent( iEvent, InName );
+		unguardSlow;
+	}
+	UField* ResolveEvent( INT iEvent, FName InName );
 };
 
 /*-----------------------------------------------------------------------------
@@ -392,6 +436,9 @@ class CORE_API UClass : public UState
 	TArray<BYTE>		Defaults;
 	UTextBuffer*		DefaultPropText;
 	FRepLink*			Reps;
+	TArray<FRepRecord>	RepRecords;
+	TArray<UProperty*>	RepConditions;
+	UBOOL				RepLayoutValid;
 	void(*Constructor)(void*);
 	void(*ClassInitializer)(UClass*);
 
@@ -448,6 +495,7 @@ class CORE_API UClass : public UState
 		return (UObject*)&Defaults(0);
 		unguardobjSlow;
 	}
+	void BuildRepLayout();
 	class AActor* GetDefaultActor()
 	{
 		guardSlow(UClass::GetDefaultActor);
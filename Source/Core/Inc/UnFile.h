@@ -54,6 +54,9 @@ CORE_API class FGuid appCreateGuid();
 CORE_API void appCreateTempFilename( const char* Path, char* Result256 );
 CORE_API UBOOL appMoveFile( const char* Src, const char* Dest );
 CORE_API UBOOL appCopyFile( const char* Src, const char* Dest );
+CORE_API const BYTE* appMapFile( FILE* Stream, INT Size );
+CORE_API void appUnmapFile( const BYTE* Data, INT Size );
+CORE_API void appPrefetchFile( const BYTE* Data, INT Offset, INT Size );
 CORE_API void appCleanFileCache();
 CORE_API UBOOL appFindPackageFile( const char* In, const FGuid* Guid, char* Out );
 CORE_API void appHandleSuspendResume( UBOOL bIsSuspending );
@@ -393,6 +396,7 @@ CORE_API void* appMalloc( INT Count, const char* Tag );
 CORE_API void appFree( void* Original );
 CORE_API void* appRealloc( void* Original, INT Count, const char* Tag );
 CORE_API void appDumpAllocs( class FOutputDevice* Out );
+CORE_API void appMemStats( class FOutputDevice* Out );
 
 //
 // C++ style memory allocation.
@@ -415,6 +419,30 @@ inline void operator delete( void* Ptr )
 	appFree( Ptr );
 	unguard;
 }
+inline void operator delete( void* Ptr, size_t )
+{
+	guard( "operator delete" );
+	appFree( Ptr );
+	unguard;
+}
+inline void* operator new[]( size_t Size )
+{
+	guard( "operator new" );
+	return appMalloc( Size, "new" );
+	unguard;
+}
+inline void operator delete[]( void* Ptr )
+{
+	guard( "operator delete" );
+	appFree( Ptr );
+	unguard;
+}
+inline void operator delete[]( void* Ptr, size_t )
+{
+	guard( "operator delete" );
+	appFree( Ptr );
+	unguard;
+}
 
 /*-----------------------------------------------------------------------------
 	Fast inline memory copy/fill functions.
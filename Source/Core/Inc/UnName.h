@@ -36,7 +36,6 @@ struct FNameEntry
 	// Variables.
 	NAME_INDEX	Index;				// Index of name in hash.
 	DWORD		Flags;				// RF_TagImp, RF_TagExp, RF_Intrinsic.
-	FNameEntry*	HashNext;			// Pointer to the next entry in this hash bin's linked list.
 
 	// The name string.
 	char		Name[NAME_SIZE];	// Name, variable-sized.
@@ -49,20 +48,30 @@ struct FNameEntry
 		return Ar << E.Flags;
 		unguard;
 	}
-	friend FNameEntry* AllocateNameEntry( const char* Name, DWORD Index, DWORD Flags, FNameEntry* HashNext )
+	friend FNameEntry* AllocateNameEntry( const char* Name, DWORD Index, DWORD Flags )
 	{
 		guard(AllocateNameEntry);
 
 		FNameEntry *NameEntry = (FNameEntry*)appMalloc( sizeof(FNameEntry) + appStrlen(Name) + 1 - NAME_SIZE, "NameEntry" );
 		NameEntry->Index      = Index;
 		NameEntry->Flags      = Flags;
-		NameEntry->HashNext   = HashNext;
 		appStrcpy( NameEntry->Name, Name );
 		return NameEntry;
 
 		unguard;
 	}
 };
+FNameEntry* AllocateNameEntry( const char* Name, DWORD Index, DWORD Flags );
+
+//
+// A slot in the open-addressed name hash.  The full hash is kept so that
+// most mismatches are rejected without a string compare.
+//
+struct FNameSlot
+{
+	DWORD		Hash;				// appStrihash of the name.
+	FNameEntry*	Entry;				// The name, or NULL if the slot is empty.
+};
 
 /*----------------------------------------------------------------------------
 	FName.
@@ -154,9 +163,15 @@ private:
 	// Static subsystem variables.
 	static TArray<FNameEntry*>	Names;			 // Table of all names.
 	static TArray<INT>          Available;       // Indices of available names.
-	static FNameEntry*			NameHash[8192];  // Hashed names.
+	static FNameSlot*			NameHash;		 // Hashed names, open-addressed.
+	static INT					NameHashMask;	 // Number of slots in NameHash minus one.
+	static INT					NameHashNum;	 // Names in NameHash.
 	static INT					Duplicate;       // Duplicate name, if any.
 	static UBOOL				Initialized;     // Set by InitTables.
+
+	// Name hash.
+	static void HashEntry( FNameEntry* Entry, DWORD Hash );
+	static void UnhashEntry( FNameEntry* Entry );
 };
 
 /*----------------------------------------------------------------------------
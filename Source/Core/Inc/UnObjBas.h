@@ -406,6 +406,23 @@ public: \
 	FObjectManager.
 ----------------------------------------------------------------------------*/
 
+//
+// A slot in the object hash.  The name and parent are kept alongside the
+// object, so that probing doesn't have to touch the objects themselves.
+//
+struct FObjectSlot
+{
+	UObject*	Object;		// The object, or NULL if the slot is empty.
+	UObject*	Parent;		// Its parent.
+	NAME_INDEX	Name;		// Its name.
+};
+
+//
+// Called when a package requested with RequestPackage has been loaded,
+// with the package or NULL if loading failed.
+//
+typedef void (*FAsyncLoadCallback)( UObject* Package, void* UserData );
+
 //
 // The global object manager.  This tracks all information about all
 // active objects, names, types, and files.
@@ -455,6 +472,15 @@ public:
 	virtual void ResetConfig( UClass* Class, const char* SrcFilename=NULL, const char* DestFilename=NULL );
 	virtual void GetRegistryObjects( TArray<FRegistryObjectInfo>& Results, UClass* Class, UClass* MetaClass, UBOOL ForceRefresh );
 	virtual void GetPreferences( TArray<FPreferencesInfo>& Results, const char* Category, UBOOL ForceRefresh );
+	virtual void AddTenureClass( UClass* Class );
+	virtual void RequestPackage( const char* Filename, FAsyncLoadCallback Callback=NULL, void* UserData=NULL );
+	virtual void FlushAsyncLoading();
+	virtual UBOOL TakePreloadedFile( const char* Filename, BYTE*& Data, INT Size );
+
+	// Write barrier: call after storing an object reference in Obj, so a
+	// minor collection in progress scans it again before finishing.
+	void NoteWrite( UObject* Obj ) {if( IncrementalGC && Obj ) NoteWriteSlow( Obj );}
+	UBOOL IsCollecting() {return IncrementalGC!=NULL;}
 
 	// Accessors.
 	virtual UBOOL GetInitialized() {return Initialized;}
@@ -468,13 +494,26 @@ private:
 	// Variables.
 	static UBOOL				Initialized;		// Whether initialized.
 	static INT					BeginLoadCount;		// Count for BeginLoad multiple loads.
-	static UObject*				ObjHash[4096];		// Object hash.
+	static struct FObjectSlot*	ObjHash;			// Object hash, open-addressed.
+	static INT					ObjHashBits;		// Log2 of the number of slots in ObjHash.
+	static INT					ObjHashNum;			// Objects in ObjHash.
 	static UObject*				AutoRegister;		// Objects to automatically register.
 	static TArray<UObject*>		Root;				// Top of active object graph.
 	static TArray<UObject*>		Objects;			// List of all objects.
 	static TArray<INT>          Available;			// Available object indices.
 	static TArray<UObject*>		Loaders;			// Array of loaders.
 	static UPackage*			TransientPackage;	// Transient package.
+	static TArray<BYTE>			ObjectGen;			// Garbage collection generation of each object.
+	static TArray<BYTE>			ObjectDirty;		// Whether each object is in DirtyObjects.
+	static TArray<INT>			DirtyObjects;		// Objects written during a minor collection.
+	static TArray<UClass*>		TenureClasses;		// Classes whose loaded objects may be tenured.
+	static class FArchiveTagUsed* IncrementalGC;		// Minor collection in progress, if any.
+	static DOUBLE				LastGCTime;			// Time the last collection finished.
+	static FLOAT				MinorGCInterval;	// Seconds between minor collections, 0=never.
+	static FLOAT				MinorGCBudget;		// Milliseconds of marking per tick.
+	static INT					GCThreads;			// Threads for marking, 0=one per core.
+	static FLOAT				AsyncLoadBudget;	// Milliseconds of package loading per tick.
+	static class FAsyncLoader*	AsyncLoader;		// Background package reads, if any.
 
 	// Temporary.
 	FName TempState, TempGroup; //oldver
@@ -489,7 +528,18 @@ private:
 	void UnhashObject( UObject* Res );
 	UBOOL ResolveName( UObject*& ObjectParent, const char*& Name, UBOOL Create, UBOOL Throw );
 	void SafeLoadError( DWORD LoadFlags, const char* Error, const char* Fmt, ... );
-	void PurgeGarbage( FOutputDevice* Out );
+	void PurgeGarbage( FOutputDevice* Out, UBOOL PurgeNames=1 );
+	UBOOL IsTenurable( UObject* Obj );
+	void BeginMinorGC( DWORD KeepFlags );
+	UBOOL StepMinorGC( DOUBLE EndTime );
+	void AbortMinorGC();
+	void NoteWriteSlow( UObject* Obj );
+	void ClearDirty();
+	void TickAsyncLoading( DOUBLE EndTime );
+	void ExitAsyncLoading();
+	UBOOL StepAsyncLoading( struct FAsyncRequest* Request, DOUBLE EndTime );
+	void QueueAsyncFile( struct FAsyncRequest* Request, const char* PackageName );
+	void ReleasePreloaded( UObject* Package );
 };
 
 /*-----------------------------------------------------------------------------
@@ -510,11 +560,12 @@ class CORE_API UObject : public FUnknown
 
 	// Friends.
 	friend class FObjectManager;
+	friend class FArchiveTagUsed;
 
 private:
 	// Variables maintained by FObjectManager.
 	INT			    Index;			// Index of object into FObjectManager's Objects table.
-	UObject*		HashNext;		// Next object in this hash bin.
+	UObject*		HashNext;		// Unused, the object hash is open-addressed.
 	FMainFrame*		MainFrame;		// Main script execution stack.
 	ULinkerLoad*	Linker;			// Linker it came from, or NULL if none.
 	DWORD			LinkerIndex;	// Index of this object in the linker's export map.
@@ -602,10 +653,6 @@ public:
 		// Note: Must be safe with class-default metaobjects.
 		return ((UObject*)Class)->GetName();
 	}
-	INT	GetHash() const
-	{
-		return Name.GetIndex() & (ARRAY_COUNT(FObjectManager::ObjHash)-1);
-	}
 	DWORD GetFlags() const
 	{
 		return ObjectFlags;
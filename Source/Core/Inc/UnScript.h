@@ -191,6 +191,23 @@ BYTE CORE_API GRegisterIntrinsic( int iIntrinsic, void* Func );
 	static BYTE func##Temp = GRegisterIntrinsic(num,*(void**)&int##cls##func); \
 	STATIC_EXPORT( cls##func, int##cls##func )
 
+/*-----------------------------------------------------------------------------
+	Script profiler.
+-----------------------------------------------------------------------------*/
+
+//
+// Instrumenting profiler for script functions and events, which keeps a
+// call tree with call counts and inclusive and exclusive times.
+//
+struct CORE_API FScriptProfiler
+{
+	static UBOOL Enabled;
+	static void Enter( UFunction* Function, UState* State );
+	static void Leave();
+	static void PurgeGarbage();
+	static UBOOL Exec( const char* Cmd, FOutputDevice* Out );
+};
+
 /*-----------------------------------------------------------------------------
 	Macros.
 -----------------------------------------------------------------------------*/
@@ -215,7 +232,7 @@ BYTE CORE_API GRegisterIntrinsic( int iIntrinsic, void* Func );
 #define P_GET_NAME_REF(var)         FName a##var=NAME_None,*var=&a##var;      {Stack.Step( Stack.Object, *(BYTE**)&var );          }
 #define P_GET_ACTOR(var)            AActor       *var;   {AActor **Ptr=&var;   Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
 #define P_GET_ACTOR_OPT(var,def)    AActor   *var=def;   {AActor **Ptr=&var;   Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
-#define P_GET_ACTOR_REF(var)        AActor *a##var=NULL,**var=&a##var;        {Stack.Step( Stack.Object, *(BYTE**)&var );          }
+#define P_GET_ACTOR_REF(var)        AActor *a##var=NULL,**var=&a##var;        {GPropObject=NULL; Stack.Step( Stack.Object, *(BYTE**)&var ); GObj.NoteWrite( GPropObject );}
 #define P_GET_VECTOR(var)           FVector       var;   {FVector *Ptr=&var;   Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
 #define P_GET_VECTOR_OPT(var,def)   FVector   var=def;   {FVector *Ptr=&var;   Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
 #define P_GET_VECTOR_REF(var)       FVector a##var(0,0,0),*var=&a##var;       {Stack.Step( Stack.Object, *(BYTE**)&var );          }
@@ -224,13 +241,13 @@ BYTE CORE_API GRegisterIntrinsic( int iIntrinsic, void* Func );
 #define P_GET_ROTATOR_REF(var)      FRotator  a##var(0,0,0),*var=&a##var;     {Stack.Step( Stack.Object, *(BYTE**)&var );          }
 #define P_GET_OBJECT(cls,var)       cls          *var;   {cls**Ptr=&var;       Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
 #define P_GET_OBJECT_OPT(var,def)   UObject*var=def;     {UObject**Ptr=&var;   Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
-#define P_GET_OBJECT_REF(var)       UObject*a##var=NULL,**var=&a##var;        {Stack.Step( Stack.Object, *(BYTE**)&var );          }
+#define P_GET_OBJECT_REF(var)       UObject*a##var=NULL,**var=&a##var;        {GPropObject=NULL; Stack.Step( Stack.Object, *(BYTE**)&var ); GObj.NoteWrite( GPropObject );}
 #define P_GET_STRING(var)           CHAR var##T[MAX_STRING_CONST_SIZE], *var=var##T; {Stack.Step( Stack.Object,*(BYTE**)&var);     }
 #define P_GET_STRING_OPT(var,def)   CHAR var##T[MAX_STRING_CONST_SIZE]=def, *var=var##T; {Stack.Step( Stack.Object,*(BYTE**)&var); }
 #define P_GET_STRING_REF(var)       CHAR a##var[MAX_STRING_CONST_SIZE],*var=a##var; {Stack.Step( Stack.Object, *(BYTE**)&var );          }
 #define P_GET_STRUCT(typ,var)       typ var; {typ *Ptr=&var; Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
 #define P_GET_STRUCT_OPT(typ,var,def) typ var=def; {typ *Ptr=&var; Stack.Step( Stack.Object, *(BYTE**)&Ptr ); var=*Ptr;}
-#define P_GET_STRUCT_REF(typ,var)   typ a##var,*var=&a##var; {Stack.Step( Stack.Object, *(BYTE**)&var );}
+#define P_GET_STRUCT_REF(typ,var)   typ a##var,*var=&a##var; {GPropObject=NULL; Stack.Step( Stack.Object, *(BYTE**)&var ); GObj.NoteWrite( GPropObject );}
 #define P_GET_SKIP_OFFSET(var)      _WORD var; {debug(*Stack.Code==EX_Skip); Stack.Code++; var=*(_WORD*)Stack.Code; Stack.Code+=2; }
 #define P_FINISH                    {Stack.Code++;}
 
@@ -269,9 +286,40 @@ inline void FFrame::Step( UObject* Context, BYTE*& Result )
 {
 	guardSlow(FFrame::Step);
 	BYTE B = *Code++;
-	(Context->*GIntrinsics[B])( *this, Result );
+
+	// Local and instance variables are by far the most common operands,
+	// so resolve them here rather than through the intrinsic table.
+	// This must match execLocalVariable and execInstanceVariable exactly.
+	if( B==EX_LocalVariable )
+	{
+		GProperty   = *(UProperty**)Code;
+		GPropObject = NULL;
+		Code       += sizeof(UProperty*);
+		Result      = Locals + GProperty->Offset;
+	}
+	else if( B==EX_InstanceVariable )
+	{
+		GProperty   = *(UProperty**)Code;
+		GPropObject = Context;
+		Code       += sizeof(UProperty*);
+		Result      = (BYTE*)Context + GProperty->Offset;
+	}
+	else (Context->*GIntrinsics[B])( *this, Result );
+
 	unguardSlow;
 }
+//
+// Write barrier for a script store into a variable of Owner, which is
+// NULL for locals.  Only variables which can hold references matter.
+//
+inline void NoteScriptWrite( UObject* Owner, UProperty* Property )
+{
+	if
+	(	Owner
+	&&	GObj.IsCollecting()
+	&&	(Property->IsA(UObjectProperty::StaticClass) || Property->IsA(UStructProperty::StaticClass)) )
+		GObj.NoteWrite( Owner );
+}
 inline INT FFrame::ReadInt()
 {
 	INT Result = *(INT*)Code;
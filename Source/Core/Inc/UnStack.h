@@ -29,6 +29,7 @@ struct CORE_API FFrame
 
 	// Functions.
 	void Step( UObject* Context, BYTE*& Result );
+	void ExecStatements();
 	void CDECL ScriptWarn( UBOOL Critical, char* Fmt, ... );
 	INT ReadInt();
 	FLOAT ReadFloat();
@@ -75,6 +76,7 @@ struct FOutParmRec
 	BYTE* Dest;
 	BYTE* Src;
 	INT Size;
+	UObject* Owner;
 };
 
 /*-----------------------------------------------------------------------------
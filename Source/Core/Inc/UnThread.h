@@ -9,6 +9,7 @@
 
 typedef void* UTHREAD;
 typedef void* UMUTEX;
+typedef void* UEVENT;
 
 #ifdef PLATFORM_WIN32
 typedef DWORD THREAD_RET;
@@ -21,6 +22,16 @@ typedef THREAD_RET ( *THREAD_FUNC )( void* Arg );
 // Thread operations.
 CORE_API UTHREAD appThreadSpawn( THREAD_FUNC Func, void* Arg, const char* Name, UBOOL bDetach, DWORD* OutThreadId );
 CORE_API THREAD_RET appThreadJoin( UTHREAD Thread );
+CORE_API INT appNumCores();
+
+// Atomically AND a value with Mask, returning the previous value.
+CORE_API DWORD appInterlockedAnd( volatile DWORD* Dest, DWORD Mask );
+
+// Atomically add Value to a value, returning the previous value.
+CORE_API INT appInterlockedAdd( volatile INT* Dest, INT Value );
+
+// Atomically set a value to Exchange if it equals Comparand, returning the previous value.
+CORE_API INT appInterlockedCompareExchange( volatile INT* Dest, INT Exchange, INT Comparand );
 
 // Recursive mutex operations.
 CORE_API UMUTEX appMutexCreate( const char* Name );
@@ -28,6 +39,13 @@ CORE_API UBOOL appMutexLock( UMUTEX Mutex );
 CORE_API UBOOL appMutexUnlock( UMUTEX Mutex );
 CORE_API void appMutexFree( UMUTEX Mutex );
 
+// Auto-reset event operations.  Triggering wakes one waiter, or the
+// next thread to wait if none is waiting.
+CORE_API UEVENT appEventCreate( const char* Name );
+CORE_API void appEventTrigger( UEVENT Event );
+CORE_API void appEventWait( UEVENT Event );
+CORE_API void appEventFree( UEVENT Event );
+
 // Mutex object.
 class CORE_API FMutex
 {
@@ -67,3 +85,27 @@ public:
 private:
 	FMutex& Mutex;
 };
+
+// Event object.
+class CORE_API FEvent
+{
+public:
+	FEvent( const char* InName ) : Name( InName )
+	{
+		Handle = appEventCreate( InName );
+		check(Handle);
+	}
+
+	~FEvent()
+	{
+		appEventFree( Handle );
+		Handle = nullptr;
+	}
+
+	void Trigger() { appEventTrigger( Handle ); }
+	void Wait() { appEventWait( Handle ); }
+
+private:
+	UEVENT Handle;
+	const char* Name;
+};
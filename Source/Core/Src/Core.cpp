@@ -21,6 +21,7 @@ CORE_API FTransactionTracker* GUndo=NULL;
 CORE_API FOutputDevice* GLogHook=NULL;
 CORE_API FExec* GExecHook=NULL;
 CORE_API UProperty* GProperty;
+CORE_API UObject* GPropObject;
 CORE_API DWORD* GBoolAddr;
 CORE_API DOUBLE GSecondsPerCycle=1.0;
 CORE_API SQWORD GTicks=1;
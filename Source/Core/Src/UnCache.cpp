@@ -24,7 +24,8 @@ void FMemCache::Init
 	INT		BytesToAllocate,	// Number of bytes for the cache.
 	INT		MaxItems,			// Maximum cache items to track.
 	void*	Start,				// Start of preallocated cache memory, NULL=allocate it.
-	INT		SegmentSize			// Size of segment boundary, or 0=unsegmented.
+	INT		SegmentSize,		// Size of segment boundary, or 0=unsegmented.
+	UBOOL	InConcurrent		// Whether the cache may be used by several threads.
 )
 {
 	guard(FMemCache::Init);
@@ -35,6 +36,10 @@ void FMemCache::Init
 	ItemsTotal = MaxItems;
 	MruId      = 0;
 	MruItem    = NULL;
+	NumMisses  = TotalGets = TotalCreates = FreeFits = Evictions = 0;
+	EvictedBytes = 0;
+	for( INT i=0; i<FREE_CLASSES; i++ )
+		FreeItems[i] = NULL;
 
 	// Allocate cache memory.
 	if( Start ) CacheMemory = (BYTE *)Start;
@@ -48,6 +53,7 @@ void FMemCache::Init
 	FCacheItem** PrevLink = &UnusedItems;
 	for( INT i=0; i<MaxItems; i++ )
 	{
+		UnusedItemMemory[i].FreePrevLink = NULL;
 		*PrevLink = &UnusedItemMemory[i];
 		PrevLink  = &UnusedItemMemory[i].LinearNext;
 	}
@@ -98,10 +104,25 @@ void FMemCache::Init
 		Segment
 	);
 
+	// List the free space, now that each segment knows where it ends.
+	for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
+		if( !Item->FreePrevLink )
+			LinkFree( Item );
+	EvictHand = CacheItems;
+
 	// Init the hash table to empty since no items are used.
 	for(int i=0; i<HASH_COUNT; i++ )
 		HashItems[i] = NULL;
 
+	// Create the locks for concurrent use.
+	Concurrent = InConcurrent;
+	if( Concurrent )
+	{
+		AllocMutex = appMutexCreate( "CacheAlloc" );
+		for( INT i=0; i<SHARDS; i++ )
+			ShardMutex[i] = appMutexCreate( "CacheShard" );
+	}
+
 	// Success.
 	Initialized=1;
 	CheckState();
@@ -119,16 +140,214 @@ void FMemCache::Exit( int FreeMemory )
 	// Release all memory.
 	appFree( ItemMemory );
 	if( FreeMemory ) appFree( CacheMemory );
+	if( Concurrent )
+	{
+		appMutexFree( AllocMutex );
+		for( INT i=0; i<SHARDS; i++ )
+			appMutexFree( ShardMutex[i] );
+		Concurrent = 0;
+	}
 
 	// Success.
 	Initialized = 0;
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Concurrent use.
+-----------------------------------------------------------------------------*/
+
+//
+// Holds every lock of a concurrent cache for its lifetime.
+//
+class FCacheLock
+{
+public:
+	FCacheLock( FMemCache* InCache )
+	:	Cache( InCache )
+	{
+		if( Cache->Concurrent )
+		{
+			appMutexLock( Cache->AllocMutex );
+			Cache->LockShards( (1<<FMemCache::SHARDS)-1 );
+		}
+	}
+	~FCacheLock()
+	{
+		if( Cache->Concurrent )
+		{
+			Cache->UnlockShards( (1<<FMemCache::SHARDS)-1 );
+			appMutexUnlock( Cache->AllocMutex );
+		}
+	}
+private:
+	FMemCache* Cache;
+};
+
+//
+// Add to a stat that several threads may count at once.
+//
+inline void FMemCache::CountStat( INT& Stat, INT Amount )
+{
+	if( Concurrent )
+		appInterlockedAdd( &Stat, Amount );
+	else
+		Stat += Amount;
+}
+
+//
+// Lock or unlock a set of hash shards, in shard order.
+//
+void FMemCache::LockShards( DWORD Shards )
+{
+	for( INT i=0; i<SHARDS; i++ )
+		if( Shards & (1<<i) )
+			appMutexLock( ShardMutex[i] );
+}
+void FMemCache::UnlockShards( DWORD Shards )
+{
+	for( INT i=0; i<SHARDS; i++ )
+		if( Shards & (1<<i) )
+			appMutexUnlock( ShardMutex[i] );
+}
+
+//
+// Get for concurrent use.  The MRU shortcut isn't used since another
+// thread could change it between testing the id and reading the item.
+// Create's re-check passes Count=0 so the miss isn't counted twice.
+//
+BYTE* FMemCache::GetConcurrent( QWORD Id, FCacheItem*& Item, INT Alignment, UBOOL Count )
+{
+	guardSlow(FMemCache::GetConcurrent);
+	INT Shard = GetShard( Id );
+	appMutexLock( ShardMutex[Shard] );
+	if( Count )
+	{
+		appInterlockedAdd( &NumGets, 1 );
+		appInterlockedAdd( &TotalGets, 1 );
+	}
+	for( FCacheItem* HashItem=HashItems[GHash(Id)]; HashItem; HashItem=HashItem->HashNext )
+	{
+		if( HashItem->Id == Id )
+		{
+			Item           = HashItem;
+			HashItem->Time = Time;
+			appInterlockedAdd( &HashItem->Cost, COST_INFINITE );
+			appMutexUnlock( ShardMutex[Shard] );
+			return Align( HashItem->Data, Alignment );
+		}
+	}
+	if( Count )
+		appInterlockedAdd( &NumMisses, 1 );
+	appMutexUnlock( ShardMutex[Shard] );
+	return NULL;
+	unguardSlow;
+}
+
+//
+// Lock the shards of the items in a run chosen for eviction.  Returns 0
+// with nothing locked if another thread pinned one of the items after
+// the run was costed.
+//
+UBOOL FMemCache::LockRun( FCacheItem* First, FCacheItem* Last, DWORD& Shards )
+{
+	guard(FMemCache::LockRun);
+	Shards = 0;
+	FCacheItem* Item;
+	for( Item=First; ; Item=Item->LinearNext )
+	{
+		if( Item->Id )
+			Shards |= 1 << GetShard( Item->Id );
+		if( Item==Last )
+			break;
+	}
+	LockShards( Shards );
+	for( Item=First; ; Item=Item->LinearNext )
+	{
+		if( Item->Cost >= COST_INFINITE )
+		{
+			UnlockShards( Shards );
+			return 0;
+		}
+		if( Item==Last )
+			break;
+	}
+	return 1;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	Internal functions.
 -----------------------------------------------------------------------------*/
 
+//
+// Return the free list for items of a size.
+//
+static inline INT FreeClass( INT Size )
+{
+	INT Class = 0;
+	while( Size >>= 1 )
+		Class++;
+	return Class;
+}
+
+//
+// Add a free space item to the list for its size.  The empty last item
+// is never listed.
+//
+inline void FMemCache::LinkFree( FCacheItem* Item )
+{
+	guardSlow(FMemCache::LinkFree);
+	debug( Item->Id==0 );
+	debug( Item->FreePrevLink==NULL );
+	if( Item->LinearNext )
+	{
+		FCacheItem** Head  = &FreeItems[FreeClass(Item->LinearNext->Data - Item->Data)];
+		Item->FreeNext     = *Head;
+		Item->FreePrevLink = Head;
+		if( Item->FreeNext )
+			Item->FreeNext->FreePrevLink = &Item->FreeNext;
+		*Head = Item;
+	}
+	unguardSlow;
+}
+
+//
+// Remove an item from its free list, if it's listed.  Must be called
+// before a free item's size changes.
+//
+inline void FMemCache::UnlinkFree( FCacheItem* Item )
+{
+	guardSlow(FMemCache::UnlinkFree);
+	if( Item->FreePrevLink )
+	{
+		*Item->FreePrevLink = Item->FreeNext;
+		if( Item->FreeNext )
+			Item->FreeNext->FreePrevLink = Item->FreePrevLink;
+		Item->FreePrevLink = NULL;
+	}
+	unguardSlow;
+}
+
+//
+// Find a free space item with room for Size bytes at an alignment, or NULL.
+// Items in the size's own class may be too small, so only a few of them
+// are tried before moving on to the larger classes.
+//
+FMemCache::FCacheItem* FMemCache::FindFree( INT Size, INT Alignment )
+{
+	guardSlow(FMemCache::FindFree);
+	for( INT Class=FreeClass(Size); Class<FREE_CLASSES; Class++ )
+	{
+		INT Tries = 0;
+		for( FCacheItem* Item=FreeItems[Class]; Item && Tries<EVICT_SCAN; Item=Item->FreeNext,Tries++ )
+			if( Item->LinearNext->Data - Align(Item->Data,Alignment) >= Size )
+				return Item;
+	}
+	return NULL;
+	unguardSlow;
+}
+
 //
 // Merge a cache item and its immediate successor into one
 // item, and remove the second. Returns the new merged item.
@@ -149,6 +368,12 @@ inline FMemCache::FCacheItem* FMemCache::MergeWithNext( FCacheItem* First )
 	debug( Second->LinearPrev == First );
 	debug( First->Segment == Second->Segment );
 
+	// Neither keeps its size, so take both off the free lists.
+	UnlinkFree( First );
+	UnlinkFree( Second );
+	if( EvictHand == Second )
+		EvictHand = First;
+
 	// Absorb the second item into the first.
 	First->LinearNext             = Second->LinearNext;
 	First->LinearNext->LinearPrev = First;
@@ -185,6 +410,10 @@ FMemCache::FCacheItem* FMemCache::FlushItem( FCacheItem* Item, UBOOL IgnoreLocke
 		// If next item is free space, merge with it.
 		if( Item->LinearNext && Item->LinearNext->Id==0 && Item->Segment==Item->LinearNext->Segment )
 			Item = MergeWithNext( Item );
+
+		// List the resulting free space.
+		UnlinkFree( Item );
+		LinkFree( Item );
 	}
 	else if( !IgnoreLocked )
 	{
@@ -204,6 +433,7 @@ void FMemCache::CheckState()
 
 	// Make sure we're initialized.
 	check( Initialized == 1 );
+	FCacheLock Lock( this );
 
 	// Make sure there's an initial item.
 	check( CacheItems != NULL );
@@ -286,6 +516,24 @@ void FMemCache::CheckState()
 	check( HashCount == UsedItemCount );
 	unguard;
 
+	// Make sure every free space item is listed once, by its size.
+	guard(4);
+	INT FreeCount=0, ListedCount=0;
+	for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
+		FreeCount += (Item->Id==0);
+	for( INT i=0; i<FREE_CLASSES; i++ )
+	{
+		for( FCacheItem* Item=FreeItems[i]; Item; Item=Item->FreeNext )
+		{
+			ListedCount++;
+			check( Item->Id==0 );
+			check( *Item->FreePrevLink==Item );
+			check( FreeClass(Item->LinearNext->Data - Item->Data)==i );
+		}
+	}
+	check( ListedCount==FreeCount );
+	unguard;
+
 	// Success.
 	unguard;
 }
@@ -318,7 +566,9 @@ void FMemCache::CreateNewFreeSpace
 	else if( Next && Next->Id==0 && Next->Segment==Segment )
 	{
 		// The next item is free space, so merge with it.
+		UnlinkFree( Next );
 		Next->Data = Start;
+		LinkFree( Next );
 	}
 	else
 	{
@@ -338,6 +588,7 @@ void FMemCache::CreateNewFreeSpace
 		Item->LinearNext	= Next;
 		Item->LinearPrev	= Prev;
 		Item->HashNext		= NULL;
+		Item->FreePrevLink	= NULL;
 
 		// Link it in.
 		if( Prev )
@@ -347,6 +598,7 @@ void FMemCache::CreateNewFreeSpace
 
 		if( Next )
 			Next->LinearPrev = Item;
+		LinkFree( Item );
 	}
 	unguard;
 }
@@ -363,6 +615,7 @@ void FMemCache::CreateNewFreeSpace
 void FMemCache::Flush( QWORD Id, DWORD Mask, UBOOL IgnoreLocked )
 {
 	guard(FMemCache::Flush);
+	FCacheLock Lock( this );
 	MruId     = 0;
 	MruItem   = NULL;
 
@@ -431,10 +684,11 @@ void FMemCache::Flush( QWORD Id, DWORD Mask, UBOOL IgnoreLocked )
 //
 // Create an element in the cache.
 //
-// This is O(num_items_in_cache), sacrificing some speed in the
-// name of better cache efficiency. However there aren't any really
-// good algorithms for priority queues where most priorities change
-// every iteration this that I'm aware of.
+// Free space big enough for the item is found through the size class
+// lists.  Otherwise the shortest contiguous run of items with the lowest
+// total cost is evicted.  Costs decay as items go stale, making this
+// an approximate LRU.  The search starts where the last eviction left off
+// and stops EVICT_SCAN items after the first run that fits.
 //
 BYTE* FMemCache::Create
 (
@@ -446,47 +700,120 @@ BYTE* FMemCache::Create
 )
 {
 	guard(FMemCache::Create);
-	uclock(CreateCycles);
+	DWORD StartCycles = appCycles();
 	check( Initialized );
 	check( CreateSize > 0 );
 	check( Id != 0 );
-	NumCreates++;
+	CountStat( NumCreates, 1 );
+	CountStat( TotalCreates, 1 );
+
+	// With several threads, another one may have created this item since
+	// our Get missed, in which case it's shared.
+	if( Concurrent )
+	{
+		appMutexLock( AllocMutex );
+		BYTE* Existing = GetConcurrent( Id, Item, Alignment, 0 );
+		if( Existing )
+		{
+			appMutexUnlock( AllocMutex );
+			CountStat( CreateCycles, appCycles() - StartCycles );
+			return Existing;
+		}
+	}
 
 	// Best cost and starting element found thus far.
-	SQWORD	    BestCost  = COST_INFINITE;
-	FCacheItem* BestFirst = NULL;
-	FCacheItem* BestLast  = NULL;
-
-	// Iterate through items. Find shortest contiguous sets of items
-	// which contain enough space for this entry. Evaluate the sum cost
-	// for each set, remembering the best cost.
-	SQWORD Cost=0;
-	FCacheItem* First=CacheItems;
-	for( FCacheItem* Last=CacheItems; Last!=LastItem; Last=Last->LinearNext )
-	{
-		// Add the cost and size of new Last element to our accumulator.
-		Cost += Last->Cost;
-
-		// While the interval from First to Last (inclusive) contains
-		// enough space for the item we're creating, consider it as a
-		// candidate, and go to the next First.
-		while( First && (Last->LinearNext->Data - Align(First->Data,Alignment) >= (CreateSize+SafetyPad)) )
+	SQWORD	    BestCost;
+	FCacheItem* BestFirst;
+	FCacheItem* BestLast;
+	DWORD       Shards = 0;
+	DOUBLE      WaitStart = 0.0;
+	for( ; ; )
+	{
+		BestCost  = COST_INFINITE;
+		BestFirst = FindFree( CreateSize+SafetyPad, Alignment );
+		BestLast  = BestFirst;
+		if( BestFirst )
+		{
+			FreeFits++;
+			break;
+		}
+		else
 		{
-			// Is this the best solution so far?
-			if( Cost<BestCost && First->Segment==Last->Segment )
+			// Iterate through items from the eviction hand, wrapping around once.
+			// Find shortest contiguous sets of items which contain enough space
+			// for this entry. Evaluate the sum cost for each set, remembering the
+			// best cost.
+			FCacheItem* Start = EvictHand!=LastItem ? EvictHand : CacheItems;
+			FCacheItem* First = Start;
+			FCacheItem* Last  = Start;
+			SQWORD      Cost  = 0;
+			INT         Scanned = 0;
+			UBOOL       Wrapped = 0;
+			for( ; ; )
 			{
-				BestCost  = Cost;
-				BestFirst = First;
-				BestLast  = Last;
+				if( Last==LastItem )
+				{
+					if( Wrapped || Start==CacheItems )
+						break;
+					Wrapped = 1;
+					First = Last = CacheItems;
+					Cost = 0;
+				}
+				if( BestFirst && (++Scanned>EVICT_SCAN || (Wrapped && Last==Start)) )
+					break;
+
+				// Add the cost and size of new Last element to our accumulator.
+				Cost += Last->Cost;
+
+				// While the interval from First to Last (inclusive) contains
+				// enough space for the item we're creating, consider it as a
+				// candidate, and go to the next First.
+				while( First && (Last->LinearNext->Data - Align(First->Data,Alignment) >= (CreateSize+SafetyPad)) )
+				{
+					// Is this the best solution so far?
+					if( Cost<BestCost && First->Segment==Last->Segment )
+					{
+						BestCost  = Cost;
+						BestFirst = First;
+						BestLast  = Last;
+					}
+
+					// Subtract the cost and size from the element we're passing:
+					Cost -= First->Cost;
+					debug(Cost>=0);
+
+					// Go to next First.
+					First = First->LinearNext;
+				}
+				Last = Last->LinearNext;
 			}
+		}
 
-			// Subtract the cost and size from the element we're passing:
-			Cost -= First->Cost;
-			debug(Cost>=0);
-
-			// Go to next First.
-			First = First->LinearNext;
+		// Every run that would fit may be pinned only for a moment by other
+		// threads, so give them a while to unpin before giving up.
+		if( !BestFirst && Concurrent )
+		{
+			if( WaitStart == 0.0 )
+				WaitStart = appSeconds();
+			if( appSeconds() - WaitStart < 2.0 )
+			{
+				appMutexUnlock( AllocMutex );
+				appSleep( 0.001 );
+				appMutexLock( AllocMutex );
+				BYTE* Existing = GetConcurrent( Id, Item, Alignment, 0 );
+				if( Existing )
+				{
+					appMutexUnlock( AllocMutex );
+					CountStat( CreateCycles, appCycles() - StartCycles );
+					return Existing;
+				}
+				continue;
+			}
 		}
+
+		// Keep other threads from pinning the run until it's unhashed.
+		if( !BestFirst || !Concurrent || LockRun(BestFirst,BestLast,Shards) )
+			break;
 	}
 
 	// See if we found a suitable place to put the item.
@@ -508,6 +835,18 @@ BYTE* FMemCache::Create
 		appErrorf( "Create %08x.%08X failed: Size=%i Pad=%i Align=%i NumLocked=%i BytesLocked=%i/%i", (DWORD)(Id>>32), (DWORD)Id, CreateSize, SafetyPad, Alignment, ItemsLocked, BytesLocked, Bytes );
 	}
 
+	// Count the items being evicted.
+	for( FCacheItem* Evicted=BestFirst; ; Evicted=Evicted->LinearNext )
+	{
+		if( Evicted->Id != 0 )
+		{
+			Evictions++;
+			EvictedBytes += Evicted->LinearNext->Data - Evicted->Data;
+		}
+		if( Evicted == BestLast )
+			break;
+	}
+
 	// Merge all items from Start to End into one bigger item,
 	// while unhashing them all.
 	while( BestLast != BestFirst )
@@ -516,6 +855,9 @@ BYTE* FMemCache::Create
 		BestLast = MergeWithNext( BestLast->LinearPrev );
 	}
 	if( BestFirst->Id != 0 ) Unhash( BestFirst->Id );
+	UnlinkFree( BestFirst );
+	if( Concurrent )
+		UnlockShards( Shards );
 
 	// Now we have a big free memory block from BestFirst->Data to 
 	// BestFirst->Data + BestFirst->Size.
@@ -525,13 +867,18 @@ BYTE* FMemCache::Create
 
 	// Claim BestFirst for the block we're creating, and lock it.
 	BestFirst->Time = (FCacheItem::TCacheTime)Time;
-	BestFirst->Id   = Id;
-	BestFirst->Cost = CreateSize + COST_INFINITE;
+	BestFirst->Id     = Id;
+	BestFirst->Cost   = CreateSize + COST_INFINITE;
+	BestFirst->Shared = Concurrent;
 
 	// Hash it.
+	if( Concurrent )
+		appMutexLock( ShardMutex[GetShard(Id)] );
 	FCacheItem** HashPtr	= &HashItems[GHash(Id)];
 	BestFirst->HashNext		= *HashPtr;
 	*HashPtr				= BestFirst;
+	if( Concurrent )
+		appMutexUnlock( ShardMutex[GetShard(Id)] );
 
 	// Create free space past the end of the newly allocated block.
 	if( UnusedItems && (Result + CreateSize < BestFirst->LinearNext->Data ) )
@@ -562,11 +909,15 @@ BYTE* FMemCache::Create
 		BestFirst->Data = Result;
 	}
 
-	// Set the resulting Item.
+	// Set the resulting Item, and start the next eviction search after it.
 	Item = BestFirst;
+	if( BestCost < COST_INFINITE )
+		EvictHand = BestFirst->LinearNext;
 
 	ConditionalCheckState();
-	uunclock(CreateCycles);
+	if( Concurrent )
+		appMutexUnlock( AllocMutex );
+	CountStat( CreateCycles, appCycles() - StartCycles );
 
 	return Result;
 	unguard;
@@ -576,6 +927,27 @@ BYTE* FMemCache::Create
 	Tick.
 -----------------------------------------------------------------------------*/
 
+//
+// Lower the cost of an unlocked item whose cost was Cost: by 3/4 when it
+// first becomes stale, then by 1/32 each tick.  With several threads,
+// another may pin the item meanwhile, in which case it's left alone.
+//
+inline void FMemCache::DecayCost( FCacheItem* Item, INT Cost, UBOOL FirstStale )
+{
+	if( !Concurrent )
+	{
+		Item->Cost = FirstStale ? (Cost >> 2) : Cost - (Cost >> 5);
+		return;
+	}
+	while( Cost < COST_INFINITE )
+	{
+		INT Old = appInterlockedCompareExchange( &Item->Cost, FirstStale ? (Cost >> 2) : Cost - (Cost >> 5), Cost );
+		if( Old == Cost )
+			break;
+		Cost = Old;
+	}
+}
+
 //
 // Handle time passing.
 //
@@ -583,6 +955,8 @@ void FMemCache::Tick()
 {
 	guard(FMemCache::Tick);
 	uclock(TickCycles);
+	if( Concurrent )
+		appMutexLock( AllocMutex );
 	ConditionalCheckState();
 	MruId     = 0;
 	MruItem   = NULL;
@@ -594,25 +968,28 @@ void FMemCache::Tick()
 	// Check each item.
 	for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
 	{
+		INT Cost = Item->Cost;
 		if( Item->Id == 0 )
 		{
 			ItemGaps++;
 		}
-		else if( Item->Cost >= COST_INFINITE )
+		else if( Cost >= COST_INFINITE )
 		{
-			appErrorf( "Cache item %08X still locked in call to Tick", Item->Id );
+			// Other threads may hold items across a tick.
+			if( !Concurrent )
+				appErrorf( "Cache item %08X still locked in call to Tick", Item->Id );
 		}
 		else if( Time - Item->Time > 1)
 		{
 			// Exponentially decrease Cost for stale items.
-			Item->Cost -= Item->Cost >> 5;
+			DecayCost( Item, Cost, 0 );
 			MemStale   += Item->LinearNext->Data - Item->Data;
 			ItemsStale++;
 		}
 		else if( Time - Item->Time == 1)
 		{
 			// Cut Cost by 1/4th as soon as it first becomes stale.
-			Item->Cost = Item->Cost >> 2;
+			DecayCost( Item, Cost, 1 );
 		}
 		else
 		{
@@ -623,6 +1000,8 @@ void FMemCache::Tick()
 
 	// Update the cache's time.
 	Time++;
+	if( Concurrent )
+		appMutexUnlock( AllocMutex );
 	uunclock(TickCycles);
 	unguard;
 }
@@ -634,6 +1013,7 @@ void FMemCache::Tick()
 UBOOL FMemCache::Exec( const char* Cmd, FOutputDevice* Out )
 {
 	guard(FMemCache::Exec);
+	FCacheLock Lock( this );
 	if( ParseCommand(&Cmd,"DUMPCACHE") )
 	{
 		for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
@@ -651,6 +1031,24 @@ UBOOL FMemCache::Exec( const char* Cmd, FOutputDevice* Out )
 		}
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,"CACHESTATS") )
+	{
+		INT FreeBytes=0, FreeBlocks=0;
+		for( INT i=0; i<FREE_CLASSES; i++ )
+		{
+			for( FCacheItem* Item=FreeItems[i]; Item; Item=Item->FreeNext )
+			{
+				FreeBytes += Item->LinearNext->Data - Item->Data;
+				FreeBlocks++;
+			}
+		}
+		Out->Logf( "Cache: %iK in %i items", MemTotal/1024, ItemsTotal );
+		Out->Logf( "   Gets: %i, hits %i, misses %i", TotalGets, TotalGets-NumMisses, NumMisses );
+		Out->Logf( "   Creates: %i, %i in free space, %i by eviction", TotalCreates, FreeFits, TotalCreates-FreeFits );
+		Out->Logf( "   Evictions: %i items, %iK", Evictions, (INT)(EvictedBytes/1024) );
+		Out->Logf( "   Free space: %iK in %i blocks", FreeBytes/1024, FreeBlocks );
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
@@ -664,23 +1062,29 @@ UBOOL FMemCache::Exec( const char* Cmd, FOutputDevice* Out )
 //
 void FMemCache::Status( char *StatusText )
 {
+	// Take the counts other threads may still be adding to.
+	INT Gets = NumGets, Creates = NumCreates, Cycles = CreateCycles;
+
 	// Display stats.
 	appSprintf
 	(
 		StatusText, 
 		"Gets=%04i (%04.1f) Crts=%03i (%04.1f) Fresh=%03iK Stale=%03iK Items=%03i Tick=%04.1f",
-		NumGets,
+		Gets,
 		GetCycles * GSecondsPerCycle*1000,
-		NumCreates,
-		CreateCycles * GSecondsPerCycle*1000,
+		Creates,
+		Cycles * GSecondsPerCycle*1000,
 		MemFresh/1024,
 		MemStale/1024,
 		ItemsFresh+ItemsStale+ItemGaps,
 		TickCycles * GSecondsPerCycle*1000
 	);
 
-	// Reinitialize time-variant stats.
-	NumGets = GetCycles = NumCreates = CreateCycles = TickCycles = 0;
+	// Reinitialize time-variant stats, keeping anything counted meanwhile.
+	CountStat( NumGets, -Gets );
+	CountStat( NumCreates, -Creates );
+	CountStat( CreateCycles, -Cycles );
+	GetCycles = TickCycles = 0;
 }
 
 /*-----------------------------------------------------------------------------
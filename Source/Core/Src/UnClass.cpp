@@ -291,7 +291,12 @@ static void BuildVfHashes( UStruct* Struct )
 			*PrevLink[iHash]   = *It;
 			PrevLink[iHash]    = &It->HashNext;
 			It->HashNext       = NULL;
+			if( It->IsA(UFunction::StaticClass) && (((UFunction*)*It)->FunctionFlags & FUNC_Event) )
+				UState::AddEventSlot( It->GetFName() );
 		}
+
+		// Forget previously resolved events.
+		State->ClearEventCache();
 	}
 
 	// Build hash for child states.
@@ -887,6 +892,9 @@ void UClass::Destroy()
 		Next = Link->Next;
 		delete Link;
 	}
+	RepRecords.Empty();
+	RepConditions.Empty();
+	RepLayoutValid = 0;
 
 	Super::Destroy();
 	unguard;
@@ -922,6 +930,77 @@ void UClass::PostLoad()
 	}
 	unguardobj;
 }
+//
+// Build the flattened replication layout of this class and all of its
+// superclasses, so that replication can walk one contiguous array of
+// elements instead of the linked Reps lists, and evaluate each distinct
+// replication condition only once per actor update.
+//
+void UClass::BuildRepLayout()
+{
+	guard(UClass::BuildRepLayout);
+	RepRecords.Empty();
+	RepConditions.Empty();
+
+	// Walk the classes in the same order replication always has, so the
+	// order properties are packed into bunches is unchanged.
+	TArray<FRepLink*> Conditions;
+	for( UClass* RepClass=this; RepClass; RepClass=RepClass->GetSuperClass() )
+	{
+		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+		{
+			// Map the link's condition to a condition index.
+			INT iCondition;
+			for( iCondition=0; iCondition<Conditions.Num(); iCondition++ )
+				if( Conditions(iCondition)==Link->Condition )
+					break;
+			if( iCondition==Conditions.Num() )
+			{
+				Conditions.AddItem( Link->Condition );
+				RepConditions.AddItem( Link->Condition->Property );
+			}
+
+			// See whether the property's Identical is a plain bitwise compare.
+			UProperty* It    = Link->Property;
+			UClass*    Class = It->GetClass();
+			UBOOL      Plain = 0;
+			DWORD      Mask  = 0;
+			if( Class==UBoolProperty::StaticClass )
+			{
+				Mask = ((UBoolProperty*)It)->BitMask;
+			}
+			else if
+			(	Class==UByteProperty::StaticClass
+			||	Class==UIntProperty::StaticClass
+			||	Class==UFloatProperty::StaticClass
+			||	Class==UNameProperty::StaticClass
+			||	It->IsA(UObjectProperty::StaticClass) )
+			{
+				Plain = 1;
+			}
+			else if( Class==UStructProperty::StaticClass )
+			{
+				FName StructName = ((UStructProperty*)It)->Struct->GetFName();
+				Plain = StructName==NAME_Vector || StructName==NAME_Rotator || StructName==NAME_Plane;
+			}
+
+			// Add one record per array element.
+			for( INT Index=0; Index<It->ArrayDim; Index++ )
+			{
+				FRepRecord& Record = RepRecords( RepRecords.Add() );
+				Record.Property    = It;
+				Record.Index       = Index;
+				Record.Size        = It->GetElementSize();
+				Record.Offset      = It->Offset + Index*Record.Size;
+				Record.BitMask     = Mask;
+				Record.iCondition  = iCondition;
+				Record.Plain       = Plain;
+			}
+		}
+	}
+	RepLayoutValid = 1;
+	unguardobj;
+}
 void UClass::Serialize( FArchive& Ar )
 {
 	guard(UClass::Serialize);
@@ -1422,6 +1501,9 @@ IMPLEMENT_CLASS(UFunction);
 	UState.
 -----------------------------------------------------------------------------*/
 
+TArray<INT> UState::EventSlots;
+INT         UState::NumEventSlots=0;
+
 UState::UState( UState* InSuperState )
 : UStruct( InSuperState )
 {}
@@ -1432,12 +1514,15 @@ UState::UState( EIntrinsicConstructor, INT InSize, FName InName, FName InPackage
 ,	VfHash( NULL )
 ,	StateFlags( 0 )
 ,	LabelTableOffset( 0 )
+,	EventCache( NULL )
+,	EventCacheNum( 0 )
 {}
 void UState::Destroy()
 {
 	guard(UState::Destroy);
 	if( VfHash )
 		delete VfHash;
+	ClearEventCache();
 	UStruct::Destroy();
 	unguard;
 }
@@ -1450,8 +1535,86 @@ void UState::Serialize( FArchive& Ar )
 	Ar << ProbeMask << IgnoreMask;
 	Ar << LabelTableOffset << StateFlags;
 	if( Ar.IsLoading() )
+	{
 		VfHash = NULL;
+		ClearEventCache();
+	}
+
+	unguard;
+}
+
+//
+// Give an event name a slot in every state's event cache.
+//
+void UState::AddEventSlot( FName InName )
+{
+	guard(UState::AddEventSlot);
+	INT Index = InName.GetIndex();
+	if( Index>=EventSlots.Num() )
+	{
+		INT OldNum = EventSlots.Num();
+		EventSlots.Add( Index + 1 - OldNum );
+		for( INT i=OldNum; i<EventSlots.Num(); i++ )
+			EventSlots(i) = INDEX_NONE;
+	}
+	if( EventSlots(Index)==INDEX_NONE )
+		EventSlots(Index) = NumEventSlots++;
+	unguard;
+}
+
+//
+// Forget the slot of a name which is being deleted.  A new name given the
+// same index must not find the old event's entries in the caches; if it
+// is an event too, it gets a fresh slot.
+//
+void UState::RemoveEventSlot( INT NameIndex )
+{
+	guard(UState::RemoveEventSlot);
+	if( NameIndex<EventSlots.Num() )
+		EventSlots(NameIndex) = INDEX_NONE;
+	unguard;
+}
 
+//
+// Free the event lookup cache.
+//
+void UState::ClearEventCache()
+{
+	guard(UState::ClearEventCache);
+	if( EventCache )
+		appFree( EventCache );
+	EventCache    = NULL;
+	EventCacheNum = 0;
+	unguard;
+}
+
+//
+// Look up an event in VfHash and remember the result, which may be NULL.
+//
+UField* UState::ResolveEvent( INT iEvent, FName InName )
+{
+	guard(UState::ResolveEvent);
+	if( iEvent>=EventCacheNum )
+	{
+		EventCache = (UField**)appRealloc( EventCache, NumEventSlots*sizeof(UField*), "EventCache" );
+		for( INT i=EventCacheNum; i<NumEventSlots; i++ )
+			EventCache[i] = UNRESOLVED_EVENT;
+		EventCacheNum = NumEventSlots;
+	}
+	UField* Result = NULL;
+	if( VfHash )
+	{
+		for( UField* Node=VfHash[InName.GetIndex() & (UField::HASH_COUNT-1)]; Node; Node=Node->HashNext )
+		{
+			if( Node->GetFName()==InName )
+			{
+				Result = Node;
+				break;
+			}
+		}
+	}
+	EventCache[iEvent] = Result;
+	return Result;
 	unguard;
 }
 IMPLEMENT_CLASS(UState);
@@ -203,6 +203,7 @@ void UObject::execLocalVariable( FFrame& Stack, BYTE*& Result )
 	debug(Stack.Object==this);
 	debug(Stack.Locals!=NULL);
 	GProperty = ((UProperty*)Stack.ReadInt());
+	GPropObject = NULL;
 	Result = Stack.Locals + GProperty->Offset;
 
 	unguardexecSlow;
@@ -214,6 +215,7 @@ void UObject::execInstanceVariable( FFrame& Stack, BYTE*& Result )
 	guardSlow(UObject::execInstanceVariable);
 
 	GProperty = (UProperty*)Stack.ReadInt();
+	GPropObject = this;
 	Result = (BYTE*)this + GProperty->Offset;
 
 	unguardexecSlow;
@@ -225,6 +227,7 @@ void UObject::execDefaultVariable( FFrame& Stack, BYTE*& Result )
 	guardSlow(UObject::execDefaultVariable);
 
 	GProperty = (UProperty*)Stack.ReadInt();
+	GPropObject = GetClass();
 	Result = &GetClass()->Defaults(GProperty->Offset);
 
 	unguardexecSlow;
@@ -487,8 +490,12 @@ void UObject::execLet( FFrame& Stack, BYTE*& Result )
 
 	// Get variable address.
 	BYTE* Var=NULL;
+	GPropObject=NULL;
 	Stack.Step( Stack.Object, Var );
-	GProperty->ExecLet( Var, Stack );
+	UObject* Owner = GPropObject;
+	UProperty* Property = GProperty;
+	Property->ExecLet( Var, Stack );
+	NoteScriptWrite( Owner, Property );
 
 	unguardexecSlow;
 }
@@ -2748,6 +2755,159 @@ BYTE CORE_API GRegisterIntrinsic( int iIntrinsic, void* Func )
 	Script processing function.
 -----------------------------------------------------------------------------*/
 
+//
+// Statement handlers which ExecStatements runs inline; every other token
+// goes through the intrinsic table as before.
+//
+enum EStatementKind
+{
+	STMT_Intrinsic		= 0,	// Call through GIntrinsics.
+	STMT_Return			= 1,	// End of function.
+	STMT_Let			= 2,	// Assignment.
+	STMT_Jump			= 3,	// Unconditional jump.
+	STMT_JumpIfNot		= 4,	// Conditional jump.
+	STMT_Nothing		= 5,	// No operation.
+	STMT_FinalFunction	= 6,	// Prebound function call.
+	STMT_VirtualFunction= 7,	// Virtual function call.
+};
+static BYTE GStatementKinds[256];
+static BYTE InitStatementKinds()
+{
+	GStatementKinds[EX_Return         ] = STMT_Return;
+	GStatementKinds[EX_Let            ] = STMT_Let;
+	GStatementKinds[EX_Jump           ] = STMT_Jump;
+	GStatementKinds[EX_JumpIfNot      ] = STMT_JumpIfNot;
+	GStatementKinds[EX_Nothing        ] = STMT_Nothing;
+	GStatementKinds[EX_FinalFunction  ] = STMT_FinalFunction;
+	GStatementKinds[EX_VirtualFunction] = STMT_VirtualFunction;
+	return 0;
+}
+static BYTE GStatementKindsTemp = InitStatementKinds();
+
+//
+// Execute statements until EX_Return, leaving Code pointing at it.
+//
+// With GCC this is direct-threaded: each handler jumps straight to the
+// next statement's handler rather than returning to a central loop.
+// The inline handlers must produce exactly the same results as the
+// corresponding intrinsics.
+//
+void FFrame::ExecStatements()
+{
+#if DO_SLOW_GUARD
+	FFrame& Stack = *this; // For CHECK_RUNAWAY and unguardexecSlow.
+#endif
+	guardSlow(FFrame::ExecStatements);
+	BYTE Buffer[MAX_STRING_CONST_SIZE], *Addr;
+	BYTE B;
+
+#if __GNUC__
+	static void* const Handlers[] =
+	{
+		&&Intrinsic, &&Return, &&Let, &&Jump, &&JumpIfNot, &&Nothing, &&FinalFunction, &&VirtualFunction
+	};
+	#define STATEMENT(kind) kind:
+	#define NEXT_STATEMENT  { B = *Code++; goto *Handlers[GStatementKinds[B]]; }
+	NEXT_STATEMENT;
+#else
+	#define STATEMENT(kind) case STMT_##kind:
+	#define NEXT_STATEMENT  continue;
+	for( ; ; )
+	{
+	B = *Code++;
+	switch( GStatementKinds[B] )
+	{
+#endif
+
+	STATEMENT(Intrinsic)
+	{
+		(Object->*GIntrinsics[B])( *this, Addr=Buffer );
+		NEXT_STATEMENT;
+	}
+	STATEMENT(Return)
+	{
+		Code--;
+		return;
+	}
+	STATEMENT(Let)
+	{
+		// Simple variables on the left side are resolved here, and assigned
+		// here unless the property has its own ExecLet.
+		BYTE L = *Code;
+		if( L==EX_LocalVariable || L==EX_InstanceVariable )
+		{
+			Code++;
+			UProperty* Property = *(UProperty**)Code;
+			Code += sizeof(UProperty*);
+			BYTE* Var = (L==EX_LocalVariable ? Locals : (BYTE*)Object) + Property->Offset;
+			GProperty = Property;
+			UClass* PropertyClass = Property->GetClass();
+			if( PropertyClass!=UStringProperty::StaticClass && PropertyClass!=UBoolProperty::StaticClass )
+			{
+				BYTE* Val = Buffer;
+				Step( Object, Val );
+				INT Size = Property->GetElementSize();
+				if( Size==sizeof(DWORD) )
+					*(DWORD*)Var = *(DWORD*)Val;
+				else
+					appMemcpy( Var, Val, Size );
+			}
+			else Property->ExecLet( Var, *this );
+			if( L==EX_InstanceVariable )
+				NoteScriptWrite( Object, Property );
+		}
+		else
+		{
+			BYTE* Var = NULL;
+			GPropObject = NULL;
+			Step( Object, Var );
+			UObject* Owner = GPropObject;
+			UProperty* Property = GProperty;
+			Property->ExecLet( Var, *this );
+			NoteScriptWrite( Owner, Property );
+		}
+		NEXT_STATEMENT;
+	}
+	STATEMENT(Jump)
+	{
+		CHECK_RUNAWAY;
+		Code = &Node->Script( ReadWord() );
+		NEXT_STATEMENT;
+	}
+	STATEMENT(JumpIfNot)
+	{
+		CHECK_RUNAWAY;
+		INT wOffset = ReadWord();
+		BYTE* Val = Buffer;
+		Step( Object, Val );
+		if( !*(DWORD*)Val )
+			Code = &Node->Script( wOffset );
+		NEXT_STATEMENT;
+	}
+	STATEMENT(Nothing)
+	{
+		NEXT_STATEMENT;
+	}
+	STATEMENT(FinalFunction)
+	{
+		Object->CallFunction( *this, Addr=Buffer, (UFunction*)ReadInt() );
+		NEXT_STATEMENT;
+	}
+	STATEMENT(VirtualFunction)
+	{
+		Object->CallFunction( *this, Addr=Buffer, Object->FindFunctionChecked(ReadName()) );
+		NEXT_STATEMENT;
+	}
+
+#if !__GNUC__
+	}
+	}
+#endif
+	#undef STATEMENT
+	#undef NEXT_STATEMENT
+	unguardexecSlow;
+}
+
 //
 // Call a function.
 //
@@ -2757,6 +2917,9 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 #if DO_SLOW_GUARD
 	DWORD Cycles=0; uclock(Cycles);
 #endif
+	UBOOL Profiled = FScriptProfiler::Enabled && !Function->iIntrinsic;
+	if( Profiled )
+		FScriptProfiler::Enter( Function, MainFrame && MainFrame->StateNode!=GetClass() ? MainFrame->StateNode : NULL );
 
 	// Found it.
 	if( Function->iIntrinsic )
@@ -2794,7 +2957,9 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 		{
 			debug(*NewStack.Code==0 || *NewStack.Code==1);
 			Out->Src = Out->Dest = Dest;
+			GPropObject = NULL;
 			Stack.Step( Stack.Object, Out->Dest );
+			Out->Owner = GPropObject;
 			if( Out->Dest != Dest )
 				appMemcpy( Dest, Out->Dest, Out->Size );
 			Dest += Out->Size;
@@ -2808,7 +2973,10 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 
 		// Copy back outparms.
 		while( --Out >= Outs )
+		{
 			appMemcpy( Out->Dest, Out->Src, Out->Size );
+			GObj.NoteWrite( Out->Owner );
+		}
 
 		// Snag return offset and finish.
 		Result = &NewStack.Locals[Function->ReturnValueOffset];
@@ -2816,6 +2984,8 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 		// Release temp memory.
 		Mark.Pop();
 	}
+	if( Profiled )
+		FScriptProfiler::Leave();
 #if DO_SLOW_GUARD
 	uunclock(Cycles);
 	Function->Cycles += Cycles;
@@ -2837,16 +3007,12 @@ void UObject::ProcessInternal( FFrame& Stack )
 		// Local call.
 		if( !(((UFunction*)Stack.Node)->FunctionFlags & FUNC_Singular) )
 		{
-			BYTE Buffer[MAX_STRING_CONST_SIZE], *Addr;
-			while( *Stack.Code != EX_Return )
-				Stack.Step( Stack.Object, Addr=Buffer );
+			Stack.ExecStatements();
 		}
 		else if( !(GetFlags() & RF_InSingularFunc) )
 		{
 			SetFlags( RF_InSingularFunc );
-			BYTE Buffer[MAX_STRING_CONST_SIZE], *Addr;
-			while( *Stack.Code != EX_Return )
-				Stack.Step( Stack.Object, Addr=Buffer );
+			Stack.ExecStatements();
 			ClearFlags( RF_InSingularFunc );
 		}
 	}
@@ -2860,12 +3026,14 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms )
 {
 	guard(UObject::ProcessEvent);
 
-	// Reject.
+	// Reject, including events with no script implementation which can't
+	// be sent remotely either.
 	if
 	(	GIsEditor
 	||	!IsProbing( Function->GetFName() )
 	||	IsPendingKill()
-	||	Function->iIntrinsic )
+	||	Function->iIntrinsic
+	||	!(Function->FunctionFlags & (FUNC_Defined|FUNC_Intrinsic|FUNC_Net)) )
 		return;
 
 	// Checks.
@@ -2874,14 +3042,18 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms )
 		uclock(GScriptCycles);
 
 	// Call the function.
+	UBOOL Profiled = FScriptProfiler::Enabled;
+	if( Profiled )
+		FScriptProfiler::Enter( Function, MainFrame && MainFrame->StateNode!=GetClass() ? MainFrame->StateNode : NULL );
 	if
 	(	!ProcessRemoteFunction( Function, Parms, NULL )
 	&&	(Function->FunctionFlags & (FUNC_Defined|FUNC_Intrinsic)) )
 	{
-		// Create a new local execution stack.
+		// Create a new local execution stack; only the locals past the parms need zeroing.
 		FMemMark Mark(GMem);
-		FFrame NewStack( this, Function, 0, new(GMem,MEM_Zeroed,Function->GetPropertiesSize())BYTE );
+		FFrame NewStack( this, Function, 0, New<BYTE>(GMem,Function->GetPropertiesSize()) );
 		appMemcpy( NewStack.Locals, Parms, Function->ParmsSize );
+		appMemset( NewStack.Locals+Function->ParmsSize, 0, Function->GetPropertiesSize()-Function->ParmsSize );
 		if( !(Function->FunctionFlags & FUNC_Intrinsic) )
 		{
 			// Skip the parm info in the script code.
@@ -2906,6 +3078,8 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms )
 		// Restore locals bin.
 		Mark.Pop();
 	}
+	if( Profiled )
+		FScriptProfiler::Leave();
 	if( --GScriptEntryTag == 0 )
 		uunclock(GScriptCycles);
 	unguardf(( "(%s, %s)", GetFullName(), Function->GetFullName() ));
@@ -2926,6 +3100,292 @@ UBOOL UObject::ProcessRemoteFunction( UFunction* Function, void* Parms, FFrame*
 	return 0;
 }
 
+/*-----------------------------------------------------------------------------
+	Script profiler.
+-----------------------------------------------------------------------------*/
+
+UBOOL FScriptProfiler::Enabled=0;
+
+//
+// A node in the profiler's call tree: one function called in one state
+// (NULL if none) along one call path.  Node 0 is the root.  The name is
+// kept when the function or state is garbage collected.
+//
+struct FProfileNode
+{
+	UFunction*	Function;
+	UState*		State;
+	char		Name[NAME_SIZE*5];
+	INT			Parent;
+	INT			FirstChild;
+	INT			NextSibling;
+	DWORD		Calls;
+	QWORD		Inclusive;
+	QWORD		Exclusive;
+};
+
+//
+// A call in progress.
+//
+struct FProfileCall
+{
+	INT		Node;
+	DWORD	StartCycles;
+	DWORD	ChildCycles;
+};
+
+//
+// Per-function totals for the report.
+//
+struct FProfileTotal
+{
+	const char*	Name;
+	DWORD		Calls;
+	QWORD		Inclusive;
+	QWORD		Exclusive;
+};
+static inline INT Compare( const FProfileTotal& A, const FProfileTotal& B )
+{
+	return A.Exclusive<B.Exclusive ? 1 : A.Exclusive>B.Exclusive ? -1 : 0;
+}
+
+static TArray<FProfileNode> GProfileNodes;
+static FProfileCall GProfileStack[256];
+static INT GProfileDepth=0;
+static SQWORD GProfileStartTicks=0;
+
+//
+// Zero all counters.  The tree itself is kept, since calls in progress
+// may refer to it.
+//
+static void ResetScriptProfile()
+{
+	if( GProfileNodes.Num()==0 )
+	{
+		FProfileNode* Root = new(GProfileNodes)FProfileNode;
+		appMemset( Root, 0, sizeof(FProfileNode) );
+		Root->Parent = Root->FirstChild = Root->NextSibling = INDEX_NONE;
+	}
+	for( INT i=0; i<GProfileNodes.Num(); i++ )
+	{
+		GProfileNodes(i).Calls     = 0;
+		GProfileNodes(i).Inclusive = 0;
+		GProfileNodes(i).Exclusive = 0;
+	}
+	GProfileStartTicks = GTicks;
+}
+
+//
+// Set a node's name for reports.
+//
+static void SetProfileNodeName( FProfileNode& Node )
+{
+	if( Node.State )
+		appSprintf( Node.Name, "%s[%s]", Node.Function->GetPathName(), Node.State->GetName() );
+	else
+		appStrcpy( Node.Name, Node.Function->GetPathName() );
+}
+
+//
+// Enter a function, called from CallFunction and ProcessEvent.
+//
+void FScriptProfiler::Enter( UFunction* Function, UState* State )
+{
+	guardSlow(FScriptProfiler::Enter);
+	if( GProfileDepth < (INT)ARRAY_COUNT(GProfileStack) )
+	{
+		// Find or add the child of the current node.
+		INT Parent = GProfileDepth ? GProfileStack[GProfileDepth-1].Node : 0;
+		INT Node;
+		for( Node=GProfileNodes(Parent).FirstChild; Node!=INDEX_NONE; Node=GProfileNodes(Node).NextSibling )
+			if( GProfileNodes(Node).Function==Function && GProfileNodes(Node).State==State )
+				break;
+		if( Node==INDEX_NONE )
+		{
+			Node = GProfileNodes.Add();
+			FProfileNode& New = GProfileNodes(Node);
+			appMemset( &New, 0, sizeof(FProfileNode) );
+			New.Function    = Function;
+			New.State       = State;
+			New.Parent      = Parent;
+			New.FirstChild  = INDEX_NONE;
+			New.NextSibling = GProfileNodes(Parent).FirstChild;
+			SetProfileNodeName( New );
+			GProfileNodes(Parent).FirstChild = Node;
+		}
+		FProfileCall& Call = GProfileStack[GProfileDepth];
+		Call.Node        = Node;
+		Call.ChildCycles = 0;
+		Call.StartCycles = appCycles();
+	}
+	GProfileDepth++;
+	unguardSlow;
+}
+
+//
+// Leave the function most recently entered.
+//
+void FScriptProfiler::Leave()
+{
+	guardSlow(FScriptProfiler::Leave);
+	DWORD EndCycles = appCycles();
+	if( --GProfileDepth < (INT)ARRAY_COUNT(GProfileStack) )
+	{
+		FProfileCall& Call = GProfileStack[GProfileDepth];
+		DWORD Elapsed      = EndCycles - Call.StartCycles;
+		FProfileNode& Node = GProfileNodes(Call.Node);
+		Node.Calls++;
+		Node.Inclusive += Elapsed;
+		Node.Exclusive += Elapsed - Call.ChildCycles;
+		if( GProfileDepth > 0 )
+			GProfileStack[GProfileDepth-1].ChildCycles += Elapsed;
+	}
+	unguardSlow;
+}
+
+//
+// Forget functions and states which are about to be purged, so objects
+// allocated at the same addresses don't match their nodes.
+//
+void FScriptProfiler::PurgeGarbage()
+{
+	guard(FScriptProfiler::PurgeGarbage);
+	for( INT i=1; i<GProfileNodes.Num(); i++ )
+	{
+		FProfileNode& Node = GProfileNodes(i);
+		if
+		(	(Node.Function && (Node.Function->GetFlags() & RF_Unreachable))
+		||	(Node.State    && (Node.State   ->GetFlags() & RF_Unreachable)) )
+		{
+			Node.Function = NULL;
+			Node.State    = NULL;
+		}
+	}
+	unguard;
+}
+
+//
+// Print per-function totals, sorted by exclusive time.  Inclusive time
+// only counts the outermost call of a recursive function.
+//
+static void ReportScriptProfile( FOutputDevice* Out, INT MaxLines )
+{
+	TArray<FProfileTotal> Totals;
+	for( INT i=1; i<GProfileNodes.Num(); i++ )
+	{
+		FProfileNode& Node = GProfileNodes(i);
+		if( !Node.Calls )
+			continue;
+		INT j;
+		for( j=0; j<Totals.Num(); j++ )
+			if( appStrcmp( Totals(j).Name, Node.Name )==0 )
+				break;
+		if( j==Totals.Num() )
+		{
+			FProfileTotal* Total = new(Totals)FProfileTotal;
+			appMemset( Total, 0, sizeof(FProfileTotal) );
+			Total->Name = Node.Name;
+		}
+		INT Parent;
+		for( Parent=Node.Parent; Parent>0; Parent=GProfileNodes(Parent).Parent )
+			if( appStrcmp( GProfileNodes(Parent).Name, Node.Name )==0 )
+				break;
+		Totals(j).Calls     += Node.Calls;
+		Totals(j).Exclusive += Node.Exclusive;
+		if( Parent<=0 )
+			Totals(j).Inclusive += Node.Inclusive;
+	}
+	if( Totals.Num() )
+		appSort( &Totals(0), Totals.Num() );
+
+	INT Ticks = Max( (INT)(GTicks - GProfileStartTicks), 1 );
+	Out->Logf( "Script profile of %i ticks:", Ticks );
+	Out->Logf( "     Calls  Incl ms/tick  Excl ms/tick  Incl us/call  Function" );
+	for( INT i=0; i<Totals.Num() && i<MaxLines; i++ )
+	{
+		FProfileTotal& Total = Totals(i);
+		Out->Logf
+		(
+			"%10i  %12.4f  %12.4f  %12.2f  %s",
+			Total.Calls,
+			1000.0 * GSecondsPerCycle * (DOUBLE)Total.Inclusive / Ticks,
+			1000.0 * GSecondsPerCycle * (DOUBLE)Total.Exclusive / Ticks,
+			1000000.0 * GSecondsPerCycle * (DOUBLE)Total.Inclusive / Total.Calls,
+			Total.Name
+		);
+	}
+}
+
+//
+// Write the call tree as collapsed stacks ("A;B;C microseconds"), the
+// input format of flame graph tools.
+//
+static UBOOL SaveScriptProfile( const char* Filename )
+{
+	FILE* F = appFopen( Filename, "wb" );
+	if( !F )
+		return 0;
+	for( INT i=1; i<GProfileNodes.Num(); i++ )
+	{
+		FProfileNode& Node = GProfileNodes(i);
+		DWORD Micro = (DWORD)(1000000.0 * GSecondsPerCycle * (DOUBLE)Node.Exclusive);
+		if( !Micro )
+			continue;
+
+		// Collect the path from the root.
+		INT Path[ARRAY_COUNT(GProfileStack)], NumPath=0;
+		for( INT j=i; j>0 && NumPath<(INT)ARRAY_COUNT(Path); j=GProfileNodes(j).Parent )
+			Path[NumPath++] = j;
+		while( --NumPath >= 0 )
+			appFprintf( F, NumPath ? "%s;" : "%s", GProfileNodes(Path[NumPath]).Name );
+		appFprintf( F, " %u\n", Micro );
+	}
+	appFclose( F );
+	return 1;
+}
+
+//
+// Profiler commands.
+//
+UBOOL FScriptProfiler::Exec( const char* Cmd, FOutputDevice* Out )
+{
+	guard(FScriptProfiler::Exec);
+	const char* Str = Cmd;
+	if( ParseCommand(&Str,"START") )
+	{
+		ResetScriptProfile();
+		Enabled = 1;
+		Out->Log( "Script profiling started" );
+	}
+	else if( ParseCommand(&Str,"STOP") )
+	{
+		Enabled = 0;
+		Out->Log( "Script profiling stopped" );
+	}
+	else if( ParseCommand(&Str,"RESET") )
+	{
+		ResetScriptProfile();
+	}
+	else if( ParseCommand(&Str,"REPORT") )
+	{
+		INT MaxLines = appAtoi( Str );
+		ReportScriptProfile( Out, MaxLines>0 ? MaxLines : 40 );
+	}
+	else if( ParseCommand(&Str,"SAVE") )
+	{
+		char Filename[256];
+		if( !ParseToken( Str, Filename, ARRAY_COUNT(Filename), 0 ) )
+			appStrcpy( Filename, "ScriptProfile.folded" );
+		if( SaveScriptProfile( Filename ) )
+			Out->Logf( "Saved script profile to %s", Filename );
+		else
+			Out->Logf( NAME_ExecWarning, "Couldn't write %s", Filename );
+	}
+	else Out->Log( "Usage: PROFILESCRIPT START|STOP|RESET|REPORT [lines]|SAVE [file]" );
+	return 1;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
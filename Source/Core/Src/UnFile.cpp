@@ -26,14 +26,6 @@
 #include <sys/stat.h>
 #endif
 
-/*-----------------------------------------------------------------------------
-	Options.
------------------------------------------------------------------------------*/
-
-// To force memory leak checking.
-#undef CHECK_ALLOCS
-#define CHECK_ALLOCS 0
-
 /*-----------------------------------------------------------------------------
 	FArchive implementation.
 -----------------------------------------------------------------------------*/
@@ -137,166 +129,6 @@ void FString::Setf( const char* Fmt, ... )
 	*this = TempStr;
 }
 
-/*-----------------------------------------------------------------------------
-	Memory functions.
------------------------------------------------------------------------------*/
-
-#if CHECK_ALLOCS
-//
-// An entry that tracks one allocated memory block.
-//
-static class FTrackedAllocation
-{
-public:
-	void* Ptr;
-	int Size;
-	char Name[NAME_SIZE];
-	FTrackedAllocation* Next;
-} *GTrackedAllocations=NULL;
-
-//
-// Add a new allocation to the list of tracked allocations.
-//
-static void AddTrackedAllocation( void* Ptr, INT Size, const char* Name )
-{
-	guard(AddTrackedAllocation);
-	FTrackedAllocation* A = (FTrackedAllocation*)malloc(sizeof(FTrackedAllocation));
-
-	A->Ptr		= Ptr;
-	A->Size		= Size;
-	A->Next		= GTrackedAllocations;
-
-	appStrncpy( A->Name, Name, NAME_SIZE );
-
-	GTrackedAllocations = A;
-	unguard;
-}
-
-//
-// Delete an existing allocation from the list.
-// Returns the original (pre-alignment) pointer.
-//
-static void* DeleteTrackedAllocation( void* Ptr )
-{
-	guard(DeleteTrackedAllocation);
-	FTrackedAllocation** PrevLink = &GTrackedAllocations;
-	FTrackedAllocation* A = GTrackedAllocations;
-	while( A )
-	{
-		if( A->Ptr == Ptr )
-		{
-			void* Result = A->Ptr;
-			*PrevLink = A->Next;
-			free(A);
-			return Result;
-		}
-		PrevLink = &A->Next;
-		A        = A->Next;
-	}
-	appErrorf( "%s", "Allocation not found" );
-	return NULL;
-	unguard;
-}
-#endif
-
-//
-// Display a list of all tracked allocations that haven't been freed.
-//
-CORE_API void appDumpAllocs( FOutputDevice* Out )
-{
-	guard(DumpTrackedAllocations);
-#if CHECK_ALLOCS
-	INT Count=0;
-	for( FTrackedAllocation* A = GTrackedAllocations; A; A=A->Next )
-	{
-		//Out->Logf( NAME_Exit, "Unfreed: %s (%i)", A->Name, A->Size );
-		Count += A->Size;
-	}
-	debugf( "Total: %fM", Count / 1024.0 / 1024.0 );
-#else
-	debugf( NAME_Exit, "Allocation checking disabled" );
-#endif
-	unguard;
-}
-CORE_API void* appMalloc( INT Size, const char* Tag )
-{
-	guard(appMalloc);
-	check(Size>0);
-
-	void* Ptr = malloc( Size );
-	check(Ptr);
-
-#if CHECK_ALLOCS
-	AddTrackedAllocation( Ptr, Size, Tag );
-#endif
-
-	return Ptr;
-	unguard;
-}
-CORE_API void appFree( void* Ptr )
-{
-	guard(appFree);
-	check(Ptr);
-
-#if CHECK_ALLOCS
-	DeleteTrackedAllocation( Ptr );
-#endif
-
-	free( Ptr );
-
-	unguard;
-}
-CORE_API void* appRealloc( void* Ptr, INT NewSize, const char* Tag )
-{
-	guard(appRealloc);
-	check(NewSize>=0);
-
-#if CHECK_ALLOCS
-	if( Ptr==NULL )
-	{
-		if( NewSize==0 )
-		{
-			return NULL;
-		}
-		else
-		{
-			return appMalloc( NewSize, Tag );
-		}
-	}
-	else
-	{
-		if( NewSize==0 )
-		{
-			DeleteTrackedAllocation( Ptr );
-			return NULL;
-		}
-		else
-		{
-			for( FTrackedAllocation *A = GTrackedAllocations; A; A=A->Next )
-				if( A->Ptr == Ptr )
-					break;
-			if( !A )
-				appErrorf( "Allocation %s not found ", Tag );
-			A->Ptr = realloc( Ptr, NewSize );
-			A->Size = NewSize;
-			return A->Ptr;
-		}
-	}
-#else
-#ifndef PLATFORM_MSVC
-	// MSVC realloc() frees memory when NewSize is 0
-	if( Ptr && NewSize == 0 )
-	{
-		free( Ptr );
-		return NULL;
-	}
-#endif
-	return realloc( Ptr, NewSize );
-#endif
-
-	unguardf(( "%08X %i %s", (INT)Ptr, NewSize, Tag ));
-}
-
 /*-----------------------------------------------------------------------------
 	Math functions.
 -----------------------------------------------------------------------------*/
@@ -225,7 +225,10 @@ struct FFileStatus
 };
 
 //
-// Ansi file loader.
+// File loader.  Uses the file's contents if they were already read in
+// the background, or else maps the file into memory where the platform
+// allows it, so serializing is a bounds-checked copy out of memory and
+// seeking is free; otherwise falls back to Ansi file reads.
 //
 class FArchiveFileLoad : public FArchive
 {
@@ -235,6 +238,8 @@ public:
 	FArchiveFileLoad( const char* InFilename )
 	: File(NULL)
 	, Pos(0)
+	, Map(NULL)
+	, Preloaded(NULL)
 	{
 		guard(FArchiveFileLoad::FArchiveFileLoad);
 		appStrcpy( Filename, InFilename );
@@ -244,14 +249,25 @@ public:
 		appFseek( File, 0, USEEK_END );
 		Eof = appFtell( File );
 		appFseek( File, 0, USEEK_SET );
+		if( GObj.TakePreloadedFile( Filename, Preloaded, Eof ) )
+			Map = Preloaded;
+		else
+			Map = appMapFile( File, Eof );
 		unguard;
 	}
 	FArchiveFileLoad()
 	: File(NULL)
+	, Map(NULL)
+	, Preloaded(NULL)
 	{}
 	~FArchiveFileLoad()
 	{
 		guard(FArchiveFileLoad::~FArchiveFileLoad);
+		if( Preloaded )
+			appFree( Preloaded );
+		else if( Map )
+			appUnmapFile( Map, Eof );
+		Map = Preloaded = NULL;
 		if( File )
 			appFclose( File );
 		File = NULL;
@@ -262,34 +278,54 @@ public:
 		guard(FArchiveFileLoad::Seek);
 		check(InPos>=0);
 		check(InPos<=Eof);
-		INT Result = appFseek(File,InPos,USEEK_SET);
-		if( Result!=0 )
-			appErrorf( "Seek Failed %i/%i (%i): %i %i", InPos, Eof, Pos, Result, appFerror(File) );
+		if( Map )
+		{
+			if( InReadAhead>0 )
+				appPrefetchFile( Map, InPos, Min(InReadAhead,Eof-InPos) );
+		}
+		else
+		{
+			INT Result = appFseek(File,InPos,USEEK_SET);
+			if( Result!=0 )
+				appErrorf( "Seek Failed %i/%i (%i): %i %i", InPos, Eof, Pos, Result, appFerror(File) );
+		}
 		unguard;
 		Pos = InPos;
 	}
 	INT Tell()
 	{
-		return appFtell( File );
+		return Map ? Pos : appFtell( File );
 	}
 	void Push( FFileStatus& St, BYTE* NewBuffer )
 	{
-		St.SavedPos = appFtell( File );
+		St.SavedPos = Tell();
 	}
 	void Pop( FFileStatus& St )
 	{
 		guardSlow(FArchiveFileLoad::Pop);
-		INT Result = appFseek( File, St.SavedPos, USEEK_SET );
-		if( Result!=0 )
-			appErrorf( "Seek Failed %i/%i (%i): %i %i", St.SavedPos, Eof, Pos, Result, appFerror(File) );
+		if( !Map )
+		{
+			INT Result = appFseek( File, St.SavedPos, USEEK_SET );
+			if( Result!=0 )
+				appErrorf( "Seek Failed %i/%i (%i): %i %i", St.SavedPos, Eof, Pos, Result, appFerror(File) );
+		}
 		Pos = St.SavedPos;
 		unguardSlow;
 	}
 	FArchive& Serialize( void* V, INT Length )
 	{
-		INT Count = appFread( V, Length, 1, File );
-		if( Count!=1 && Length!=0 )
-			appErrorf( "appFread failed: Count=%i Length=%i Error=%i", Count, Length, appFerror(File) );
+		if( Map )
+		{
+			if( Length<0 || Length>Eof-Pos )
+				appErrorf( "Read past end of %s: Pos=%i Length=%i Eof=%i", Filename, Pos, Length, Eof );
+			appMemcpy( V, Map+Pos, Length );
+		}
+		else
+		{
+			INT Count = appFread( V, Length, 1, File );
+			if( Count!=1 && Length!=0 )
+				appErrorf( "appFread failed: Count=%i Length=%i Error=%i", Count, Length, appFerror(File) );
+		}
 		Pos += Length;
 		check(Pos<=Eof);
 		return *this;
@@ -297,6 +333,8 @@ public:
 //!!private:
 	FILE* File;
 	INT Eof;
+	const BYTE* Map;
+	BYTE* Preloaded;
 };
 
 /*----------------------------------------------------------------------------
@@ -425,6 +463,7 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 	// Friends.
 	friend class UObject;
 	friend class FPackageMap;
+	friend class FObjectManager;
 
 	// Variables.
 	DWORD LoadFlags;
@@ -447,7 +486,7 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 
 		// Begin.
 		GSystem->StatusUpdatef( 0, 0, LocalizeProgress("Loading"), Filename );
-		FileSize = appFSize(Filename);
+		FileSize = Eof;
 
 		// Set status info.
 		guard(InitAr);
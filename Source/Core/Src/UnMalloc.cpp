@@ -0,0 +1,553 @@
+/*=============================================================================
+	UnMalloc.cpp: Pooled memory allocator and per-tag allocation statistics.
+	Copyright 1997 Epic MegaGames, Inc. This software is a trade secret.
+
+Revision history:
+	* Created by Tim Sweeney
+	* Size-class pools, thread caches and tag statistics added.
+=============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include "CorePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	Options.
+-----------------------------------------------------------------------------*/
+
+enum {MALLOC_CHUNK_SIZE	= 65536	}; // Size of a chunk carved into pooled blocks.
+enum {MALLOC_MAX_POOLED	= 4096	}; // Largest pooled block, including the header.
+enum {MALLOC_CACHE_MAX	= 64	}; // Blocks a thread may cache per pool.
+enum {MALLOC_CACHE_FILL	= 32	}; // Blocks moved between a thread cache and the depot at once.
+enum {MALLOC_MAX_TAGS	= 1024	}; // Size of the tag table.
+enum {MALLOC_TAG_CACHE	= 256	}; // Per-thread tag lookup cache entries.
+enum {MALLOC_MAGIC		= 0xA7	}; // Header marker of a live allocation.
+enum {POOL_Large		= 0xFF	}; // Pool index of a block allocated straight from the C heap.
+
+// Block sizes of the pools, including the header.
+static const INT GPoolSizes[] =
+{
+	32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512,
+	640, 768, 1024, 1280, 1536, 2048, 3072, MALLOC_MAX_POOLED
+};
+enum {NUM_POOLS = ARRAY_COUNT(GPoolSizes)};
+
+/*-----------------------------------------------------------------------------
+	Allocator state.
+-----------------------------------------------------------------------------*/
+
+//
+// Header preceding every allocation.  16 bytes on both 32 and 64-bit
+// platforms so that returned pointers keep the C heap's alignment.
+//
+struct FMallocHeader
+{
+	DWORD	Size;		// Requested size.
+	_WORD	Tag;		// Index into GMallocTags.
+	BYTE	Pool;		// Index into GPools, or POOL_Large.
+	BYTE	Magic;		// MALLOC_MAGIC while allocated.
+	union
+	{
+		FMallocHeader*	Next;	// Next free block, while in a free list.
+		DWORD			Pad[2];
+	};
+};
+
+//
+// A size class.  Free blocks are kept in a depot shared by all threads;
+// each thread keeps a small cache in front of it.
+//
+struct FMallocPool
+{
+	FMallocHeader*	Free;		// Depot free list.
+	INT				NumFree;	// Blocks in the depot.
+	INT				NumChunks;	// Chunks carved for this pool.
+	std::atomic<INT> NumUsed;	// Blocks handed out to the engine.
+};
+
+//
+// Statistics for one allocation tag.
+//
+struct FMallocTag
+{
+	char				Name[NAME_SIZE];
+	std::atomic<INT>	Live;		// Bytes currently allocated.
+	std::atomic<INT>	Peak;		// Highest Live seen.
+	std::atomic<DWORD>	Allocs;		// Total allocations.
+	std::atomic<DWORD>	Bytes;		// Total bytes allocated.
+	DWORD				LastAllocs;	// Allocs at the previous MEM STATS.
+	DWORD				LastBytes;	// Bytes at the previous MEM STATS.
+};
+
+//
+// Per-thread state: cached free blocks for every pool, and a cache of
+// tag name hashes already resolved to tag table indices.
+//
+struct FMallocCache
+{
+	FMallocHeader*	Free[NUM_POOLS];
+	INT				NumFree[NUM_POOLS];
+	DWORD			TagHash[MALLOC_TAG_CACHE];
+	_WORD			TagIndex[MALLOC_TAG_CACHE];
+	~FMallocCache();
+};
+
+// All of these are constant-initialized, since the allocator is used
+// by static constructors before any other initialization takes place.
+static std::atomic_flag	GMallocLock = ATOMIC_FLAG_INIT;
+static FMallocPool		GPools[NUM_POOLS];
+static BYTE				GPoolTable[MALLOC_MAX_POOLED/16+1];
+static UBOOL			GPoolsReady = 0;
+static FMallocTag		GMallocTags[MALLOC_MAX_TAGS];
+static INT				GNumMallocTags = 0;
+static DOUBLE			GLastMallocStats = 0.0;
+static thread_local FMallocCache GMallocCache;
+
+/*-----------------------------------------------------------------------------
+	Locking.
+-----------------------------------------------------------------------------*/
+
+//
+// The depot and the tag table share one spinlock.  A mutex can't be used,
+// since creating it would allocate memory.
+//
+static inline void LockMalloc()
+{
+	while( GMallocLock.test_and_set( std::memory_order_acquire ) );
+}
+static inline void UnlockMalloc()
+{
+	GMallocLock.clear( std::memory_order_release );
+}
+
+/*-----------------------------------------------------------------------------
+	Pools.
+-----------------------------------------------------------------------------*/
+
+//
+// Build the size to pool lookup table.
+//
+static void InitPools()
+{
+	INT Pool = 0;
+	for( INT i=0; i<(INT)ARRAY_COUNT(GPoolTable); i++ )
+	{
+		while( GPoolSizes[Pool] < i*16 )
+			Pool++;
+		GPoolTable[i] = Pool;
+	}
+	GPoolsReady = 1;
+}
+
+//
+// Move up to Count blocks from the depot into this thread's cache,
+// carving a new chunk if the depot is empty.  Called with the lock held.
+//
+static void RefillCache( FMallocCache& Cache, INT Pool, INT Count )
+{
+	FMallocPool& P = GPools[Pool];
+	if( !P.Free )
+	{
+		INT		BlockSize	= GPoolSizes[Pool];
+		INT		NumBlocks	= MALLOC_CHUNK_SIZE / BlockSize;
+		BYTE*	Chunk		= (BYTE*)malloc( MALLOC_CHUNK_SIZE );
+		if( !Chunk )
+		{
+			UnlockMalloc();
+			appErrorf( "Ran out of memory allocating %i bytes", MALLOC_CHUNK_SIZE );
+		}
+		for( INT i=NumBlocks-1; i>=0; i-- )
+		{
+			FMallocHeader* Block = (FMallocHeader*)(Chunk + i*BlockSize);
+			Block->Next = P.Free;
+			P.Free      = Block;
+		}
+		P.NumFree += NumBlocks;
+		P.NumChunks++;
+	}
+	while( P.Free && Count-- > 0 )
+	{
+		FMallocHeader* Block = P.Free;
+		P.Free               = Block->Next;
+		Block->Next          = Cache.Free[Pool];
+		Cache.Free[Pool]     = Block;
+		P.NumFree--;
+		Cache.NumFree[Pool]++;
+	}
+}
+
+//
+// Return up to Count blocks from this thread's cache to the depot.
+// Called with the lock held.
+//
+static void FlushCache( FMallocCache& Cache, INT Pool, INT Count )
+{
+	FMallocPool& P = GPools[Pool];
+	while( Cache.Free[Pool] && Count-- > 0 )
+	{
+		FMallocHeader* Block = Cache.Free[Pool];
+		Cache.Free[Pool]     = Block->Next;
+		Block->Next          = P.Free;
+		P.Free               = Block;
+		Cache.NumFree[Pool]--;
+		P.NumFree++;
+	}
+}
+
+//
+// Hand a thread's cached blocks back to the depot when it exits.
+//
+FMallocCache::~FMallocCache()
+{
+	LockMalloc();
+	for( INT i=0; i<NUM_POOLS; i++ )
+		FlushCache( *this, i, NumFree[i] );
+	UnlockMalloc();
+}
+
+//
+// Allocate a block from a pool.
+//
+static inline FMallocHeader* PoolAlloc( INT Pool )
+{
+	FMallocCache& Cache = GMallocCache;
+	if( !Cache.Free[Pool] )
+	{
+		LockMalloc();
+		RefillCache( Cache, Pool, MALLOC_CACHE_FILL );
+		UnlockMalloc();
+	}
+	FMallocHeader* Block = Cache.Free[Pool];
+	Cache.Free[Pool]     = Block->Next;
+	Cache.NumFree[Pool]--;
+	GPools[Pool].NumUsed.fetch_add( 1, std::memory_order_relaxed );
+	return Block;
+}
+
+//
+// Return a block to its pool.
+//
+static inline void PoolFree( FMallocHeader* Block, INT Pool )
+{
+	FMallocCache& Cache = GMallocCache;
+	Block->Next         = Cache.Free[Pool];
+	Cache.Free[Pool]    = Block;
+	GPools[Pool].NumUsed.fetch_sub( 1, std::memory_order_relaxed );
+	if( ++Cache.NumFree[Pool] > MALLOC_CACHE_MAX )
+	{
+		LockMalloc();
+		FlushCache( Cache, Pool, MALLOC_CACHE_FILL );
+		UnlockMalloc();
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Tags.
+-----------------------------------------------------------------------------*/
+
+//
+// Find or add a tag in the tag table.  Tags are matched by contents, since
+// some are built in reused buffers.  A per-thread cache of name hashes is
+// checked first, and confirmed against the name in the table, which never
+// changes once added.  Once the table is full, new tags are counted under
+// the first entry.
+//
+static INT FindMallocTag( const char* Tag )
+{
+	if( !Tag )
+		Tag = "Unknown";
+	DWORD Hash = 2166136261U;
+	for( INT i=0; i<NAME_SIZE-1 && Tag[i]; i++ )
+		Hash = (Hash ^ (BYTE)Tag[i]) * 16777619U;
+
+	FMallocCache& Cache = GMallocCache;
+	INT CacheSlot = (Hash ^ (Hash>>16)) & (MALLOC_TAG_CACHE-1);
+	if
+	(	Cache.TagHash[CacheSlot]==Hash
+	&&	strncmp( GMallocTags[Cache.TagIndex[CacheSlot]].Name, Tag, NAME_SIZE-1 )==0 )
+		return Cache.TagIndex[CacheSlot];
+
+	LockMalloc();
+	if( GNumMallocTags==0 )
+	{
+		// Entry 0 catches overflow.
+		strcpy( GMallocTags[0].Name, "Other" );
+		GNumMallocTags++;
+	}
+	INT Index = 0;
+	for( INT i=Hash & (MALLOC_MAX_TAGS-1), Probes=0; Probes<MALLOC_MAX_TAGS; i=(i+1) & (MALLOC_MAX_TAGS-1), Probes++ )
+	{
+		if( i==0 )
+			continue;
+		if( !GMallocTags[i].Name[0] )
+		{
+			if( GNumMallocTags < MALLOC_MAX_TAGS*3/4 )
+			{
+				strncpy( GMallocTags[i].Name, Tag, NAME_SIZE-1 );
+				GNumMallocTags++;
+				Index = i;
+			}
+			break;
+		}
+		if( strncmp( GMallocTags[i].Name, Tag, NAME_SIZE-1 )==0 )
+		{
+			Index = i;
+			break;
+		}
+	}
+	UnlockMalloc();
+
+	Cache.TagHash[CacheSlot]  = Hash;
+	Cache.TagIndex[CacheSlot] = Index;
+	return Index;
+}
+
+//
+// Account for an allocation or a free.
+//
+static inline void CountAlloc( INT Tag, INT Size )
+{
+	FMallocTag& T = GMallocTags[Tag];
+	INT Live = T.Live.fetch_add( Size, std::memory_order_relaxed ) + Size;
+	if( Live > T.Peak.load( std::memory_order_relaxed ) )
+		T.Peak.store( Live, std::memory_order_relaxed );
+	T.Allocs.fetch_add( 1, std::memory_order_relaxed );
+	T.Bytes.fetch_add( Size, std::memory_order_relaxed );
+}
+static inline void CountFree( INT Tag, INT Size )
+{
+	GMallocTags[Tag].Live.fetch_sub( Size, std::memory_order_relaxed );
+}
+
+//
+// Header of an allocated pointer.
+//
+static inline FMallocHeader* GetMallocHeader( void* Ptr )
+{
+	FMallocHeader* Header = (FMallocHeader*)Ptr - 1;
+	if( Header->Magic != MALLOC_MAGIC )
+		appErrorf( "Freeing memory not allocated by appMalloc, or freed twice: %08X", (INT)(size_t)Ptr );
+	return Header;
+}
+
+/*-----------------------------------------------------------------------------
+	Memory functions.
+-----------------------------------------------------------------------------*/
+
+CORE_API void* appMalloc( INT Size, const char* Tag )
+{
+	guard(appMalloc);
+	check(Size>0);
+
+	if( !GPoolsReady )
+		InitPools();
+
+	INT            AllocSize = Size + sizeof(FMallocHeader);
+	FMallocHeader* Header;
+	INT            Pool;
+	if( AllocSize <= MALLOC_MAX_POOLED )
+	{
+		Pool   = GPoolTable[(AllocSize+15)>>4];
+		Header = PoolAlloc( Pool );
+	}
+	else
+	{
+		Pool   = POOL_Large;
+		Header = (FMallocHeader*)malloc( AllocSize );
+		if( !Header )
+			appErrorf( "Ran out of memory allocating %i bytes for %s", Size, Tag );
+	}
+
+	Header->Size  = Size;
+	Header->Tag   = FindMallocTag( Tag );
+	Header->Pool  = Pool;
+	Header->Magic = MALLOC_MAGIC;
+	CountAlloc( Header->Tag, Size );
+
+	return Header + 1;
+	unguard;
+}
+CORE_API void appFree( void* Ptr )
+{
+	guard(appFree);
+	check(Ptr);
+
+	FMallocHeader* Header = GetMallocHeader( Ptr );
+	CountFree( Header->Tag, Header->Size );
+	Header->Magic = 0;
+
+	if( Header->Pool != POOL_Large )
+		PoolFree( Header, Header->Pool );
+	else
+		free( Header );
+
+	unguard;
+}
+CORE_API void* appRealloc( void* Ptr, INT NewSize, const char* Tag )
+{
+	guard(appRealloc);
+	check(NewSize>=0);
+
+	if( Ptr==NULL )
+	{
+		return NewSize ? appMalloc( NewSize, Tag ) : NULL;
+	}
+	else if( NewSize==0 )
+	{
+		appFree( Ptr );
+		return NULL;
+	}
+
+	FMallocHeader* Header = GetMallocHeader( Ptr );
+	INT            OldSize = Header->Size;
+	INT            AllocSize = NewSize + sizeof(FMallocHeader);
+	if( Header->Pool != POOL_Large )
+	{
+		// Keep the block if the new size still belongs to its pool.
+		if( AllocSize <= MALLOC_MAX_POOLED && GPoolTable[(AllocSize+15)>>4]==Header->Pool )
+		{
+			CountFree( Header->Tag, OldSize );
+			CountAlloc( Header->Tag, NewSize );
+			Header->Size = NewSize;
+			return Ptr;
+		}
+	}
+	else if( AllocSize > MALLOC_MAX_POOLED )
+	{
+		// Large to large: let the C heap grow it in place if it can.
+		CountFree( Header->Tag, OldSize );
+		FMallocHeader* NewHeader = (FMallocHeader*)realloc( Header, AllocSize );
+		if( !NewHeader )
+			appErrorf( "Ran out of memory reallocating %i bytes for %s", NewSize, Tag );
+		NewHeader->Size = NewSize;
+		CountAlloc( NewHeader->Tag, NewSize );
+		return NewHeader + 1;
+	}
+
+	// Move between pools, or between a pool and the C heap.
+	void* Result = appMalloc( NewSize, Tag );
+	appMemcpy( Result, Ptr, Min(OldSize,NewSize) );
+	appFree( Ptr );
+	return Result;
+
+	unguardf(( "%08X %i %s", (INT)(size_t)Ptr, NewSize, Tag ));
+}
+
+/*-----------------------------------------------------------------------------
+	Statistics.
+-----------------------------------------------------------------------------*/
+
+//
+// A tag's statistics, for sorting.
+//
+struct FMallocTagStat
+{
+	INT		Tag;
+	INT		Live;
+	INT		Peak;
+	DWORD	Allocs;
+	DWORD	Bytes;
+};
+static inline INT Compare( const FMallocTagStat& A, const FMallocTagStat& B )
+{
+	return B.Live - A.Live;
+}
+
+//
+// Take a snapshot of the tag table, sorted by live bytes.
+//
+static INT GetMallocTagStats( FMallocTagStat* Stats, INT& Total )
+{
+	INT Num = 0;
+	Total   = 0;
+	for( INT i=0; i<MALLOC_MAX_TAGS; i++ )
+	{
+		FMallocTag& T = GMallocTags[i];
+		if( T.Name[0] )
+		{
+			FMallocTagStat& S = Stats[Num++];
+			S.Tag    = i;
+			S.Live   = T.Live.load( std::memory_order_relaxed );
+			S.Peak   = T.Peak.load( std::memory_order_relaxed );
+			S.Allocs = T.Allocs.load( std::memory_order_relaxed );
+			S.Bytes  = T.Bytes.load( std::memory_order_relaxed );
+			Total   += S.Live;
+		}
+	}
+	appSort( Stats, Num );
+	return Num;
+}
+
+//
+// Display live, peak and allocation rate for every tag with memory
+// allocated or allocations since the previous call, followed by a
+// summary of the pools.
+//
+CORE_API void appMemStats( FOutputDevice* Out )
+{
+	guard(appMemStats);
+
+	// Static, to stay off the stack and out of the numbers being measured.
+	static FMallocTagStat Stats[MALLOC_MAX_TAGS];
+	INT    Total;
+	INT    Num     = GetMallocTagStats( Stats, Total );
+	DOUBLE Time    = appSeconds();
+	DOUBLE Elapsed = GLastMallocStats>0.0 ? Time-GLastMallocStats : 0.0;
+
+	Out->Logf( "%-32s %10s %10s %10s %10s", "Tag", "Live KB", "Peak KB", "Allocs/s", "KB/s" );
+	for( INT i=0; i<Num; i++ )
+	{
+		FMallocTagStat& S = Stats[i];
+		FMallocTag&     T = GMallocTags[S.Tag];
+		FLOAT AllocRate   = Elapsed>0.0 ? (S.Allocs - T.LastAllocs) / Elapsed : 0.0;
+		FLOAT ByteRate    = Elapsed>0.0 ? (S.Bytes  - T.LastBytes ) / Elapsed / 1024.0 : 0.0;
+		T.LastAllocs      = S.Allocs;
+		T.LastBytes       = S.Bytes;
+		if( S.Live || AllocRate>0.0 )
+			Out->Logf( "%-32s %10.1f %10.1f %10.1f %10.1f", T.Name, S.Live/1024.0, S.Peak/1024.0, AllocRate, ByteRate );
+	}
+	GLastMallocStats = Time;
+
+	INT NumChunks=0, NumUsed=0, UsedBytes=0;
+	for( INT i=0; i<NUM_POOLS; i++ )
+	{
+		INT Used   = GPools[i].NumUsed.load( std::memory_order_relaxed );
+		NumChunks += GPools[i].NumChunks;
+		NumUsed   += Used;
+		UsedBytes += Used * GPoolSizes[i];
+	}
+	Out->Logf
+	(
+		"Total %.2fM live in %i tags, pools %.2fM reserved, %i blocks %.2fM used",
+		Total/1024.0/1024.0,
+		Num,
+		NumChunks*(MALLOC_CHUNK_SIZE/1024.0/1024.0),
+		NumUsed,
+		UsedBytes/1024.0/1024.0
+	);
+	if( Elapsed==0.0 )
+		Out->Log( "Rates are measured from the next MEM STATS" );
+
+	unguard;
+}
+
+//
+// Display the memory still allocated, by tag.
+//
+CORE_API void appDumpAllocs( FOutputDevice* Out )
+{
+	guard(DumpTrackedAllocations);
+	static FMallocTagStat Stats[MALLOC_MAX_TAGS];
+	INT Total;
+	INT Num = GetMallocTagStats( Stats, Total );
+	for( INT i=0; i<Num && i<32 && Stats[i].Live>0; i++ )
+		Out->Logf( NAME_Exit, "Unfreed: %s (%i)", GMallocTags[Stats[i].Tag].Name, Stats[i].Live );
+	Out->Logf( NAME_Exit, "Total: %fM", Total / 1024.0 / 1024.0 );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -14,7 +14,9 @@
 
 UBOOL				FName::Initialized = false;
 INT					FName::Duplicate =0;
-FNameEntry*			FName::NameHash[8192];
+FNameSlot*			FName::NameHash = NULL;
+INT					FName::NameHashMask = 0;
+INT					FName::NameHashNum = 0;
 TArray<FNameEntry*>	FName::Names(E_NoInit);
 TArray<INT>         FName::Available(E_NoInit);
 
@@ -29,9 +31,7 @@ TArray<INT>         FName::Available(E_NoInit);
 void FName::Hardcode( FNameEntry& AutoName )
 {
 	// Add name to name hash.
-	int iHash         = appStrihash(AutoName.Name) & (ARRAY_COUNT(NameHash)-1);
-	AutoName.HashNext = NameHash[iHash];
-	NameHash[iHash]   = (FNameEntry*)&AutoName;
+	HashEntry( &AutoName, appStrihash(AutoName.Name) );
 
 	// Expand the table if needed.
 	for( int i=Names.Num(); i<=AutoName.Index; i++ )
@@ -75,13 +75,13 @@ FName::FName( const char* Name, EFindName FindType )
 	ValidName[Count]=0;
 
 	// Try to find the name in the hash.
-	INT iHash = appStrihash(ValidName) & (ARRAY_COUNT(NameHash)-1);
-	for( FNameEntry* Hash=NameHash[iHash]; Hash; Hash=Hash->HashNext )
+	DWORD Hash = appStrihash(ValidName);
+	for( INT i=Hash & NameHashMask; NameHash[i].Entry; i=(i+1) & NameHashMask )
 	{
-		if( appStricmp( ValidName, Hash->Name )==0 )
+		if( NameHash[i].Hash==Hash && appStricmp( ValidName, NameHash[i].Entry->Name )==0 )
 		{
 			// Found it in the hash.
-			Index = Hash->Index;
+			Index = NameHash[i].Entry->Index;
 			return;
 		}
 	}
@@ -103,7 +103,8 @@ FName::FName( const char* Name, EFindName FindType )
 	else Index = Names.Add();
 
 	// Allocate the name and set it.
-	Names(Index) = NameHash[iHash] = AllocateNameEntry( ValidName, Index, 0, NameHash[iHash] );
+	Names(Index) = AllocateNameEntry( ValidName, Index, 0 );
+	HashEntry( Names(Index), Hash );
 
 	// Set intrinsic flag.
 	if( FindType==FNAME_Intrinsic )
@@ -122,17 +123,17 @@ FName::FName( const char* Name, EFindName FindType )
 void FName::InitSubsystem()
 {
 	guard(FName::InitSubsystem);
-	check((ARRAY_COUNT(NameHash)&(ARRAY_COUNT(NameHash)-1)) == 0);
+	check(((NameHashMask+1)&NameHashMask) == 0);
 	check(Names.Num());
 	if( Duplicate )
 		appErrorf( "Hardcoded name %i was duplicated", Duplicate );
 
-	// Verify no duplicate names.
-	for( int i=0; i<ARRAY_COUNT(NameHash); i++ )
-		for( FNameEntry* Hash=NameHash[i]; Hash; Hash=Hash->HashNext )
-			for( FNameEntry* Other=Hash->HashNext; Other; Other=Other->HashNext )
-				if( appStricmp(Hash->Name,Other->Name)==0 )
-					appErrorf( "Name '%s' was duplicated", Hash->Name );
+	// Verify no duplicate names; equal names always share a probe run.
+	for( INT i=0; i<=NameHashMask; i++ )
+		if( NameHash[i].Entry )
+			for( INT j=(i+1) & NameHashMask; NameHash[j].Entry && j!=i; j=(j+1) & NameHashMask )
+				if( NameHash[j].Hash==NameHash[i].Hash && appStricmp(NameHash[i].Entry->Name,NameHash[j].Entry->Name)==0 )
+					appErrorf( "Name '%s' was duplicated", NameHash[i].Entry->Name );
 
 	debugf( NAME_Init, "Name subsystem initialized" );
 	unguard;
@@ -161,14 +162,27 @@ void FName::DisplayHash( FOutputDevice* Out )
 {
 	guard(FName::DisplayHash);
 
-	int UsedBins=0, NameCount=0;
-	for( int i=0; i<ARRAY_COUNT(NameHash); i++ )
+	// Probe length is the distance from a name's home slot, plus one.
+	INT NameCount=0, TotalProbes=0, MaxProbes=0;
+	for( INT i=0; i<=NameHashMask; i++ )
 	{
-		if( NameHash[i] != NULL ) UsedBins++;
-		for( FNameEntry *Hash = NameHash[i]; Hash; Hash=Hash->HashNext )
+		if( NameHash[i].Entry )
+		{
+			INT Probes   = ((i - (INT)NameHash[i].Hash) & NameHashMask) + 1;
+			TotalProbes += Probes;
+			MaxProbes    = Max( MaxProbes, Probes );
 			NameCount++;
+		}
 	}
-	Out->Logf( "Hash: %i names, %i/%i hash bins", NameCount, UsedBins, ARRAY_COUNT(NameHash) );
+	Out->Logf
+	(
+		"Name hash: %i names in %i slots (%.0f%% full), average probe %.2f, longest %i",
+		NameCount,
+		NameHashMask+1,
+		100.0 * NameCount / (NameHashMask+1),
+		NameCount ? (FLOAT)TotalProbes/NameCount : 0.0,
+		MaxProbes
+	);
 
 	unguard;
 }
@@ -185,12 +199,7 @@ void FName::DeleteEntry( int i )
 	check(Name!=NULL);
 	check(!(Name->Flags & RF_Intrinsic));
 
-	int iHash = appStrihash(Name->Name) & (ARRAY_COUNT(NameHash)-1);
-	FNameEntry **HashLink;
-	for( HashLink=&NameHash[iHash]; *HashLink && *HashLink!=Name; HashLink=&(*HashLink)->HashNext );
-	if( !*HashLink )
-		appErrorf( "Unhashed name '%s'", Name->Name );
-	*HashLink = (*HashLink)->HashNext;
+	UnhashEntry( Name );
 
 	// Remove it from the global name table.
 	Names(i) = NULL;
@@ -202,6 +211,70 @@ void FName::DeleteEntry( int i )
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Name hash.
+-----------------------------------------------------------------------------*/
+
+//
+// Add a name to the hash, which uses linear probing and is kept at most
+// half full.
+//warning: Called at library initialization. Be very careful.
+//
+void FName::HashEntry( FNameEntry* Entry, DWORD Hash )
+{
+	if( (NameHashNum+1)*2 > NameHashMask+1 )
+	{
+		// Double the table and reinsert everything.
+		FNameSlot* OldHash = NameHash;
+		INT        OldSize = NameHashMask+1;
+		NameHashMask = OldSize*2-1;
+		NameHash     = (FNameSlot*)appMalloc( (NameHashMask+1)*sizeof(FNameSlot), "NameHash" );
+		appMemset( NameHash, 0, (NameHashMask+1)*sizeof(FNameSlot) );
+		for( INT i=0; i<OldSize; i++ )
+		{
+			if( OldHash[i].Entry )
+			{
+				INT j;
+				for( j=OldHash[i].Hash & NameHashMask; NameHash[j].Entry; j=(j+1) & NameHashMask );
+				NameHash[j] = OldHash[i];
+			}
+		}
+		appFree( OldHash );
+	}
+	INT i;
+	for( i=Hash & NameHashMask; NameHash[i].Entry; i=(i+1) & NameHashMask );
+	NameHash[i].Hash  = Hash;
+	NameHash[i].Entry = Entry;
+	NameHashNum++;
+}
+
+//
+// Remove a name from the hash.  Later names in its probe run are shifted
+// back, so that no tombstones are needed.
+//
+void FName::UnhashEntry( FNameEntry* Entry )
+{
+	guard(FName::UnhashEntry);
+	INT i;
+	for( i=appStrihash(Entry->Name) & NameHashMask; NameHash[i].Entry!=Entry; i=(i+1) & NameHashMask )
+		if( !NameHash[i].Entry )
+			appErrorf( "Unhashed name '%s'", Entry->Name );
+	for( INT j=(i+1) & NameHashMask; NameHash[j].Entry; j=(j+1) & NameHashMask )
+	{
+		// Move the entry at j into the hole unless its home slot lies
+		// cyclically between the hole and j.
+		INT Home = NameHash[j].Hash & NameHashMask;
+		if( ((j-Home) & NameHashMask) >= ((j-i) & NameHashMask) )
+		{
+			NameHash[i] = NameHash[j];
+			i           = j;
+		}
+	}
+	NameHash[i].Entry = NULL;
+	NameHashNum--;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	Internal initialization.
 -----------------------------------------------------------------------------*/
@@ -216,12 +289,14 @@ void FName::InitTables()
 	check(!Initialized);
 
 	// Init the name hash.
-	for( int i=0; i<ARRAY_COUNT(FName::NameHash); i++ )
-		NameHash[i] = NULL;
+	NameHashMask = 8192-1;
+	NameHashNum  = 0;
+	NameHash     = (FNameSlot*)appMalloc( (NameHashMask+1)*sizeof(FNameSlot), "NameHash" );
+	appMemset( NameHash, 0, (NameHashMask+1)*sizeof(FNameSlot) );
 
 	// Register all hardcoded names.
-	#define REGISTER_NAME(num,namestr) static FNameEntry namestr##NAME={num,RF_Intrinsic,NULL,#namestr}; Hardcode(namestr##NAME);
-	#define REG_NAME_HIGH(num,namestr) static FNameEntry namestr##NAME={num,RF_Intrinsic|RF_HighlightedName,NULL,#namestr}; Hardcode(namestr##NAME);
+	#define REGISTER_NAME(num,namestr) static FNameEntry namestr##NAME={num,RF_Intrinsic,#namestr}; Hardcode(namestr##NAME);
+	#define REG_NAME_HIGH(num,namestr) static FNameEntry namestr##NAME={num,RF_Intrinsic|RF_HighlightedName,#namestr}; Hardcode(namestr##NAME);
 	#include "UnNames.h"
 
 	Initialized = true;
@@ -6,6 +6,7 @@
 		* Created by Tim Sweeney
 =============================================================================*/
 
+#include <atomic>
 #include "CorePrivate.h" 
 
 /*-----------------------------------------------------------------------------
@@ -24,11 +25,57 @@ UBOOL				FObjectManager::Initialized		 = 0;
 INT					FObjectManager::BeginLoadCount   = 0;
 UObject*			FObjectManager::AutoRegister     = NULL;
 UPackage*			FObjectManager::TransientPackage = NULL;
-UObject*			FObjectManager::ObjHash[4096];
+FObjectSlot*		FObjectManager::ObjHash			 = NULL;
+INT					FObjectManager::ObjHashBits		 = 0;
+INT					FObjectManager::ObjHashNum		 = 0;
 TArray<UObject*>    FObjectManager::Objects;
 TArray<INT>         FObjectManager::Available;
 TArray<UObject*>	FObjectManager::Loaders;
 TArray<UObject*>	FObjectManager::Root;
+TArray<BYTE>		FObjectManager::ObjectGen;
+TArray<BYTE>		FObjectManager::ObjectDirty;
+TArray<INT>			FObjectManager::DirtyObjects;
+TArray<UClass*>		FObjectManager::TenureClasses;
+FArchiveTagUsed*	FObjectManager::IncrementalGC	 = NULL;
+DOUBLE				FObjectManager::LastGCTime		 = 0.0;
+FLOAT				FObjectManager::MinorGCInterval	 = 0.0;
+FLOAT				FObjectManager::MinorGCBudget	 = 2.0;
+FLOAT				FObjectManager::AsyncLoadBudget	 = 2.0;
+INT					FObjectManager::GCThreads		 = 0;
+FAsyncLoader*		FObjectManager::AsyncLoader		 = NULL;
+
+// Garbage collection generations.
+enum EObjectGen
+{
+	GEN_Young		= 0,	// Created since the last major collection, or not tenurable.
+	GEN_Tenured		= 1,	// Loaded and unchanging; minor collections assume it's reachable.
+	GEN_Remembered	= 2,	// Tenured, but refers to young objects.
+};
+
+//
+// Home slot of a name in the object hash.
+//
+static inline INT ObjHashHome( NAME_INDEX Name, INT Bits )
+{
+	return (DWORD)(Name * 2654435769U) >> (32-Bits);
+}
+
+// Most threads the parallel marker will use.
+enum {MAX_GC_THREADS=16};
+
+//
+// Statistics for the last collection, shown by GC STATS.
+//
+static struct FGCStats
+{
+	const char* Kind;
+	DOUBLE MarkTime, PurgeTime;
+	INT NumThreads;
+	INT Scanned[MAX_GC_THREADS];
+} GGCStats;
+
+// Marking time so far in the current minor collection.
+static DOUBLE MinorMarkTime=0.0;
 
 // For development.
 UBOOL GNoGC=0;
@@ -544,7 +591,9 @@ void UObject::FixOld()//oldver
 		FName Group = Linker->ExportMap(GetLinkerIndex()).OldGroup;
 		if( Group!=NAME_None )
 		{
+			GObj.UnhashObject( this );
 			Parent = GObj.CreatePackage(GetParent(),*Group);
+			GObj.HashObject( this );
 			Linker->ExportMap(GetLinkerIndex()).OldGroup = NAME_None;
 		}
 	}
@@ -671,6 +720,20 @@ UBOOL UObject::ScriptConsoleExec( const char* Str, FOutputDevice* Out )
 UField* UObject::FindField( FName InName, UBOOL Global )
 {
 	guardSlow(UObject::FindField);
+
+	// Events are resolved once per state and then looked up by slot.
+	INT iEvent = UState::GetEventSlot( InName );
+	if( iEvent!=INDEX_NONE )
+	{
+		if( MainFrame && MainFrame->StateNode && !Global )
+		{
+			UField* Node = MainFrame->StateNode->FindEvent( iEvent, InName );
+			if( Node )
+				return Node;
+		}
+		return GetClass()->FindEvent( iEvent, InName );
+	}
+
 	INT iHash = InName.GetIndex() & (UField::HASH_COUNT-1);
 
 #if 1
@@ -918,23 +981,28 @@ UObject* FObjectManager::FindObject( UClass* ObjectClass, UObject* InObjectPacka
 		return NULL;
 
 	// Find in the specified package.
-	for( UObject* Hash=ObjHash[ObjectName.GetIndex() & (ARRAY_COUNT(ObjHash)-1)]; Hash!=NULL; Hash=Hash->HashNext )
+	NAME_INDEX NameIndex = ObjectName.GetIndex();
+	INT        Mask      = (1<<ObjHashBits)-1;
+	INT        Home      = ObjHashHome( NameIndex, ObjHashBits );
+	for( INT i=Home; ObjHash[i].Object; i=(i+1) & Mask )
 	{
+		FObjectSlot& Slot = ObjHash[i];
 		if
-		(	(Hash->GetFName()==ObjectName)
-		&&	(Hash->Parent==ObjectPackage)
-		&&	(ObjectClass==NULL || (ExactClass ? Hash->GetClass()==ObjectClass : Hash->IsA(ObjectClass))) )
-			return Hash;
+		(	(Slot.Name==NameIndex)
+		&&	(Slot.Parent==ObjectPackage)
+		&&	(ObjectClass==NULL || (ExactClass ? Slot.Object->GetClass()==ObjectClass : Slot.Object->IsA(ObjectClass))) )
+			return Slot.Object;
 	}
 	if( InObjectPackage==ANY_PACKAGE )
 	{
 		// Find in any package.
-		for( UObject* Hash=ObjHash[ObjectName.GetIndex() & (ARRAY_COUNT(ObjHash)-1)]; Hash!=NULL; Hash=Hash->HashNext )
+		for( INT i=Home; ObjHash[i].Object; i=(i+1) & Mask )
 		{
+			FObjectSlot& Slot = ObjHash[i];
 			if
-			(	(Hash->GetFName()==ObjectName)
-			&&	(ObjectClass==NULL || (ExactClass ? Hash->GetClass()==ObjectClass : Hash->IsA(ObjectClass))) )
-				return Hash;
+			(	(Slot.Name==NameIndex)
+			&&	(ObjectClass==NULL || (ExactClass ? Slot.Object->GetClass()==ObjectClass : Slot.Object->IsA(ObjectClass))) )
+				return Slot.Object;
 		}
 	}
 
@@ -1115,8 +1183,10 @@ void FObjectManager::Init()
 	FName::InitSubsystem();
 
 	// Init hash.
-	for( INT i=0; i<ARRAY_COUNT(ObjHash); i++ )
-		ObjHash[i] = NULL;
+	ObjHashBits = 12;
+	ObjHashNum  = 0;
+	ObjHash     = (FObjectSlot*)appMalloc( (1<<ObjHashBits)*sizeof(FObjectSlot), "ObjHash" );
+	appMemset( ObjHash, 0, (1<<ObjHashBits)*sizeof(FObjectSlot) );
 
 	// Note initialized.
 	Initialized = 1;
@@ -1144,6 +1214,14 @@ void FObjectManager::Init()
 	// Allocate hardcoded objects.
 	AddToRoot( new UTextBufferFactory );
 
+	// Garbage collection.
+	AddTenureClass( UField::StaticClass );
+	GetConfigFloat( "Core.System", "MinorGCInterval", MinorGCInterval );
+	GetConfigFloat( "Core.System", "MinorGCBudget",   MinorGCBudget   );
+	GetConfigInt  ( "Core.System", "GCThreads",       GCThreads       );
+	GetConfigFloat( "Core.System", "AsyncLoadBudget", AsyncLoadBudget );
+	LastGCTime = appSeconds();
+
 	debugf( NAME_Init, "Object subsystem initialized" );
 	unguard;
 }
@@ -1191,6 +1269,8 @@ void FObjectManager::Exit()
 
 	// Cleanup root.
 	RemoveFromRoot( TransientPackage );
+	AbortMinorGC();
+	ExitAsyncLoading();
 
 	// Tag all objects as unreachable.
 	for( FObjectIterator It; It; ++It )
@@ -1204,6 +1284,9 @@ void FObjectManager::Exit()
 	// Purge all objects.
 	PurgeGarbage( GSystem );
 	Objects.Empty();
+	ObjectGen.Empty();
+	ObjectDirty.Empty();
+	DirtyObjects.Empty();
 
 	// Shut down names.
 	FName::ExitSubsystem();
@@ -1233,6 +1316,19 @@ void FObjectManager::Tick()
 	if( GIntrinsicDuplicate )
 		appErrorf( "Duplicate intrinsic registered: %i", GIntrinsicDuplicate );
 
+	// Collect young garbage a little at a time.
+	if( MinorGCInterval>0.0 && !GIsEditor && !GNoGC )
+	{
+		DOUBLE Time = appSeconds();
+		if( !IncrementalGC && Time-LastGCTime>=MinorGCInterval )
+			BeginMinorGC( RF_Intrinsic );
+		if( IncrementalGC )
+			StepMinorGC( Time + MinorGCBudget/1000.0 );
+	}
+
+	// Load packages that finished reading in the background.
+	TickAsyncLoading( appSeconds() + AsyncLoadBudget/1000.0 );
+
 	unguard;
 }
 
@@ -1357,9 +1453,16 @@ UBOOL FObjectManager::Exec( const char* Cmd, FOutputDevice* Out )
 	const char *Str = Cmd;
 	if( ParseCommand(&Str,"MEM") )
 	{
-		appDumpAllocs( Out );
+		if( ParseCommand(&Str,"STATS") )
+			appMemStats( Out );
+		else
+			appDumpAllocs( Out );
 		return 1;
 	}
+	else if( ParseCommand(&Str,"PROFILESCRIPT") )
+	{
+		return FScriptProfiler::Exec( Str, Out );
+	}
 	else if( ParseCommand(&Str,"DUMPINTRINSICS") )
 	{
 		for( INT i=0; i<EX_Max; i++ )
@@ -1414,6 +1517,22 @@ UBOOL FObjectManager::Exec( const char* Cmd, FOutputDevice* Out )
 		else Out->Logf( NAME_ExecWarning, "Unrecognized class %s", ClassName );
 		return 1;
 	}
+	else if( ParseCommand(&Str,"GC") )
+	{
+		if( ParseCommand(&Str,"STATS") )
+		{
+			if( !GGCStats.Kind )
+			{
+				Out->Log( "No garbage collections yet" );
+				return 1;
+			}
+			Out->Logf( "%s collection: mark %.2f ms, purge %.2f ms", GGCStats.Kind, GGCStats.MarkTime*1000.0, GGCStats.PurgeTime*1000.0 );
+			for( INT i=0; i<GGCStats.NumThreads; i++ )
+				Out->Logf( "   Thread %i: %i objects", i, GGCStats.Scanned[i] );
+			return 1;
+		}
+		else return 0;
+	}
 	else if( ParseCommand(&Str,"OBJ") )
 	{
 		if( ParseCommand(&Str,"GARBAGE") )
@@ -1421,10 +1540,30 @@ UBOOL FObjectManager::Exec( const char* Cmd, FOutputDevice* Out )
 			// Purge unclaimed objects.
 			UBOOL GSavedNoGC=GNoGC;
 			GNoGC = 0;
-			CollectGarbage( Out, RF_Intrinsic | (GIsEditor ? RF_Standalone : 0) );
+			DWORD KeepFlags = RF_Intrinsic | (GIsEditor ? RF_Standalone : 0);
+			if( ParseCommand(&Str,"MINOR") )
+			{
+				// Run a whole minor collection now.
+				AbortMinorGC();
+				BeginMinorGC( KeepFlags );
+				StepMinorGC( 0.0 );
+			}
+			else CollectGarbage( Out, KeepFlags );
 			GNoGC = GSavedNoGC;
 			return 1;
 		}
+		else if( ParseCommand(&Str,"PRELOAD") )
+		{
+			// Read a package in the background, and load it when ready.
+			char Filename[256];
+			if( ParseToken( Str, Filename, ARRAY_COUNT(Filename), 0 ) )
+			{
+				Out->Logf( "Preloading %s", Filename );
+				RequestPackage( Filename );
+			}
+			else Out->Log( "Usage: OBJ PRELOAD <package>" );
+			return 1;
+		}
 		else if( ParseCommand(&Str,"MARK") )
 		{
 			debugf( "Marking objects" );
@@ -1460,14 +1599,28 @@ UBOOL FObjectManager::Exec( const char* Cmd, FOutputDevice* Out )
 		}
 		else if( ParseCommand(&Str,"HASH") )
 		{
-			// Hash info.
+			// Hash info; probe length is the distance from an object's home slot, plus one.
 			FName::DisplayHash(Out);
-			INT ObjCount=0, HashCount=0;
-			for( FObjectIterator It; It; ++It )
-				ObjCount++;
-			for( int i=0; i<ARRAY_COUNT(ObjHash); i++ )
-				if( ObjHash[i] )
-					HashCount++;
+			INT Mask=(1<<ObjHashBits)-1, ObjCount=0, TotalProbes=0, MaxProbes=0;
+			for( INT i=0; i<=Mask; i++ )
+			{
+				if( ObjHash[i].Object )
+				{
+					INT Probes   = ((i - ObjHashHome(ObjHash[i].Name,ObjHashBits)) & Mask) + 1;
+					TotalProbes += Probes;
+					MaxProbes    = Max( MaxProbes, Probes );
+					ObjCount++;
+				}
+			}
+			Out->Logf
+			(
+				"Object hash: %i objects in %i slots (%.0f%% full), average probe %.2f, longest %i",
+				ObjCount,
+				Mask+1,
+				100.0 * ObjCount / (Mask+1),
+				ObjCount ? (FLOAT)TotalProbes/ObjCount : 0.0,
+				MaxProbes
+			);
 			return 1;
 		}
 		else if( ParseCommand(&Str,"CLASSES") )
@@ -1778,6 +1931,8 @@ UObject* FObjectManager::LoadObject( UClass* ObjectClass, UObject* InParent, con
 		ResolveName( InParent, InName, 1, 1 );
 		if( !(LoadFlags & LOAD_DisallowFiles) )
 			Linker = GetPackageLinker( InParent, Filename, LoadFlags | LOAD_Throw | LOAD_AllowDll, Sandbox, NULL );
+		if( Linker && !(LoadFlags & LOAD_Verify) )
+			ReleasePreloaded( Linker->LinkerRoot );
 		if( Linker )
 			Result = Linker->Create( ObjectClass, InName, LoadFlags, 0 );
 		if( !Result )
@@ -1834,7 +1989,10 @@ UObject* FObjectManager::LoadPackage( UObject* InParent, const char* Filename, D
 		// Create a new linker object which goes off and tries load the file.
 		ULinkerLoad* Linker = GetPackageLinker( InParent, Filename ? Filename : InParent->GetName(), LoadFlags | LOAD_Throw, NULL, NULL );
 		if( !(LoadFlags & LOAD_Verify) )
+		{
+			ReleasePreloaded( Linker->LinkerRoot );
 			Linker->LoadAllObjects();
+		}
 		Result = Linker->LinkerRoot;
 		EndLoad();
 	}
@@ -1938,6 +2096,528 @@ void FObjectManager::ResetLoaders( UObject* Pkg )
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	FObjectManager asynchronous loading.
+-----------------------------------------------------------------------------*/
+
+//
+// State of a file being read in the background.
+//
+enum EAsyncState
+{
+	ASYNC_Queued	= 0,	// Waiting for, or being read by, the loader thread.
+	ASYNC_Read		= 1,	// Contents and imports are available.
+	ASYNC_Failed	= 2,	// Couldn't be read; it will be loaded the usual way.
+};
+
+//
+// A package file read in the background.  Only the loader thread touches
+// it while it's queued; after that, only the game thread does.
+//
+struct FAsyncFile
+{
+	char				Filename[256];	// Resolved filename.
+	BYTE*				Data;			// File contents, until a linker takes them.
+	INT					Size;			// Size of Data.
+	TArray<FString>		Imports;		// Names of the packages it imports.
+	UBOOL				Expanded;		// Whether its imports were queued.
+	std::atomic<INT>	State;			// EAsyncState.
+};
+
+//
+// A package requested with RequestPackage, and all of the files being
+// read for it.
+//
+struct FAsyncRequest
+{
+	char				Filename[256];	// Filename as requested.
+	FAsyncLoadCallback	Callback;		// Called once loaded, may be NULL.
+	void*				UserData;		// Passed to Callback.
+	TArray<FAsyncFile*>	Files;			// The package and its imports.
+	UObject*			Package;		// The package, once loading has started.
+	INT					NextExport;		// Next of its exports to create.
+	TArray<UObject*>	Loaded;			// Objects kept from garbage collection until used.
+};
+
+//
+// Archive that reads a package's name and import tables out of memory,
+// without touching the name table, so it can run off the game thread.
+//
+class FArchivePackageScan : public FArchive
+{
+public:
+	FArchivePackageScan( const BYTE* InData, INT InSize )
+	:	Data( InData )
+	,	Size( InSize )
+	,	Pos( 0 )
+	{
+		ArIsLoading = 1;
+	}
+	FArchive& Serialize( void* V, INT Length )
+	{
+		if( Length<0 || Length>Size-Pos )
+			throw( "Truncated package" );
+		appMemcpy( V, Data+Pos, Length );
+		Pos += Length;
+		return *this;
+	}
+	void Seek( INT InPos )
+	{
+		if( InPos<0 || InPos>Size )
+			throw( "Bad package offset" );
+		Pos = InPos;
+	}
+	void SetVer( INT InVer )
+	{
+		ArVer = InVer;
+	}
+private:
+	const BYTE* Data;
+	INT Size, Pos;
+};
+
+//
+// Reads queued package files on a background thread.  The thread is
+// started when files are queued and exits once the queue is empty.
+//
+class FAsyncLoader
+{
+public:
+	TArray<FAsyncRequest*>	Requests;	// Outstanding requests, game thread only.
+	TArray<FAsyncRequest*>	Preloaded;	// Loaded requests waiting to be used, game thread only.
+	TArray<FAsyncFile*>		Queue;		// Files waiting to be read, guarded by Lock.
+	FMutex					Lock;
+	std::atomic<INT>		Running;	// Whether the loader thread is running.
+	std::atomic<INT>		Abort;		// Tells the loader thread to stop early.
+
+	// Constructor.
+	FAsyncLoader()
+	:	Lock( "AsyncLoad" )
+	{
+		Running = 0;
+		Abort   = 0;
+	}
+
+	// Queue a file to be read, starting the loader thread if needed.  If
+	// the thread can't be started, the file is read right away.
+	void Enqueue( FAsyncFile* File )
+	{
+		guard(FAsyncLoader::Enqueue);
+		Lock.Lock();
+		Queue.AddItem( File );
+		UBOOL Start = !Running.load();
+		if( Start )
+			Running = 1;
+		Lock.Unlock();
+		if( Start && !appThreadSpawn( ThreadEntry, this, "AsyncLoad", 1, NULL ) )
+			ThreadMain();
+		unguard;
+	}
+
+	// Stop the loader thread and free everything, without loading.
+	~FAsyncLoader()
+	{
+		Abort = 1;
+		while( Running.load() )
+			appSleep( 0.001f );
+		for( INT i=0; i<Requests.Num(); i++ )
+		{
+			FreeFiles( Requests(i) );
+			delete Requests(i);
+		}
+		for( INT i=0; i<Preloaded.Num(); i++ )
+			delete Preloaded(i);
+	}
+
+	// Free the files read for a request.
+	static void FreeFiles( FAsyncRequest* Request )
+	{
+		for( INT i=0; i<Request->Files.Num(); i++ )
+		{
+			if( Request->Files(i)->Data )
+				appFree( Request->Files(i)->Data );
+			delete Request->Files(i);
+		}
+		Request->Files.Empty();
+	}
+
+	// Find an outstanding or loaded request for a file.
+	FAsyncRequest* FindRequest( const char* Filename )
+	{
+		for( INT i=0; i<Requests.Num(); i++ )
+			if( appStricmp( Requests(i)->Filename, Filename )==0 )
+				return Requests(i);
+		for( INT i=0; i<Preloaded.Num(); i++ )
+			if( appStricmp( Preloaded(i)->Filename, Filename )==0 )
+				return Preloaded(i);
+		return NULL;
+	}
+
+	// Keep the objects of partly loaded and unused packages from being
+	// garbage collected.
+	void Serialize( FArchive& Ar )
+	{
+		for( INT i=0; i<Requests.Num(); i++ )
+			for( INT j=0; j<Requests(i)->Loaded.Num(); j++ )
+				Ar << Requests(i)->Loaded(j);
+		for( INT i=0; i<Preloaded.Num(); i++ )
+			for( INT j=0; j<Preloaded(i)->Loaded.Num(); j++ )
+				Ar << Preloaded(i)->Loaded(j);
+	}
+
+	// Find a file being read for any request.
+	FAsyncFile* FindFile( const char* Filename )
+	{
+		for( INT i=0; i<Requests.Num(); i++ )
+			for( INT j=0; j<Requests(i)->Files.Num(); j++ )
+				if( appStricmp( Requests(i)->Files(j)->Filename, Filename )==0 )
+					return Requests(i)->Files(j);
+		return NULL;
+	}
+
+private:
+	// Loader thread main loop.
+	void ThreadMain()
+	{
+		while( 1 )
+		{
+			Lock.Lock();
+			if( Queue.Num()==0 || Abort.load() )
+			{
+				Running = 0;
+				Lock.Unlock();
+				return;
+			}
+			FAsyncFile* File = Queue(0);
+			Queue.Remove( 0 );
+			Lock.Unlock();
+			ReadFile( File );
+		}
+	}
+#ifdef PLATFORM_WIN32
+	static DWORD __stdcall ThreadEntry( void* Arg )
+#else
+	static void* ThreadEntry( void* Arg )
+#endif
+	{
+		((FAsyncLoader*)Arg)->ThreadMain();
+		return 0;
+	}
+
+	// Read a whole file, and find out which packages it imports.
+	//warning: Runs outside of the game thread, so it must not touch
+	// names or objects.
+	static void ReadFile( FAsyncFile* File )
+	{
+		FILE* F = appFopen( File->Filename, "rb" );
+		if( F )
+		{
+			appFseek( F, 0, USEEK_END );
+			File->Size = appFtell( F );
+			appFseek( F, 0, USEEK_SET );
+			if( File->Size > 0 )
+			{
+				File->Data = (BYTE*)appMalloc( File->Size, "AsyncLoad" );
+				if( appFread( File->Data, File->Size, 1, F )!=1 )
+				{
+					appFree( File->Data );
+					File->Data = NULL;
+				}
+			}
+			appFclose( F );
+		}
+		if( File->Data )
+		{
+			try
+			{
+				ScanImports( File );
+			}
+			catch( ... )
+			{
+				// Not a valid package; let the linker report it.
+				File->Imports.Empty();
+			}
+		}
+		File->State = File->Data ? ASYNC_Read : ASYNC_Failed;
+	}
+
+	// Find the names of the packages a file imports from.
+	static void ScanImports( FAsyncFile* File )
+	{
+		FArchivePackageScan Ar( File->Data, File->Size );
+		FPackageFileSummary Summary;
+		Ar << Summary;
+		if( (DWORD)Summary.Tag != PACKAGE_FILE_TAG )
+			return;
+		Ar.SetVer( Summary.FileVersion );
+
+		// Names.
+		TArray<FString> Names;
+		Ar.Seek( Summary.NameOffset );
+		for( INT i=0; i<Summary.NameCount; i++ )
+		{
+			FNameEntry Entry;
+			Ar << Entry;
+			new(Names)FString( Entry.Name );
+		}
+
+		// Imports of top level packages.
+		Ar.Seek( Summary.ImportOffset );
+		for( INT i=0; i<Summary.ImportCount; i++ )
+		{
+			INT ClassPackage, ClassName, PackageIndex=0, ObjectName;
+			Ar << AR_INDEX(ClassPackage) << AR_INDEX(ClassName);
+			if( Summary.FileVersion>=50 )
+				Ar << PackageIndex;
+			else//oldver
+				Ar << AR_INDEX(PackageIndex);
+			Ar << AR_INDEX(ObjectName);
+
+			INT Index;
+			if( Summary.FileVersion>=50 )
+				Index = (PackageIndex==0 && Names.IsValidIndex(ClassName) && appStricmp(*Names(ClassName),"Package")==0) ? ObjectName : -1;
+			else
+				Index = PackageIndex;
+			if( !Names.IsValidIndex(Index) )
+				continue;
+			UBOOL Found = 0;
+			for( INT j=0; j<File->Imports.Num() && !Found; j++ )
+				Found = appStricmp( *File->Imports(j), *Names(Index) )==0;
+			if( !Found )
+				new(File->Imports)FString( Names(Index) );
+		}
+	}
+};
+
+//
+// Start reading a package and the packages it imports in the background.
+// Once they've been read, the package is loaded during a later Tick,
+// and Callback is called with the result.
+//
+void FObjectManager::RequestPackage( const char* Filename, FAsyncLoadCallback Callback, void* UserData )
+{
+	guard(FObjectManager::RequestPackage);
+	if( !AsyncLoader )
+		AsyncLoader = new FAsyncLoader;
+
+	// Without a callback, there's nothing to do for packages which are
+	// missing, already loaded, or already requested.
+	if( !Callback )
+	{
+		char Found[256];
+		if( AsyncLoader->FindRequest( Filename ) || !appFindPackageFile( Filename, NULL, Found ) )
+			return;
+		for( INT i=0; i<Loaders.Num(); i++ )
+			if( appStricmp( GetLoader(i)->Filename, Found )==0 )
+				return;
+	}
+
+	FAsyncRequest* Request = new FAsyncRequest;
+	appStrncpy( Request->Filename, Filename, ARRAY_COUNT(Request->Filename) );
+	Request->Callback   = Callback;
+	Request->UserData   = UserData;
+	Request->Package    = NULL;
+	Request->NextExport = 0;
+	AsyncLoader->Requests.AddItem( Request );
+	QueueAsyncFile( Request, Filename );
+
+	unguard;
+}
+
+//
+// Queue a package file to be read for a request, unless it's already
+// loaded or being read.
+//
+void FObjectManager::QueueAsyncFile( FAsyncRequest* Request, const char* PackageName )
+{
+	guard(FObjectManager::QueueAsyncFile);
+
+	for( INT i=0; i<Loaders.Num(); i++ )
+		if( appStricmp( GetLoader(i)->LinkerRoot->GetName(), PackageName )==0 )
+			return;
+	char Filename[256];
+	if( !appFindPackageFile( PackageName, NULL, Filename ) || AsyncLoader->FindFile( Filename ) )
+		return;
+
+	FAsyncFile* File = new FAsyncFile;
+	appStrcpy( File->Filename, Filename );
+	File->Data     = NULL;
+	File->Size     = 0;
+	File->Expanded = 0;
+	File->State    = ASYNC_Queued;
+	Request->Files.AddItem( File );
+	AsyncLoader->Enqueue( File );
+
+	unguard;
+}
+
+//
+// Queue the imports of files that have been read, and load the first
+// request whose files have all been read, until EndTime or until it's
+// done if EndTime is zero.
+//
+void FObjectManager::TickAsyncLoading( DOUBLE EndTime )
+{
+	guard(FObjectManager::TickAsyncLoading);
+	if( !AsyncLoader )
+		return;
+
+	FAsyncRequest* Ready = NULL;
+	for( INT i=0; i<AsyncLoader->Requests.Num(); i++ )
+	{
+		FAsyncRequest* Request = AsyncLoader->Requests(i);
+		UBOOL Done = 1;
+		for( INT j=0; j<Request->Files.Num(); j++ )
+		{
+			FAsyncFile* File = Request->Files(j);
+			INT State = File->State.load();
+			if( State==ASYNC_Queued )
+			{
+				Done = 0;
+			}
+			else if( State==ASYNC_Read && !File->Expanded )
+			{
+				File->Expanded = 1;
+				for( INT k=0; k<File->Imports.Num(); k++ )
+					QueueAsyncFile( Request, *File->Imports(k) );
+				Done = 0;
+			}
+		}
+		if( Done && !Ready )
+			Ready = Request;
+	}
+	if( !Ready || !StepAsyncLoading( Ready, EndTime ) )
+		return;
+
+	// Loaded; the package is NULL if it failed.
+	AsyncLoader->Requests.RemoveItem( Ready );
+	FAsyncLoader::FreeFiles( Ready );
+	if( Ready->Callback )
+	{
+		// The callback must keep whatever it wants to use.
+		Ready->Callback( Ready->Package, Ready->UserData );
+		delete Ready;
+	}
+	else if( Ready->Package )
+	{
+		// Keep it until it's loaded for real.
+		AsyncLoader->Preloaded.AddItem( Ready );
+	}
+	else delete Ready;
+
+	unguard;
+}
+
+//
+// Create the exports of a request whose files have been read, until
+// EndTime or until done if EndTime is zero.  Each step is a complete load,
+// so objects may be garbage collected between steps; the request keeps
+// those it has created.  Returns whether the request is finished.
+//
+UBOOL FObjectManager::StepAsyncLoading( FAsyncRequest* Request, DOUBLE EndTime )
+{
+	guard(FObjectManager::StepAsyncLoading);
+	UBOOL Done;
+	BeginLoad();
+	try
+	{
+		// Find or make the linker, which takes the contents of files read for it.
+		ULinkerLoad* Linker = GetPackageLinker( Request->Package, Request->Package ? NULL : Request->Filename, LOAD_NoWarn | LOAD_Throw, NULL, NULL );
+		if( !Request->Package )
+		{
+			Request->Package = Linker->LinkerRoot;
+			Request->Loaded.AddItem( Request->Package );
+		}
+		Request->Loaded.AddUniqueItem( Linker );
+
+		// Create exports until time runs out.
+		while( Request->NextExport<Linker->ExportMap.Num() )
+		{
+			UObject* Object = Linker->CreateExport( Request->NextExport++ );
+			if( Object )
+				Request->Loaded.AddItem( Object );
+			if( EndTime!=0.0 && appSeconds()>EndTime )
+				break;
+		}
+		Done = Request->NextExport>=Linker->ExportMap.Num();
+		EndLoad();
+	}
+	catch( char* Error )
+	{
+		EndLoad();
+		SafeLoadError( LOAD_NoWarn, Error, LocalizeError("FailedLoadPackage"), Error );
+		Request->Package = NULL;
+		Request->Loaded.Empty();
+		Done = 1;
+	}
+	return Done;
+	unguard;
+}
+
+//
+// Wait for all requested packages to be read and loaded.
+//
+void FObjectManager::FlushAsyncLoading()
+{
+	guard(FObjectManager::FlushAsyncLoading);
+	while( AsyncLoader && AsyncLoader->Requests.Num() )
+	{
+		INT Num = AsyncLoader->Requests.Num();
+		TickAsyncLoading( 0.0 );
+		if( AsyncLoader->Requests.Num()==Num )
+			appSleep( 0.001f );
+	}
+	unguard;
+}
+
+//
+// Stop reading and loading packages in the background.
+//
+void FObjectManager::ExitAsyncLoading()
+{
+	guard(FObjectManager::ExitAsyncLoading);
+	if( AsyncLoader )
+	{
+		delete AsyncLoader;
+		AsyncLoader = NULL;
+	}
+	unguard;
+}
+
+//
+// Stop keeping a preloaded package from garbage collection, now that it
+// has been loaded for use.
+//
+void FObjectManager::ReleasePreloaded( UObject* Package )
+{
+	guard(FObjectManager::ReleasePreloaded);
+	for( INT i=0; AsyncLoader && i<AsyncLoader->Preloaded.Num(); i++ )
+	{
+		if( AsyncLoader->Preloaded(i)->Package==Package )
+		{
+			delete AsyncLoader->Preloaded(i);
+			AsyncLoader->Preloaded.Remove( i-- );
+		}
+	}
+	unguard;
+}
+
+//
+// If a file has been read in the background, hand its contents over to
+// the caller, who becomes responsible for freeing them.
+//
+UBOOL FObjectManager::TakePreloadedFile( const char* Filename, BYTE*& Data, INT Size )
+{
+	guard(FObjectManager::TakePreloadedFile);
+	FAsyncFile* File = AsyncLoader ? AsyncLoader->FindFile( Filename ) : NULL;
+	if( !File || File->State.load()!=ASYNC_Read || !File->Data || File->Size!=Size )
+		return 0;
+	Data       = File->Data;
+	File->Data = NULL;
+	return 1;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	FObjectManager file saving.
 -----------------------------------------------------------------------------*/
@@ -2406,43 +3086,68 @@ FName FObjectManager::MakeUniqueObjectName( UObject* Parent, UClass* Class )
 -----------------------------------------------------------------------------*/
 
 //
-// Add an object to the hash table.
+// Add an object to the hash table, which uses linear probing and is kept
+// at most half full.
 //
 void FObjectManager::HashObject( UObject* Obj )
 {
 	guard(FObjectManager::HashObject);
 
-	INT iHash      = Obj->GetHash();
-	Obj->HashNext  = ObjHash[iHash];
-	ObjHash[iHash] = Obj;
+	if( (ObjHashNum+1)*2 > (1<<ObjHashBits) )
+	{
+		// Double the table and reinsert everything.
+		FObjectSlot* OldHash = ObjHash;
+		INT          OldSize = 1<<ObjHashBits;
+		ObjHashBits++;
+		ObjHash = (FObjectSlot*)appMalloc( (1<<ObjHashBits)*sizeof(FObjectSlot), "ObjHash" );
+		appMemset( ObjHash, 0, (1<<ObjHashBits)*sizeof(FObjectSlot) );
+		for( INT i=0; i<OldSize; i++ )
+		{
+			if( OldHash[i].Object )
+			{
+				INT j;
+				for( j=ObjHashHome(OldHash[i].Name,ObjHashBits); ObjHash[j].Object; j=(j+1) & ((1<<ObjHashBits)-1) );
+				ObjHash[j] = OldHash[i];
+			}
+		}
+		appFree( OldHash );
+	}
+
+	INT i;
+	for( i=ObjHashHome(Obj->Name.GetIndex(),ObjHashBits); ObjHash[i].Object; i=(i+1) & ((1<<ObjHashBits)-1) );
+	ObjHash[i].Object = Obj;
+	ObjHash[i].Parent = Obj->Parent;
+	ObjHash[i].Name   = Obj->Name.GetIndex();
+	ObjHashNum++;
 
 	unguard;
 }
 
 //
-// Remove an object from the hash table.
+// Remove an object from the hash table.  Later objects in its probe run
+// are shifted back, so that no tombstones are needed.
 //
 void FObjectManager::UnhashObject( UObject* Obj )
 {
 	guard(FObjectManager::UnhashObject);
 
-	INT       iHash   = Obj->GetHash();
-	UObject** Hash    = &ObjHash[iHash];
-	INT       Removed = 0;
-	while( *Hash != NULL )
+	INT Mask = (1<<ObjHashBits)-1;
+	INT i;
+	for( i=ObjHashHome(Obj->Name.GetIndex(),ObjHashBits); ObjHash[i].Object!=Obj; i=(i+1) & Mask )
+		check(ObjHash[i].Object!=NULL);
+	for( INT j=(i+1) & Mask; ObjHash[j].Object; j=(j+1) & Mask )
 	{
-		if( *Hash != Obj )
-		{
-			Hash = &(*Hash)->HashNext;
- 		}
-		else
+		// Move the object at j into the hole unless its home slot lies
+		// cyclically between the hole and j.
+		INT Home = ObjHashHome( ObjHash[j].Name, ObjHashBits );
+		if( ((j-Home) & Mask) >= ((j-i) & Mask) )
 		{
-			*Hash = (*Hash)->HashNext;
-			Removed++;
+			ObjHash[i] = ObjHash[j];
+			i          = j;
 		}
 	}
-	check(Removed!=0);
-	check(Removed==1);
+	ObjHash[i].Object = NULL;
+	ObjHashNum--;
 
 	unguard;
 }
@@ -2475,6 +3180,16 @@ void FObjectManager::AddObject( UObject* Obj, INT Index )
 	Obj->Index      = Index;
 	HashObject( Obj );
 
+	// New objects start out young.
+	if( ObjectGen.Num() < Objects.Num() )
+		ObjectGen.Add( Objects.Num() - ObjectGen.Num() );
+	ObjectGen(Index) = GEN_Young;
+
+	// Its references are set up after marking may have passed it.
+	if( ObjectDirty.Num() < Objects.Num() )
+		ObjectDirty.AddZeroed( Objects.Num() - ObjectDirty.Num() );
+	NoteWrite( Obj );
+
 	unguard;
 }
 
@@ -2516,7 +3231,7 @@ UObject* FObjectManager::AllocateObject
 	if( !Obj )
 	{
 		// Create a new object.
-		Obj = (UObject *)appMalloc( InClass->GetPropertiesSize(), *InName );
+		Obj = (UObject *)appMalloc( InClass->GetPropertiesSize(), InClass->GetName() );
 	}
 	else
 	{
@@ -2599,12 +3314,12 @@ UObject* FObjectManager::ConstructObject
 	//DWORD Time=0; uclock(Time);
 
 	if( GCheckConflicts )
-		for( UObject* Hash=ObjHash[InName.GetIndex() & (ARRAY_COUNT(ObjHash)-1)]; Hash!=NULL; Hash=Hash->HashNext )
+		for( INT i=ObjHashHome(InName.GetIndex(),ObjHashBits); ObjHash[i].Object; i=(i+1) & ((1<<ObjHashBits)-1) )
 			if
-			(	Hash->GetFName()==InName
-			&&	Hash->Parent==InParent
-			&&	Hash->GetClass()!=InClass )
-				debugf(NAME_Log,"CONFLICT: %s - %s",Hash->GetFullName(),InClass->GetName());
+			(	ObjHash[i].Name==InName.GetIndex()
+			&&	ObjHash[i].Parent==InParent
+			&&	ObjHash[i].Object->GetClass()!=InClass )
+				debugf(NAME_Log,"CONFLICT: %s - %s",ObjHash[i].Object->GetFullName(),InClass->GetName());
 
 	// Allocate the object.
 	UObject* Result = AllocateObject( InClass, InParent, InName, InFlags, InTemplate );
@@ -2634,44 +3349,320 @@ UObject* FObjectManager::ConstructObject
 -----------------------------------------------------------------------------*/
 
 //
-// Archive for finding unused objects.
+// State shared by the threads of a parallel mark.
+//
+struct FParallelMark
+{
+	class FArchiveTagUsed* Markers[MAX_GC_THREADS];
+	INT NumMarkers;
+	std::atomic<INT> Active;
+	std::atomic<INT> Failed;
+};
+
+//
+// Archive for finding unused objects.  Claimed objects are kept on an
+// explicit stack instead of being recursed into, so the incremental
+// collector can stop marking at the end of one tick and resume the next,
+// and so several threads can share out the work of a full collection.
 //
 class FArchiveTagUsed : public FArchive
 {
 public:
-	FArchiveTagUsed()
-	: Context( NULL )
+	enum EMode
+	{
+		MODE_Full,	// Mark everything, leave generations alone.
+		MODE_Major,	// Mark everything and work out generations.
+		MODE_Minor,	// Assume tenured objects are reachable, mark young ones.
+	};
+	FArchiveTagUsed( EMode InMode=MODE_Full )
+	:	Mode( InMode )
+	,	KeepFlags( 0 )
+	,	Context( NULL )
+	,	Scanned( 0 )
+	,	Parallel( NULL )
+	,	StackLock( NULL )
 	{
 		guard(FArchiveTagUsed::FArchiveTagUsed);
 
-		// Tag all objects as unreachable.
-		for( FObjectIterator It; It; ++It )
-			It->SetFlags( RF_Unreachable | RF_TagGarbage );
+		// Tag all objects as unreachable, except tenured ones in a minor collection.
+		for( INT i=0; i<GObj.Objects.Num(); i++ )
+		{
+			UObject* Obj = GObj.Objects(i);
+			if( !Obj )
+				continue;
+			if( Mode==MODE_Major )
+				GObj.ObjectGen(i) = GObj.IsTenurable(Obj) ? GEN_Tenured : GEN_Young;
+			if( Mode==MODE_Minor && GObj.ObjectGen(i)!=GEN_Young )
+			{
+				Obj->ClearFlags( RF_Unreachable );
+				if( GObj.ObjectGen(i)==GEN_Remembered )
+					Stack.AddItem( i );
+			}
+			else Obj->SetFlags( RF_Unreachable | RF_TagGarbage );
+		}
 
-		// Tag all names as unreachable.
-		for( INT i=0; i<FName::GetMaxNames(); i++ )
-			if( FName::GetEntry(i) )
-				FName::GetEntry(i)->Flags |= RF_Unreachable;
+		// Tag all names as unreachable.  Tenured objects aren't scanned in
+		// a minor collection, so it can't tell which names are unused.
+		if( Mode!=MODE_Minor )
+			for( INT i=0; i<FName::GetMaxNames(); i++ )
+				if( FName::GetEntry(i) )
+					FName::GetEntry(i)->Flags |= RF_Unreachable;
 
 		unguard;
 	}
-	void Tag( DWORD KeepFlags )
+	FArchiveTagUsed( FArchiveTagUsed& Main, FParallelMark* InParallel )
+	:	Mode( Main.Mode )
+	,	KeepFlags( Main.KeepFlags )
+	,	Context( NULL )
+	,	Scanned( 0 )
+	,	Parallel( InParallel )
+	,	StackLock( new FMutex("GCMark") )
+	{}
+	virtual ~FArchiveTagUsed()
+	{
+		if( StackLock )
+			delete StackLock;
+	}
+	void Tag( DWORD InKeepFlags, INT NumThreads=1 )
 	{
 		guard(FArchiveTagUsed::Tag);
+		MarkRoots( InKeepFlags );
+		if( NumThreads>1 && Stack.Num()>1 )
+			MarkParallel( NumThreads );
+		else
+			Drain( 0.0 );
+		unguard;
+	}
+	void MarkRoots( DWORD InKeepFlags )
+	{
+		guard(FArchiveTagUsed::MarkRoots);
 
 		// Tag all root objects' references.
+		KeepFlags = InKeepFlags;
 		*this << GObj.Root;
-		for( FObjectIterator It; It; ++It )
+		if( GObj.AsyncLoader )
+			GObj.AsyncLoader->Serialize( *this );
+		for( INT i=0; i<GObj.Objects.Num(); i++ )
 		{
-			if( (It->GetFlags()&KeepFlags) && (It->GetFlags()&RF_TagGarbage) )
-			{
-				UObject* Obj = *It;
+			UObject* Obj = GObj.Objects(i);
+			if( Obj && (Obj->GetFlags()&KeepFlags) && (Obj->GetFlags()&RF_TagGarbage) )
 				*this << Obj;
-			}
+		}
+		unguard;
+	}
+	UBOOL Drain( DOUBLE EndTime )
+	{
+		guard(FArchiveTagUsed::Drain);
+
+		// Scan claimed objects until there are none left or time runs out.
+		INT Index;
+		while( Pop(Index) )
+		{
+			// The object may have been deleted outright since it was claimed.
+			if( GObj.Objects(Index) )
+				Scan( GObj.Objects(Index) );
+			if( EndTime!=0.0 && (Scanned&63)==0 && appSeconds()>EndTime )
+				break;
+		}
+		return Stack.Num()==0;
+		unguard;
+	}
+	void Remark()
+	{
+		guard(FArchiveTagUsed::Remark);
+
+		// Marking was spread over several ticks, so re-scan the root set
+		// and the objects written since it began, as recorded by the write
+		// barrier.  Anything newly claimed is traced as usual.  Written
+		// tenured objects may now refer to young ones, so remember them.
+		*this << GObj.Root;
+		if( GObj.AsyncLoader )
+			GObj.AsyncLoader->Serialize( *this );
+		for( INT i=0; i<GObj.DirtyObjects.Num(); i++ )
+		{
+			INT Index = GObj.DirtyObjects(i);
+			UObject* Obj = GObj.Objects(Index);
+			if( !Obj || (Obj->GetFlags() & RF_Unreachable) )
+				continue;
+			if( GObj.ObjectGen(Index)==GEN_Tenured )
+				GObj.ObjectGen(Index) = GEN_Remembered;
+			Stack.AddItem( Index );
+		}
+		Drain( 0.0 );
+		unguard;
+	}
+	INT GetScanned()
+	{
+		return Scanned;
+	}
+	void Mark()
+	{
+		guard(FArchiveTagUsed::Mark);
+		try
+		{
+			MarkLoop();
+		}
+		catch( ... )
+		{
+			// Let the other threads give up, and the main thread report it.
+			Parallel->Failed = 1;
 		}
 		unguard;
 	}
 private:
+	void MarkParallel( INT NumThreads )
+	{
+		guard(FArchiveTagUsed::MarkParallel);
+		FParallelMark Shared;
+		Shared.NumMarkers = Min( NumThreads, (INT)MAX_GC_THREADS );
+		Shared.Active     = Shared.NumMarkers;
+		Shared.Failed     = 0;
+
+		// Split the claimed roots among the markers.
+		Parallel  = &Shared;
+		StackLock = new FMutex( "GCMark" );
+		Shared.Markers[0] = this;
+		for( INT i=1; i<Shared.NumMarkers; i++ )
+			Shared.Markers[i] = new FArchiveTagUsed( *this, &Shared );
+		TArray<INT> Roots = Stack;
+		Stack.Empty();
+		for( INT i=0; i<Roots.Num(); i++ )
+			Shared.Markers[i % Shared.NumMarkers]->Stack.AddItem( Roots(i) );
+
+		// Start the helper threads; if one won't start, take over its roots.
+		UTHREAD Threads[MAX_GC_THREADS];
+		for( INT i=1; i<Shared.NumMarkers; i++ )
+		{
+			Threads[i] = appThreadSpawn( MarkThreadEntry, Shared.Markers[i], "GCMark", 0, NULL );
+			if( !Threads[i] )
+			{
+				TArray<INT> Orphans;
+				Shared.Markers[i]->StealHalf( Orphans, 1 );
+				StackLock->Lock();
+				for( INT j=0; j<Orphans.Num(); j++ )
+					Stack.AddItem( Orphans(j) );
+				StackLock->Unlock();
+				Shared.Active--;
+			}
+		}
+
+		// Mark on this thread too, then wait for the others.
+		Mark();
+		GGCStats.NumThreads = Shared.NumMarkers;
+		for( INT i=0; i<Shared.NumMarkers; i++ )
+		{
+			if( i>0 && Threads[i] )
+				appThreadJoin( Threads[i] );
+			GGCStats.Scanned[i] = Shared.Markers[i]->Scanned;
+			if( i>0 )
+				delete Shared.Markers[i];
+		}
+		delete StackLock;
+		StackLock = NULL;
+		Parallel  = NULL;
+		if( Shared.Failed )
+			appErrorf( "Garbage collection failed on a marking thread" );
+		unguard;
+	}
+#ifdef PLATFORM_WIN32
+	static DWORD __stdcall MarkThreadEntry( void* Arg )
+#else
+	static void* MarkThreadEntry( void* Arg )
+#endif
+	{
+		((FArchiveTagUsed*)Arg)->Mark();
+		return 0;
+	}
+	void MarkLoop()
+	{
+		guard(FArchiveTagUsed::MarkLoop);
+		for( ;; )
+		{
+			// Scan our own claimed objects, then steal some.
+			INT Index;
+			while( Pop(Index) )
+				if( GObj.Objects(Index) )
+					Scan( GObj.Objects(Index) );
+			if( Steal() )
+				continue;
+
+			// Out of work.  Only active markers claim objects, so once
+			// none are active every stack is empty and marking is done.
+			Parallel->Active--;
+			for( ;; )
+			{
+				if( Parallel->Active==0 || Parallel->Failed )
+					return;
+				appSleep( 0.0 );
+				Parallel->Active++;
+				if( Steal() )
+					break;
+				Parallel->Active--;
+			}
+		}
+		unguard;
+	}
+	void Push( INT Index )
+	{
+		if( StackLock )
+			StackLock->Lock();
+		Stack.AddItem( Index );
+		if( StackLock )
+			StackLock->Unlock();
+	}
+	UBOOL Pop( INT& Index )
+	{
+		if( StackLock )
+			StackLock->Lock();
+		UBOOL Result = Stack.Num()>0;
+		if( Result )
+		{
+			Index = Stack(Stack.Num()-1);
+			Stack.Remove( Stack.Num()-1 );
+		}
+		if( StackLock )
+			StackLock->Unlock();
+		return Result;
+	}
+	void StealHalf( TArray<INT>& Result, UBOOL All=0 )
+	{
+		// Take the oldest claims, which tend to lead to the most work.
+		FScopedLock Lock( *StackLock );
+		INT Count = All ? Stack.Num() : (Stack.Num()+1)/2;
+		for( INT i=0; i<Count; i++ )
+			Result.AddItem( Stack(i) );
+		Stack.Remove( 0, Count );
+	}
+	UBOOL Steal()
+	{
+		TArray<INT> Stolen;
+		for( INT i=0; i<Parallel->NumMarkers && !Stolen.Num(); i++ )
+			if( Parallel->Markers[i]!=this )
+				Parallel->Markers[i]->StealHalf( Stolen );
+		for( INT i=0; i<Stolen.Num(); i++ )
+			Push( Stolen(i) );
+		return Stolen.Num()>0;
+	}
+	UBOOL Claim( UObject* Obj )
+	{
+		// When marking in parallel, whichever thread clears the flag wins.
+		if( Parallel )
+			return (appInterlockedAnd( &Obj->ObjectFlags, ~RF_Unreachable ) & RF_Unreachable)!=0;
+		Obj->ClearFlags( RF_Unreachable );
+		return 1;
+	}
+	void Scan( UObject* Obj )
+	{
+		guard(FArchiveTagUsed::Scan);
+		Context = Obj;
+		Obj->ClearFlags( RF_DebugSerialize );
+		Obj->Serialize( *this );
+		if( !(Obj->GetFlags() & RF_DebugSerialize) )
+			appErrorf( "%s failed to route Serialize", Obj->GetFullName() );
+		Context = NULL;
+		Scanned++;
+		unguardf(( "(%s)", Obj->GetFullName() ));
+	}
 	FArchive& operator<<( UObject*& Obj )
 	{
 		guard(FArchiveTagUsed<<Obj);
@@ -2681,22 +3672,23 @@ private:
 			check(Obj->IsValid());
 		unguard;
 
-		if( Obj && (Obj->GetFlags() & RF_Unreachable) )
+		// Remember tenured objects which refer to young ones.
+		if
+		(	Obj
+		&&	Mode==MODE_Major
+		&&	Context
+		&&	GObj.ObjectGen(Context->GetIndex())==GEN_Tenured
+		&&	GObj.ObjectGen(Obj->GetIndex())==GEN_Young )
+			GObj.ObjectGen(Context->GetIndex()) = GEN_Remembered;
+
+		// Only claim the object the first time it's reached.
+		if( Obj && (Obj->GetFlags() & RF_Unreachable) && Claim(Obj) )
 		{
-			// Only recurse the first time object is claimed.
 			guard(TestReach);
-			Obj->ClearFlags( RF_Unreachable | RF_DebugSerialize );
-
-			// Recurse.
 			if( Obj->GetFlags() & RF_TagGarbage )
 			{
-				// Recurse down the object graph.
-				UObject* OriginalContext=Context;
-				Context = Obj;
-				Obj->Serialize( *this );
-				if( !(Obj->GetFlags() & RF_DebugSerialize) )
-					appErrorf( "%s failed to route Serialize", Obj->GetFullName() );
-				Context = OriginalContext;
+				// Scan it later.
+				Push( Obj->GetIndex() );
 			}
 			else
 			{
@@ -2713,18 +3705,63 @@ private:
 	{
 		guard(FArchiveTagUsed::Name);
 
-		Name.ClearFlags( RF_Unreachable );
+		FNameEntry* Entry = FName::GetEntry( Name.GetIndex() );
+		if( Entry->Flags & RF_Unreachable )
+		{
+			if( Parallel )
+				appInterlockedAnd( &Entry->Flags, ~RF_Unreachable );
+			else
+				Entry->Flags &= ~RF_Unreachable;
+		}
 
 		return *this;
 		unguard;
 	}
+	EMode Mode;
+	DWORD KeepFlags;
 	UObject* Context;
+	INT Scanned;
+	TArray<INT> Stack;
+	FParallelMark* Parallel;
+	FMutex* StackLock;
 };
 
+//
+// Whether an object may be tenured: it was loaded from a package and
+// its class has promised loaded objects never change.
+//
+UBOOL FObjectManager::IsTenurable( UObject* Obj )
+{
+	guard(FObjectManager::IsTenurable);
+	if
+	(	GIsEditor
+	||	!Obj->GetLinker()
+	||	(Obj->GetFlags() & RF_Transient)
+	||	Obj->IsA(UClass::StaticClass) )
+		return 0;
+	for( UClass* Class=Obj->GetClass(); Class; Class=Class->GetSuperClass() )
+		for( INT i=0; i<TenureClasses.Num(); i++ )
+			if( TenureClasses(i)==Class )
+				return 1;
+	return 0;
+	unguard;
+}
+
+//
+// Let loaded objects of a class be tenured, so minor collections
+// needn't re-mark them.
+//
+void FObjectManager::AddTenureClass( UClass* Class )
+{
+	guard(FObjectManager::AddTenureClass);
+	TenureClasses.AddUniqueItem( Class );
+	unguard;
+}
+
 //
 // Purge garbage.
 //
-void FObjectManager::PurgeGarbage( FOutputDevice* Out )
+void FObjectManager::PurgeGarbage( FOutputDevice* Out, UBOOL PurgeNames )
 {
 	guard(FObjectManager::PurgeGarbage);
 	if( GNoGC )
@@ -2734,15 +3771,23 @@ void FObjectManager::PurgeGarbage( FOutputDevice* Out )
 	}
 	debugf( NAME_Log, "Purging garbage" );
 
-	// Dispatch all Destroy messages.
-	guard(DispatchDestroys);
+	// Find all unreachable objects.
+	TArray<INT> Garbage;
 	for( INT i=0; i<Objects.Num(); i++ )
-	{
-		guard(DispatchDestroy);
 		if
 		(	Objects(i)
 		&&	(Objects(i)->GetFlags() & RF_Unreachable)
 		&& !(Objects(i)->GetFlags() & RF_Intrinsic) )
+			Garbage.AddItem( i );
+	FScriptProfiler::PurgeGarbage();
+
+	// Dispatch all Destroy messages.
+	guard(DispatchDestroys);
+	for( INT j=0; j<Garbage.Num(); j++ )
+	{
+		INT i = Garbage(j);
+		guard(DispatchDestroy);
+		if( Objects(i) && (Objects(i)->GetFlags() & RF_Unreachable) )
 		{
 			if( Out )
 				Out->Logf( NAME_DevGarbage, "Garbage collected object %i: %s", i, Objects(i)->GetFullName() );
@@ -2750,30 +3795,26 @@ void FObjectManager::PurgeGarbage( FOutputDevice* Out )
 			if( !(Objects(i)->GetFlags()&RF_DebugDestroy) )
 				appErrorf( "%s failed to route Destroy", Objects(i)->GetFullName() );
 		}
-		unguardf(( "(%i: %s)", i, Objects(i)->GetFullName() ));
+		unguardf(( "(%i: %s)", i, Objects(i) ? Objects(i)->GetFullName() : "None" ));
 	}
 	unguard;
 
 	// Purge all unreachable objects.
 	//warning: Can't use FObjectIterator here because classes may be destroyed before objects.
 	guard(DeleteGarbage);
-	for( INT i=0; i<Objects.Num(); i++ )
+	for( INT j=0; j<Garbage.Num(); j++ )
 	{
+		INT i = Garbage(j);
 		guard(DeleteObject);
-		if
-		(	Objects(i)
-		&&	(Objects(i)->GetFlags() & RF_Unreachable) 
-		&& !(Objects(i)->GetFlags() & RF_Intrinsic) )
-		{
+		if( Objects(i) && (Objects(i)->GetFlags() & RF_Unreachable) )
 			delete Objects(i);
-		}
 		unguardf(( "(%i)", i ));
 	}
 	unguard;
 
 	// Purge all unreachable names.
 	guard(Names);
-	for( INT i=0; i<FName::GetMaxNames(); i++ )
+	for( INT i=0; PurgeNames && i<FName::GetMaxNames(); i++ )
 	{
 		FNameEntry* Name = FName::GetEntry(i);
 		if
@@ -2783,6 +3824,7 @@ void FObjectManager::PurgeGarbage( FOutputDevice* Out )
 		{
 			if( Out )
 				Out->Logf( NAME_DevGarbage, "Garbage collected name %i: %s", i, Name->Name );
+			UState::RemoveEventSlot( i );
 			FName::DeleteEntry(i);
 		}
 	}
@@ -2799,13 +3841,125 @@ void FObjectManager::CollectGarbage( FOutputDevice* Out, DWORD KeepFlags )
 	guard(FObjectManager::CollectGarbage);
 	debugf( NAME_Log, "Collecting garbage" );
 
-	// Tag and purge garbage.
-	FArchiveTagUsed TagUsedAr;
-	TagUsedAr.Tag( KeepFlags );
+	// Supersede any minor collection in progress.
+	AbortMinorGC();
+
+	// Tag garbage and sort survivors into generations.
+	DOUBLE StartTime = appSeconds();
+	INT NumThreads   = GCThreads>0 ? GCThreads : Min( appNumCores(), (INT)MAX_GC_THREADS );
+	GGCStats.NumThreads = 1;
+	FArchiveTagUsed TagUsedAr( FArchiveTagUsed::MODE_Major );
+	TagUsedAr.Tag( KeepFlags, NumThreads );
+	if( GGCStats.NumThreads==1 )
+		GGCStats.Scanned[0] = TagUsedAr.GetScanned();
+	DOUBLE MarkEndTime = appSeconds();
 
 	// Purge it.
 	PurgeGarbage( Out );
+	LastGCTime = appSeconds();
 
+	GGCStats.Kind      = "Major";
+	GGCStats.MarkTime  = MarkEndTime - StartTime;
+	GGCStats.PurgeTime = LastGCTime - MarkEndTime;
+
+	unguard;
+}
+
+//
+// Start a minor collection, which only considers young objects.  It
+// is advanced by StepMinorGC.
+//
+void FObjectManager::BeginMinorGC( DWORD KeepFlags )
+{
+	guard(FObjectManager::BeginMinorGC);
+	check(IncrementalGC==NULL);
+
+	DOUBLE StartTime = appSeconds();
+	ClearDirty();
+	IncrementalGC = new FArchiveTagUsed( FArchiveTagUsed::MODE_Minor );
+	IncrementalGC->MarkRoots( KeepFlags );
+	MinorMarkTime = appSeconds() - StartTime;
+
+	unguard;
+}
+
+//
+// Mark young objects until EndTime, or until done if EndTime is zero.
+// Once marking is complete, finish the collection and purge garbage.
+// Returns whether the collection finished.
+//
+UBOOL FObjectManager::StepMinorGC( DOUBLE EndTime )
+{
+	guard(FObjectManager::StepMinorGC);
+	check(IncrementalGC!=NULL);
+	DOUBLE StartTime = appSeconds();
+	UBOOL Done = IncrementalGC->Drain( EndTime );
+	MinorMarkTime += appSeconds() - StartTime;
+	if( !Done )
+		return 0;
+
+	// Finish marking and purge.
+	DOUBLE FinishTime = appSeconds();
+	IncrementalGC->Remark();
+	INT Scanned = IncrementalGC->GetScanned();
+	delete IncrementalGC;
+	IncrementalGC = NULL;
+	ClearDirty();
+	DOUBLE MarkEndTime = appSeconds();
+	PurgeGarbage( GSystem, 0 );
+	LastGCTime = appSeconds();
+	debugf( NAME_DevGarbage, "Minor collection scanned %i objects, finished in %.2f ms", Scanned, (LastGCTime-FinishTime)*1000.0 );
+
+	GGCStats.Kind       = "Minor";
+	GGCStats.MarkTime   = MinorMarkTime + MarkEndTime - FinishTime;
+	GGCStats.PurgeTime  = LastGCTime - MarkEndTime;
+	GGCStats.NumThreads = 1;
+	GGCStats.Scanned[0] = Scanned;
+
+	return 1;
+	unguard;
+}
+
+//
+// Abandon any minor collection in progress.
+//
+void FObjectManager::AbortMinorGC()
+{
+	guard(FObjectManager::AbortMinorGC);
+	if( IncrementalGC )
+	{
+		delete IncrementalGC;
+		IncrementalGC = NULL;
+	}
+	ClearDirty();
+	unguard;
+}
+
+//
+// Record that an object was written while a minor collection is in
+// progress, so its references are scanned again before it finishes.
+//
+void FObjectManager::NoteWriteSlow( UObject* Obj )
+{
+	guardSlow(FObjectManager::NoteWriteSlow);
+	INT Index = Obj->GetIndex();
+	if( !ObjectDirty(Index) )
+	{
+		ObjectDirty(Index) = 1;
+		DirtyObjects.AddItem( Index );
+	}
+	unguardSlow;
+}
+
+//
+// Forget the objects recorded by the write barrier.
+//
+void FObjectManager::ClearDirty()
+{
+	guard(FObjectManager::ClearDirty);
+	for( INT i=0; i<DirtyObjects.Num(); i++ )
+		ObjectDirty(DirtyObjects(i)) = 0;
+	DirtyObjects.Empty();
 	unguard;
 }
 
@@ -2823,6 +3977,7 @@ UBOOL FObjectManager::IsReferenced( UObject*& Obj, DWORD KeepFlags, UBOOL Ignore
 		Obj = NULL;
 
 	// Tag all garbage.
+	AbortMinorGC();
 	FArchiveTagUsed TagUsedAr;
 	OriginalObj->ClearFlags( RF_TagGarbage );
 	TagUsedAr.Tag( KeepFlags );
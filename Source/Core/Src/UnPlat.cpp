@@ -35,6 +35,9 @@
 #include <fcntl.h>
 #include <utime.h>
 #include <sys/time.h>
+#ifndef PLATFORM_PSVITA
+#include <sys/mman.h>
+#endif
 #ifdef PLATFORM_X86
 #include <cpuid.h>
 #endif
@@ -1033,6 +1036,60 @@ CORE_API UBOOL appCopyFile( const char* Src, const char* Dest )
 	unguard;
 }
 
+//
+// Map an open file read-only into memory.  Returns NULL if the platform
+// doesn't support mapping or the mapping failed, in which case the caller
+// should fall back to reading the file.
+//
+CORE_API const BYTE* appMapFile( FILE* Stream, INT Size )
+{
+	guard(appMapFile);
+	if( Size<=0 )
+		return NULL;
+#if defined(PLATFORM_WIN32)
+	HANDLE hFile = (HANDLE)_get_osfhandle( _fileno(Stream) );
+	HANDLE hMap  = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( !hMap )
+		return NULL;
+	void* Data = MapViewOfFile( hMap, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( hMap );
+	return (const BYTE*)Data;
+#elif defined(PLATFORM_PSVITA)
+	return NULL;
+#else
+	void* Data = mmap( NULL, Size, PROT_READ, MAP_PRIVATE, fileno(Stream), 0 );
+	return Data!=MAP_FAILED ? (const BYTE*)Data : NULL;
+#endif
+	unguard;
+}
+
+//
+// Unmap a file mapped with appMapFile.
+//
+CORE_API void appUnmapFile( const BYTE* Data, INT Size )
+{
+	guard(appUnmapFile);
+#if defined(PLATFORM_WIN32)
+	UnmapViewOfFile( Data );
+#elif !defined(PLATFORM_PSVITA)
+	munmap( (void*)Data, Size );
+#endif
+	unguard;
+}
+
+//
+// Hint that a range of a mapped file is about to be read.
+//
+CORE_API void appPrefetchFile( const BYTE* Data, INT Offset, INT Size )
+{
+#if !defined(PLATFORM_WIN32) && !defined(PLATFORM_PSVITA)
+	// madvise needs a page-aligned start.
+	size_t Page  = sysconf( _SC_PAGESIZE );
+	size_t Start = (size_t)(Data + Offset) & ~(Page-1);
+	madvise( (void*)Start, (size_t)(Data + Offset + Size) - Start, MADV_WILLNEED );
+#endif
+}
+
 /*-----------------------------------------------------------------------------
 	FGlobalPlatform Log routines.
 -----------------------------------------------------------------------------*/
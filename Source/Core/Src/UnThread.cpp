@@ -10,6 +10,7 @@
 #include <windows.h>
 #else
 #include <pthread.h>
+#include <unistd.h>
 #endif
 
 #include "CorePrivate.h"
@@ -74,6 +75,51 @@ CORE_API THREAD_RET appThreadJoin( UTHREAD Thread )
 	unguard;
 }
 
+CORE_API INT appNumCores()
+{
+	guard(appNumCores);
+
+#ifdef PLATFORM_WIN32
+	SYSTEM_INFO Info;
+	GetSystemInfo( &Info );
+	return Max( (INT)Info.dwNumberOfProcessors, 1 );
+#elif defined(_SC_NPROCESSORS_ONLN)
+	return Max( (INT)sysconf( _SC_NPROCESSORS_ONLN ), 1 );
+#else
+	return 1;
+#endif
+
+	unguard;
+}
+
+CORE_API DWORD appInterlockedAnd( volatile DWORD* Dest, DWORD Mask )
+{
+#ifdef PLATFORM_WIN32
+	return (DWORD)InterlockedAnd( (volatile LONG*)Dest, (LONG)Mask );
+#else
+	return __atomic_fetch_and( Dest, Mask, __ATOMIC_ACQ_REL );
+#endif
+}
+
+CORE_API INT appInterlockedAdd( volatile INT* Dest, INT Value )
+{
+#ifdef PLATFORM_WIN32
+	return (INT)InterlockedExchangeAdd( (volatile LONG*)Dest, (LONG)Value );
+#else
+	return __atomic_fetch_add( Dest, Value, __ATOMIC_ACQ_REL );
+#endif
+}
+
+CORE_API INT appInterlockedCompareExchange( volatile INT* Dest, INT Exchange, INT Comparand )
+{
+#ifdef PLATFORM_WIN32
+	return (INT)InterlockedCompareExchange( (volatile LONG*)Dest, (LONG)Exchange, (LONG)Comparand );
+#else
+	__atomic_compare_exchange_n( Dest, &Comparand, Exchange, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+	return Comparand;
+#endif
+}
+
 CORE_API UMUTEX appMutexCreate( const char* Name )
 {
 	guard(appMutexCreate);
@@ -141,3 +187,87 @@ CORE_API void appMutexFree( UMUTEX Mutex )
 
 	unguard;
 }
+
+#ifndef PLATFORM_WIN32
+struct FPosixEvent
+{
+	pthread_mutex_t Mutex;
+	pthread_cond_t Cond;
+	UBOOL Signaled;
+};
+#endif
+
+CORE_API UEVENT appEventCreate( const char* Name )
+{
+	guard(appEventCreate);
+
+#ifdef PLATFORM_WIN32
+	return (UEVENT)CreateEventA( NULL, FALSE, FALSE, NULL );
+#else
+	FPosixEvent* Event = (FPosixEvent*)appMalloc( sizeof(FPosixEvent), Name );
+	check(Event);
+	appMemset( (void*)Event, 0, sizeof(*Event) );
+	if( pthread_mutex_init( &Event->Mutex, NULL ) != 0 )
+	{
+		appFree( (void*)Event );
+		return nullptr;
+	}
+	if( pthread_cond_init( &Event->Cond, NULL ) != 0 )
+	{
+		pthread_mutex_destroy( &Event->Mutex );
+		appFree( (void*)Event );
+		return nullptr;
+	}
+	return (UEVENT)Event;
+#endif
+
+	unguard;
+}
+
+CORE_API void appEventTrigger( UEVENT Event )
+{
+	check(Event);
+
+#ifdef PLATFORM_WIN32
+	SetEvent( (HANDLE)Event );
+#else
+	FPosixEvent* E = (FPosixEvent*)Event;
+	pthread_mutex_lock( &E->Mutex );
+	E->Signaled = 1;
+	pthread_cond_signal( &E->Cond );
+	pthread_mutex_unlock( &E->Mutex );
+#endif
+}
+
+CORE_API void appEventWait( UEVENT Event )
+{
+	check(Event);
+
+#ifdef PLATFORM_WIN32
+	WaitForSingleObject( (HANDLE)Event, INFINITE );
+#else
+	FPosixEvent* E = (FPosixEvent*)Event;
+	pthread_mutex_lock( &E->Mutex );
+	while( !E->Signaled )
+		pthread_cond_wait( &E->Cond, &E->Mutex );
+	E->Signaled = 0;
+	pthread_mutex_unlock( &E->Mutex );
+#endif
+}
+
+CORE_API void appEventFree( UEVENT Event )
+{
+	guard(appEventFree);
+	check(Event);
+
+#ifdef PLATFORM_WIN32
+	CloseHandle( (HANDLE)Event );
+#else
+	FPosixEvent* E = (FPosixEvent*)Event;
+	pthread_cond_destroy( &E->Cond );
+	pthread_mutex_destroy( &E->Mutex );
+	appFree( (void*)E );
+#endif
+
+	unguard;
+}
@@ -2526,6 +2526,7 @@ void FScriptCompiler::PushNest( ENestType NestType, FName ThisName, UStruct* InN
 					Class->ProbeMask		= 0;
 					Class->IgnoreMask		= ~(QWORD)0;
 					Class->VfHash           = NULL;
+					Class->ClearEventCache();
 					Class->LabelTableOffset = MAXWORD;
 				}
 				else if( NestType==NEST_State )
@@ -2535,6 +2536,7 @@ void FScriptCompiler::PushNest( ENestType NestType, FName ThisName, UStruct* InN
 					State->ProbeMask		= 0;
 					State->IgnoreMask		= ~(QWORD)0;
 					State->VfHash           = NULL;
+					State->ClearEventCache();
 					State->LabelTableOffset = MAXWORD;
 				}
 				else if( NestType==NEST_Function )
@@ -3549,6 +3551,7 @@ INT FScriptCompiler::CompileDeclaration( FToken& Token, UBOOL& NeedSemicolon )
 		Class->ProbeMask        = 0;
 		Class->IgnoreMask       = 0;
 		Class->VfHash           = NULL;
+		Class->ClearEventCache();
 		Class->StateFlags       = 0;
 		Class->LabelTableOffset = 0;
 
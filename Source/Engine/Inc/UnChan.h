@@ -30,6 +30,9 @@ enum EChannelState
 // Up to this many reliable channel bunches may be buffered.
 enum {RELIABLE_BUFFER=32};
 
+// Every this many actor updates, one replicated element is resent unconditionally.
+enum {REP_REFRESH_INTERVAL=16};
+
 // Sequence numbers.
 enum EBunchSequences
 {
@@ -41,7 +44,7 @@ enum EBunchSequences
 // Channel flags.
 enum EChannelFlags
 {
-	CHF_Mask           = 0x07ff, // Mask to get channel number.
+	CHF_Mask           = 0x0fff, // Mask to get channel number.
 	CHF_Ack            = 0x1000, // Acknowledging a packet.
 	CHF_Close          = 0x2000, // Requesting to open a connection to the remote.
 	CHF_Reliable       = 0x4000, // This packet is reliable and sequenced.
@@ -87,6 +90,7 @@ public:
 	EChannelState	State;			// State of the channel.
 	EChannelType	ChType;			// Type of this channel.
 	DOUBLE			CloseTime;      // Time initial close-request was sent.
+	INT				OpenIndex;		// Index in connection's OpenChannels.
 
 	// Unsorted record of outgoing unacked data, NULL entries are blanked.
 	FOutBunch*      OutRec[RELIABLE_BUFFER];
@@ -163,6 +167,8 @@ class ENGINE_API FActorChannel : public FChannel
 	BYTE*	Recent;			// Most recently sent values.
 	DOUBLE	RelevantTime;	// Last time this actor was relevant to client.
 	DOUBLE	LastUpdateTime;	// Last time this actor was replicated.
+	INT		RefreshCount;	// Updates since last forced refresh.
+	INT		RefreshCursor;	// Next replicated element to force refresh.
 
 	// Constructor.
 	FActorChannel( UNetConnection* InConnection, INT InChannelIndex, INT InOpenedLocally );
@@ -24,6 +24,16 @@ enum EConnectionState
 	USOCK_Open      = 3, // Connection is open.
 };
 
+//
+// An actor recently found visible to a connection.
+//
+struct FRelevantCacheEntry
+{
+	AActor*	Actor;				// Visible actor, or NULL if this hash slot is free.
+	DOUBLE	ExpireTime;			// Time until which the actor is assumed visible.
+	DOUBLE	FirstRelevantTime;	// Time since which the actor has been continuously visible.
+};
+
 //
 // A network connection.
 //
@@ -35,9 +45,10 @@ class ENGINE_API UNetConnection : public UPlayer
 	// Constants.
 	enum{ MAX_PROTOCOL_VERSION = 1     }; // Maximum protocol version supported.
 	enum{ MIN_PROTOCOL_VERSION = 1     }; // Minimum protocol version supported.
-	enum{ MAX_PACKET_SIZE      = 512   }; // Absolute maximum size of a packet.
-	enum{ IDEAL_PACKET_SIZE    = 192   }; // Ideal size of a packet.
-	enum{ MAX_CHANNELS         = 2047  }; // Maximum channels that can be open.
+	enum{ MAX_PACKET_SIZE      = 1472  }; // Absolute maximum size of a packet, an Ethernet frame's UDP payload.
+	enum{ BASE_PACKET_SIZE     = 512   }; // Packet size every connection supports before negotiation.
+	enum{ MAX_CHANNELS         = 4095  }; // Maximum channels that can be open.
+	enum{ BASE_CHANNELS        = 2047  }; // Channels every connection supports before negotiation.
 
 	// Connection information.
 	UNetDriver*		Driver;				  // Owning driver.
@@ -63,16 +74,35 @@ class ENGINE_API UNetConnection : public UPlayer
 	INT				LastOutIndex;		  // Most recent outgoing index.
 	INT				SentBunchStart;		  // Most recently sent bunch end.
 
+	// Relevancy.
+	TArray<FRelevantCacheEntry> RelevantCache; // Open-addressed hash of recently visible actors.
+	INT				GetRelevantCycles;	  // Cycles spent finding relevant actors this tick.
+	INT				NumRelevant;		  // Number of relevant actors found this tick.
+
+	// Traffic stats.
+	DOUBLE			StatUpdateTime;		  // Time the per-second rates were last updated.
+	INT				InBytes, OutBytes;	  // Bytes since last update.
+	INT				InPackets, OutPackets;// Packets since last update.
+	INT				InBunches, OutBunches;// Bunches since last update.
+	FLOAT			InBytesPerSecond,   OutBytesPerSecond;
+	FLOAT			InPacketsPerSecond, OutPacketsPerSecond;
+	FLOAT			InBunchesPerSecond, OutBunchesPerSecond;
+
 	// Packet.
 	BYTE	OutData[MAX_PACKET_SIZE];     // Outgoing packet.
 	INT		OutNum;						  // Number of bytes in outgoing packet.
 
-	// Channel table.
-	FChannel*  Channels     [ MAX_CHANNELS ];
-	_WORD      OutReliable  [ MAX_CHANNELS ];
-	_WORD      OutSequence  [ MAX_CHANNELS ];
-	_WORD      LastInRetired[ MAX_CHANNELS ];
-	_WORD      LastInRcvd   [ MAX_CHANNELS ];
+	// Channel table, indexed by channel and grown on demand to the highest
+	// channel index used, since sequence state outlives closed channels.
+	INT			MaxChannels;		  // Negotiated limit on channel indices.
+	INT			NumChannelSlots;	  // Entries allocated in the tables below.
+	INT			FirstFreeChannel;	  // No channel below this index is free.
+	FChannel**	Channels;
+	_WORD*		OutReliable;
+	_WORD*		OutSequence;
+	_WORD*		LastInRetired;
+	_WORD*		LastInRcvd;
+	TArray<FChannel*> OpenChannels;	  // All channels in the table, unordered.
 
 	// Constructors and destructors.
 	UNetConnection( UNetDriver* Driver );
@@ -99,7 +129,16 @@ class ENGINE_API UNetConnection : public UPlayer
 	void ReceivedPacket( BYTE* Data, INT Size );
 	void SendAck( _WORD ChIndex, _WORD Sequence );
 	void SendNak( _WORD ChIndex, _WORD Sequence );
+	void NegotiateMaxPacket( INT Requested );
+	void NegotiateMaxChannels( INT Requested );
+	void GrowChannelSlots( INT ChIndex );
+	FChannel* GetChannel( INT ChIndex )
+	{
+		return ChIndex<NumChannelSlots ? Channels[ChIndex] : NULL;
+	}
+	char* DescribeStats( char* String256 );
 	class FActorChannel* GetActorChannel( AActor* Actor );
+	FRelevantCacheEntry* FindRelevantActor( AActor* Actor );
 	void ReceiveFile( INT PackageIndex );
 	void SlowAssertValid()
 	{
@@ -114,39 +153,40 @@ class ENGINE_API UNetConnection : public UPlayer
 -----------------------------------------------------------------------------*/
 
 //
-// Simple channel iterator.
+// Simple channel iterator.  Walks the open channel list backwards, so
+// the current channel may be deleted while iterating.
 //
 class FChannelIterator
 {
 public:
 	// Functions.
 	FChannelIterator( UNetConnection* InConn )
-	:	Conn( InConn), Index( -1 )
+	:	Conn( InConn), Index( InConn->OpenChannels.Num() )
 	{
 		++*this;
 	}
 	void operator++()
 	{
-		debug(Index<UNetConnection::MAX_CHANNELS);
-		while( ++Index<UNetConnection::MAX_CHANNELS && !Conn->Channels[Index] );
+		if( --Index >= Conn->OpenChannels.Num() )
+			Index = Conn->OpenChannels.Num()-1;
 	}
 	operator UBOOL()
 	{
-		return Index<UNetConnection::MAX_CHANNELS;
+		return Index>=0;
 	}
 	INT GetIndex()
 	{
-		return Index;
+		return Conn->OpenChannels(Index)->ChIndex;
 	}
 	FChannel* operator* ()
 	{
-		debug(Index<UNetConnection::MAX_CHANNELS);
-		return Conn->Channels[Index];
+		debug(Index>=0);
+		return Conn->OpenChannels(Index);
 	}
 	FChannel* operator-> ()
 	{
-		debug(Index<UNetConnection::MAX_CHANNELS);
-		return Conn->Channels[Index];
+		debug(Index>=0);
+		return Conn->OpenChannels(Index);
 	}
 private:
 	// Variables.
@@ -162,36 +202,35 @@ template<class T> class FTypedChannelIterator
 public:
 	// Functions.
 	FTypedChannelIterator( UNetConnection* InConn )
-	:	Conn( InConn), Index( -1 )
+	:	Conn( InConn), Index( InConn->OpenChannels.Num() )
 	{
 		++*this;
 	}
 	void operator++()
 	{
-		debug(Index<UNetConnection::MAX_CHANNELS);
+		if( Index > Conn->OpenChannels.Num() )
+			Index = Conn->OpenChannels.Num();
 		while
-		(	++Index<UNetConnection::MAX_CHANNELS
-		&&	(!Conn->Channels[Index] || (INT)Conn->Channels[Index]->ChType!=(INT)T::ChannelType) );
+		(	--Index>=0
+		&&	(INT)Conn->OpenChannels(Index)->ChType!=(INT)T::ChannelType );
 	}
 	operator UBOOL()
 	{
-		return Index<UNetConnection::MAX_CHANNELS;
+		return Index>=0;
 	}
 	INT GetIndex()
 	{
-		return Index;
+		return Conn->OpenChannels(Index)->ChIndex;
 	}
 	T* operator* ()
 	{
-		debug(Index<UNetConnection::MAX_CHANNELS);
-		debug(Conn->Channels[Index])
-		return (T*)Conn->Channels[Index];
+		debug(Index>=0);
+		return (T*)Conn->OpenChannels(Index);
 	}
 	T* operator-> ()
 	{
-		debug(Index<UNetConnection::MAX_CHANNELS);
-		debug(Conn->Channels[Index])
-		return (T*)Conn->Channels[Index];
+		debug(Index>=0);
+		return (T*)Conn->OpenChannels(Index);
 	}
 private:
 	// Variables.
@@ -57,6 +57,41 @@ public:
 
 ENGINE_API FCollisionHashBase* GNewCollisionHash();
 
+/*-----------------------------------------------------------------------------
+	FRelevancyIndex.
+-----------------------------------------------------------------------------*/
+
+//
+// Zone-bucketed list of replicated dynamic actors, rebuilt once per
+// server tick and shared by all connections.  A viewer only considers
+// the buckets of zones it could possibly see into.
+//
+class ENGINE_API FRelevancyIndex
+{
+public:
+	// Bucket holding actors which are relevant regardless of zone.
+	enum {ANY_ZONE=UBspNodes::MAX_ZONES};
+
+	// Variables.
+	TArray<AActor*>	Actors;						// All indexed actors, sorted by bucket.
+	INT				BucketStart[ANY_ZONE+2];	// First actor of each bucket.
+
+	// Constructor.
+	FRelevancyIndex();
+
+	// FRelevancyIndex interface.
+	void Build( ULevel* Level );
+	QWORD GetVisibleZones( ULevel* Level, FVector Location, FVector Ahead );
+	INT Num( INT iBucket )
+	{
+		return BucketStart[iBucket+1] - BucketStart[iBucket];
+	}
+	AActor** GetBucket( INT iBucket )
+	{
+		return &Actors(BucketStart[iBucket]);
+	}
+};
+
 /*-----------------------------------------------------------------------------
 	ULevel base.
 -----------------------------------------------------------------------------*/
@@ -142,6 +177,8 @@ class ENGINE_API ULevel : public ULevelBase
 
 	// Only valid in memory.
 	FCollisionHashBase* Hash;
+	FRelevancyIndex* RelevancyIndex;
+	class FNavGraph* NavGraph;
 	class FMovingBrushTrackerBase* BrushTracker;
 	AActor* FirstDeleted;
 	struct FActorLink* NewlySpawned;
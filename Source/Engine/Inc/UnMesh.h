@@ -204,6 +204,7 @@ class ENGINE_API UMesh : public UPrimitive
 	}
 	void GetFrame( FVector* Verts, INT Size, FCoords Coords, AActor* Owner );
 	void AMD3DGetFrame( FVector* Verts, INT Size, FCoords Coords, AActor* Owner );
+	static void BenchmarkAnim( FOutputDevice* Out, INT Passes );
 	UTexture* GetTexture( INT Count, AActor* Owner )
 	{
 		guardSlow(UMesh::GetTexture);
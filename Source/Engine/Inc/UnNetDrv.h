@@ -6,6 +6,60 @@
 		* Created by Tim Sweeney
 =============================================================================*/
 
+/*-----------------------------------------------------------------------------
+	FReplicationCache.
+-----------------------------------------------------------------------------*/
+
+//
+// Replication work shared by all connections during one server network tick.
+// Connections which see an actor with the same owner, initial and role state
+// reuse its evaluated replication conditions and the encoded bytes of each
+// property element; only the diff against each channel's Recent is per channel.
+//
+class ENGINE_API FReplicationCache
+{
+public:
+	// Constants.
+	enum {HASH_SIZE=1024};
+	enum {VALUE_None=-1, VALUE_Uncacheable=-2};
+
+	// An actor as seen with one replication signature.
+	struct FEntry
+	{
+		AActor*	Actor;			// Actor being replicated.
+		DWORD	Signature;		// Owner, initial and role state it was seen with.
+		INT		iNext;			// Next entry in hash chain.
+		INT		iConditions;	// First condition result in Conditions.
+		INT		iValues;		// First value in Values.
+	};
+
+	// An encoded property element.
+	struct FValue
+	{
+		INT		Offset;			// Offset in Data, or VALUE_None or VALUE_Uncacheable.
+		_WORD	Size;			// Size of encoding in Data.
+		BYTE	UpdateRecent;	// Whether sending it updates the channel's Recent.
+	};
+
+	// Variables.
+	UBOOL			Active;
+	TArray<FEntry>	Entries;
+	TArray<BYTE>	Conditions;
+	TArray<FValue>	Values;
+	TArray<BYTE>	Data;
+	INT				Hash[HASH_SIZE];
+	INT				NumShared;
+	INT				NumEncoded;
+
+	// Constructor.
+	FReplicationCache();
+
+	// FReplicationCache interface.
+	void Begin();
+	void End();
+	FEntry& FindEntry( AActor* Actor, DWORD Signature, INT NumConditions, INT NumRecords );
+};
+
 /*-----------------------------------------------------------------------------
 	UNetDriver.
 -----------------------------------------------------------------------------*/
@@ -23,6 +77,7 @@ class ENGINE_API UNetDriver : public USubsystem
 	FNetworkNotify*			Notify;
 	FPackageMap				Map;
 	DOUBLE					Time;
+	FReplicationCache		RepCache;
 	FLOAT					ConnectionTimeout;
 	FLOAT					InitialConnectTimeout;
 	FLOAT					AckTimeout;
@@ -30,10 +85,12 @@ class ENGINE_API UNetDriver : public USubsystem
 	FLOAT					DumbProxyTimeout;
 	FLOAT					SimulatedProxyTimeout;
 	FLOAT					SpawnPrioritySeconds;
+	FLOAT					RelevantCacheSeconds;
 	FLOAT					ServerTravelPause;
 	INT						DefaultByteLimit;
 	INT						MaxClientByteLimit;
 	INT						MaxTicksPerSecond;
+	INT						MaxPacketSize;
 	UBOOL					DuplicateClientMoves;
 
 	// Constructors.
@@ -47,6 +104,7 @@ class ENGINE_API UNetDriver : public USubsystem
 	// FNetworkDriver interface.
 	virtual UBOOL Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& URL, char* Error256 );
 	virtual void Tick()=0;
+	virtual void TickFlush() {}
 	virtual UBOOL Exec( const char* Cmd, FOutputDevice* Out=GSystem )=0;
 	virtual UBOOL IsInternet()=0;
 };
@@ -377,6 +377,7 @@ void AActor::SetOwner( AActor *NewOwner )
 		Owner->eventLostChild( this );
 
 	Owner = NewOwner;
+	GObj.NoteWrite( this );
 
 	if( Owner != NULL )
 		Owner->eventGainedChild( this );
@@ -408,6 +409,7 @@ void AActor::SetBase( AActor* NewBase, int bNotifyActor )
 
 		// Set base.
 		Base = NewBase;
+		GObj.NoteWrite( this );
 
 		// Notify new base, unless it's the level.
 		if( Base && Base!=Level )
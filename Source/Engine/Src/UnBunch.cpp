@@ -141,8 +141,7 @@ FArchive& FInBunch::operator<<( UObject*& Object )
 			// Map to an actor channel index.
 			Index = -Index-2;
 			if
-			(	Index<UNetConnection::MAX_CHANNELS
-			&&	Connection->Channels[Index]
+			(	Connection->GetChannel(Index)
 			&&	Connection->Channels[Index]->ChType==CHTYPE_Actor 
 			&&	Connection->Channels[Index]->State==UCHAN_Open )
 			{
@@ -313,7 +312,7 @@ FOutBunch::FOutBunch( FChannel* InChannel, UBOOL bClose )
 	Header.ChIndex      = Channel->ChIndex;
 	Header._ChType      = Channel->ChType;
 	Header.DataSize     = 0;
-	MaxDataSize         = sizeof(Data);
+	MaxDataSize         = Min<INT>( sizeof(Data), Channel->Connection->MaxPacket - sizeof(FBunch) );
 
 	// Reserve channel and set bunch info.
 	if( Channel->ReserveOutgoingIndex(bClose)==INDEX_NONE )
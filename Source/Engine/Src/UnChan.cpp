@@ -70,8 +70,14 @@ FChannel::~FChannel()
 		if( InRec [i] ) FreePooledBunch( InRec [i] );
 	}
 
-	// Remove from connection's channel table.
+	// Remove from connection's channel table and open channel list.
+	TArray<FChannel*>& Open = Connection->OpenChannels;
+	check(Open(OpenIndex)==this);
+	Open(OpenIndex) = Open(Open.Num()-1);
+	Open(OpenIndex)->OpenIndex = OpenIndex;
+	Open.Remove( Open.Num()-1 );
 	Connection->Channels[ChIndex] = NULL;
+	Connection->FirstFreeChannel  = Min( Connection->FirstFreeChannel, ChIndex );
 	Connection                    = NULL;
 
 	unguard;
@@ -361,6 +367,7 @@ void FChannel::SendRawBunch( FOutBunch& Bunch )
 	// Copy data.
 	appMemcpy( Connection->OutData+Connection->OutNum, Bunch.Data, Bunch.Header.DataSize);
 	Connection->OutNum += Bunch.Header.DataSize;
+	Connection->OutBunches++;
 
 	// If absolutely filled now, flush so that MaxSend() never returns zero.
 	check(Connection->OutNum<=Connection->MaxPacket);
@@ -394,7 +401,7 @@ UBOOL FChannel::SendBunch( FOutBunch& Bunch, UBOOL Merge )
 	(	Merge
 	&&	Connection->LastBunchEnd
 	&&	Connection->LastBunchEnd==Connection->OutNum 
-	&&	Connection->OutNum+Bunch.Header.DataSize<=UNetConnection::MAX_PACKET_SIZE )
+	&&	Connection->OutNum+Bunch.Header.DataSize<=Connection->MaxPacket )
 	{
 		FBunch* OldHeader = (FBunch*)(Connection->OutData+Connection->LastBunchStart);
 		if( (OldHeader->ChIndex&CHF_Mask)==(ChIndex&CHF_Mask) )
@@ -499,7 +506,7 @@ UBOOL FChannel::IsNetReady( UBOOL Saturate )
 		Connection->QueuedBytes = 0;
 
 	// If connection is saturated and we don't want saturation, we're not ready.
-	if( !Connection->IsNetReady() )
+	if( !Saturate && !Connection->IsNetReady() )
 		return 0;
 
 	// Ready if there's space available.
@@ -595,6 +602,78 @@ char* FControlChannel::Describe( char* String256 )
 
 IMPLEMENT_CHTYPE(FControlChannel);
 
+/*-----------------------------------------------------------------------------
+	FReplicationCache.
+-----------------------------------------------------------------------------*/
+
+//
+// Constructor.
+//
+FReplicationCache::FReplicationCache()
+:	Active		( 0 )
+,	NumShared	( 0 )
+,	NumEncoded	( 0 )
+{}
+
+//
+// Start a network tick's replication pass.  Nothing cached in a previous
+// pass is valid, since actors may have changed in between.
+//
+void FReplicationCache::Begin()
+{
+	guard(FReplicationCache::Begin);
+	Entries.Empty();
+	Conditions.Empty();
+	Values.Empty();
+	Data.Empty();
+	for( INT i=0; i<HASH_SIZE; i++ )
+		Hash[i] = INDEX_NONE;
+	NumShared  = 0;
+	NumEncoded = 0;
+	Active     = 1;
+	unguard;
+}
+
+//
+// End the replication pass.  Replication outside of a pass, such as
+// for RPCs, isn't cached.
+//
+void FReplicationCache::End()
+{
+	guard(FReplicationCache::End);
+	Active = 0;
+	unguard;
+}
+
+//
+// Find or add the entry of an actor seen with a signature.  New entries
+// start with no conditions evaluated and no values encoded.
+//
+FReplicationCache::FEntry& FReplicationCache::FindEntry( AActor* Actor, DWORD Signature, INT NumConditions, INT NumRecords )
+{
+	guard(FReplicationCache::FindEntry);
+	check(Active);
+	INT iHash = (((DWORD)Actor>>4) ^ Signature) & (HASH_SIZE-1);
+	for( INT i=Hash[iHash]; i!=INDEX_NONE; i=Entries(i).iNext )
+		if( Entries(i).Actor==Actor && Entries(i).Signature==Signature )
+			return Entries(i);
+
+	// Add a new entry.
+	FEntry& Entry     = Entries( Entries.Add() );
+	Entry.Actor       = Actor;
+	Entry.Signature   = Signature;
+	Entry.iNext       = Hash[iHash];
+	Entry.iConditions = Conditions.Add( NumConditions );
+	Entry.iValues     = Values.Add( NumRecords );
+	Hash[iHash]       = Entries.Num()-1;
+	if( NumConditions )
+		appMemset( &Conditions(Entry.iConditions), 255, NumConditions );
+	for( INT i=0; i<NumRecords; i++ )
+		Values(Entry.iValues+i).Offset = VALUE_None;
+	return Entry;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	FActorChannel.
 -----------------------------------------------------------------------------*/
@@ -609,6 +688,8 @@ FActorChannel::FActorChannel( UNetConnection* InConnection, INT InChannelIndex,
 ,	Recent			( NULL )
 ,	RelevantTime	( Connection->Driver->Time )
 ,	LastUpdateTime	( Connection->Driver->Time - Connection->Driver->SpawnPrioritySeconds )
+,	RefreshCount	( 0 )
+,	RefreshCursor	( 0 )
 {
 	guard(FActorChannel::FActorChannel);
 	unguard;
@@ -784,6 +865,7 @@ void FActorChannel::ReceivedBunch( FInBunch& Bunch )
 			// Get next.
 			Bunch << PropertyName;
 		}
+		GObj.NoteWrite( Actor );
 		unguard;
 
 		// Handle changed properties.
@@ -1022,55 +1104,133 @@ void FActorChannel::ReplicateActor( UBOOL FullReplication )
 		Actor->RemoteRole=ROLE_SimulatedProxy;
 	Actor->bSimulatedPawn = Actor->IsA(APawn::StaticClass) && (Actor->RemoteRole == ROLE_SimulatedProxy);
 
+	// Get the flattened replication layout.
+	UClass* ActorClass = Actor->GetClass();
+	if( !ActorClass->RepLayoutValid )
+		ActorClass->BuildRepLayout();
+	FRepRecord* Records    = ActorClass->RepRecords.Num() ? &ActorClass->RepRecords(0) : NULL;
+	INT         NumRecords = ActorClass->RepRecords.Num();
+
+	// Conditions are evaluated lazily, at most once each per update.  During
+	// the server's replication pass, conditions and encoded values are shared
+	// with other connections which see this actor the same way.
+	FMemMark Mark(GMem);
+	FReplicationCache&         Cache  = Connection->Driver->RepCache;
+	FReplicationCache::FValue* Values = NULL;
+	INT   NumConditions = ActorClass->RepConditions.Num();
+	BYTE* Conditions;
+	if( Cache.Active )
+	{
+		DWORD Signature = Actor->bNetOwner + (Actor->bNetInitial<<1) + (Actor->RemoteRole<<2);
+		FReplicationCache::FEntry& Entry = Cache.FindEntry( Actor, Signature, NumConditions, NumRecords );
+		Conditions = NumConditions ? &Cache.Conditions(Entry.iConditions) : NULL;
+		Values     = NumRecords    ? &Cache.Values(Entry.iValues)         : NULL;
+	}
+	else
+	{
+		Conditions = new(GMem,::Max(NumConditions,1))BYTE;
+		appMemset( Conditions, 255, NumConditions );
+	}
+
+	// Periodically resend one element unconditionally, walking the layout
+	// round-robin, to recover from any divergence between Recent and the client.
+	INT iRefresh = INDEX_NONE;
+	if( NumRecords && ++RefreshCount>=REP_REFRESH_INTERVAL )
+	{
+		RefreshCount  = 0;
+		RefreshCursor = RefreshCursor<NumRecords ? RefreshCursor : 0;
+		iRefresh      = RefreshCursor++;
+	}
+
 	// Replicate all applicable properties.
-	for( UClass* RepClass=Actor->GetClass(); RepClass; RepClass=RepClass->GetSuperClass() )
+	for( INT i=0; i<NumRecords; i++ )
 	{
-		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+		FRepRecord& Record = Records[i];
+		BYTE&       Result = Conditions[Record.iCondition];
+		if( Result==0 )
+			continue;
+
+		// See whether the element differs from the most recently sent value.
+		UProperty* It    = Record.Property;
+		UBOOL      Dirty;
+		if( Record.BitMask )
+			Dirty = ((*(DWORD*)((BYTE*)Actor+Record.Offset) ^ *(DWORD*)(Recent+Record.Offset)) & Record.BitMask)!=0;
+		else if( !Record.Plain )
+			Dirty = !It->Matches( Actor, Recent, Record.Index );
+		else if( Record.Size==sizeof(DWORD) )
+			Dirty = *(DWORD*)((BYTE*)Actor+Record.Offset) != *(DWORD*)(Recent+Record.Offset);
+		else if( Record.Size==sizeof(BYTE) )
+			Dirty = *((BYTE*)Actor+Record.Offset) != Recent[Record.Offset];
+		else
+			Dirty = appMemcmp( (BYTE*)Actor+Record.Offset, Recent+Record.Offset, Record.Size )!=0;
+		UBOOL Refresh = 0;
+		if( !Dirty && !(It->PropertyFlags & CPF_NetAlways) && !(Refresh=(i==iRefresh)) )
+			continue;
+
+		// Evaluate replication condition.
+		if( Result==255 )
+		{
+			UProperty* CondProperty = ActorClass->RepConditions(Record.iCondition);
+			FFrame EvalStack( Actor, CondProperty->GetOwnerClass(), CondProperty->RepOffset, NULL );
+			BYTE Buffer[MAX_CONST_SIZE], *Val=Buffer;
+			EvalStack.Step( Actor, Val );
+			Result = *(DWORD*)Val!=0;
+			if( !Result )
+				continue;
+		}
+		if( (It->PropertyFlags & CPF_NetReliable) && !Refresh )
+		{
+			Bunch.Header.ChIndex |= CHF_Reliable;
+		}
+		FReplicationCache::FValue* Value = Values ? &Values[i] : NULL;
+		if( Value && Value->Offset>=0 )
 		{
-			FRepLink*  Condition = Link->Condition;
-			UProperty* It        = Link->Property;
-			INT        Index     = 0;
-			if
-			(	Condition->LastObject != Actor
-			||	Condition->LastStamp  != Actor->OtherTag
-			||	Condition->LastResult )
+			// Reuse the encoding made for another connection.
+			if( Bunch.Header.DataSize+Value->Size > Bunch.MaxDataSize )
+				goto FilledUp;
+			Bunch.Serialize( &Cache.Data(Value->Offset), Value->Size );
+			if( Value->UpdateRecent )
 			{
-				for( Index=0; Index<It->ArrayDim; Index++ )
+				if( Record.BitMask )
+					*(DWORD*)(Recent+Record.Offset) ^= Record.BitMask;
+				else
+					appMemcpy( Recent+Record.Offset, (BYTE*)Actor+Record.Offset, Record.Size );
+			}
+			Cache.NumShared++;
+		}
+		else
+		{
+			// Encode it, and remember the encoding unless it refers to an
+			// actor by this connection's channel index.
+			INT Start = Bunch.Header.DataSize;
+			if( Bunch.SendProperty( It, Record.Index, (BYTE*)Actor, Recent, 1 ) )
+				goto FilledUp;
+			if( Value && Value->Offset==FReplicationCache::VALUE_None )
+			{
+				UBOOL UpdateRecent = 1;
+				if( It->IsA(UObjectProperty::StaticClass) )
 				{
-					UBOOL RandomForce=0;
-					if
-					(	!It->Matches(Actor,Recent,Index)
-					||	(It->PropertyFlags & CPF_NetAlways)
-					||	(RandomForce=(appFrand()<1.0/1000.0))!=0 )
-					{
-						if
-						(	Condition->LastObject!=Actor
-						||	Condition->LastStamp!=Actor->OtherTag )
-						{
-							// Evaluate replication condition.
-							FFrame EvalStack( Actor, It->GetOwnerClass(), It->RepOffset, NULL );
-							BYTE Buffer[MAX_CONST_SIZE], *Val=Buffer;
-							EvalStack.Step( Actor, Val );
-							Condition->LastObject = Actor;
-							Condition->LastStamp  = Actor->OtherTag;
-							Condition->LastResult = *(DWORD*)Val!=0;
-						}
-						if( Condition->LastResult )
-						{
-							if( (It->PropertyFlags & CPF_NetReliable) && !RandomForce )
-							{
-								Bunch.Header.ChIndex |= CHF_Reliable;
-							}
-							if( Bunch.SendProperty( It, Index, (BYTE*)Actor, Recent, 1 ) )
-								goto FilledUp;
-							Actor->XLevel->NumReps++;
-						}
-					}
+					UObject* Object   = *(UObject**)((BYTE*)Actor+Record.Offset);
+					AActor*  Other    = Cast<AActor>( Object );
+					if( Other && !Other->bStatic && !Other->bNoDelete )
+						Value->Offset = FReplicationCache::VALUE_Uncacheable;
+					else
+						UpdateRecent  = !Object || Connection->Driver->Map.ObjectToIndex(Object)!=INDEX_NONE;
+				}
+				if( Value->Offset==FReplicationCache::VALUE_None )
+				{
+					Value->Size         = Bunch.Header.DataSize - Start;
+					Value->UpdateRecent = UpdateRecent;
+					Value->Offset       = Cache.Data.Add( Value->Size );
+					appMemcpy( &Cache.Data(Value->Offset), &Bunch.Data[Start], Value->Size );
+					Cache.NumEncoded++;
 				}
 			}
 		}
+		Actor->XLevel->NumReps++;
 	}
 	FilledUp:
+	Mark.Pop();
 	check(!Bunch.Overflowed);
 
 	// If not overflowed, send and mark as updated.
@@ -31,9 +31,11 @@ UNetDriver::UNetDriver()
 ,	DumbProxyTimeout		( 1.0   )
 ,	SimulatedProxyTimeout	( 10.0  )
 ,	SpawnPrioritySeconds    ( 1.0   )
+,	RelevantCacheSeconds	( 0.25  )
 ,	ServerTravelPause		( 5.0   )
 ,	DuplicateClientMoves	( 1 )
 ,	MaxTicksPerSecond		( 30 )
+,	MaxPacketSize			( UNetConnection::BASE_PACKET_SIZE )
 {}
 
 void UNetDriver::InternalClassInitializer( UClass* Class )
@@ -48,10 +50,12 @@ void UNetDriver::InternalClassInitializer( UClass* Class )
 		new(Class,"DumbProxyTimeout",     RF_Public)UFloatProperty(CPP_PROPERTY(DumbProxyTimeout     ), "Client", CPF_Config );
 		new(Class,"SimulatedProxyTimeout",RF_Public)UFloatProperty(CPP_PROPERTY(SimulatedProxyTimeout), "Client", CPF_Config );
 		new(Class,"SpawnPrioritySeconds", RF_Public)UFloatProperty(CPP_PROPERTY(SpawnPrioritySeconds ), "Client", CPF_Config );
+		new(Class,"RelevantCacheSeconds", RF_Public)UFloatProperty(CPP_PROPERTY(RelevantCacheSeconds ), "Client", CPF_Config );
 		new(Class,"ServerTravelPause",    RF_Public)UFloatProperty(CPP_PROPERTY(ServerTravelPause    ), "Client", CPF_Config );
 		new(Class,"DefaultByteLimit",     RF_Public)UIntProperty  (CPP_PROPERTY(DefaultByteLimit     ), "Client", CPF_Config );
 		new(Class,"MaxClientByteLimit",   RF_Public)UIntProperty  (CPP_PROPERTY(MaxClientByteLimit   ), "Client", CPF_Config );
 		new(Class,"MaxTicksPerSecond",    RF_Public)UIntProperty  (CPP_PROPERTY(MaxTicksPerSecond    ), "Client", CPF_Config );
+		new(Class,"MaxPacketSize",        RF_Public)UIntProperty  (CPP_PROPERTY(MaxPacketSize        ), "Client", CPF_Config );
 		new(Class,"DuplicateClientMoves", RF_Public)UBoolProperty (CPP_PROPERTY(DuplicateClientMoves ), "Client", CPF_Config );
 	}
 	unguard;
@@ -106,7 +110,7 @@ UPendingLevel::UPendingLevel( UEngine* InEngine, const FURL& InURL )
 	if( NetDriver->Init( 1, this, URL, Error256) )
 	{
 		// Send initial message.
-		NetDriver->ServerConnection->Logf( "HELLO REVISION=1", NET_REVISION );
+		NetDriver->ServerConnection->Logf( "HELLO REVISION=%i MAXPACKET=%i MAXCHANNELS=%i", NET_REVISION, NetDriver->MaxPacketSize, UNetConnection::MAX_CHANNELS );
 		NetDriver->ServerConnection->FlushNet();
 	}
 	else
@@ -177,6 +181,13 @@ void UPendingLevel::NotifyReceivedText( UNetConnection* Connection, const char*
 	{
 		// Challenged by server.
 		Parse( Text,"CHALLENGE=", Connection->Challenge );
+
+		// Use the packet size the server agreed to, if any.
+		INT MaxPacket, MaxChannels;
+		if( Parse( Text, "MAXPACKET=", MaxPacket ) )
+			Connection->NegotiateMaxPacket( MaxPacket );
+		if( Parse( Text, "MAXCHANNELS=", MaxChannels ) )
+			Connection->NegotiateMaxChannels( MaxChannels );
 		FString Str;
 		URL.String( Str );
 		NetDriver->ServerConnection->Logf( "LOGIN RESPONSE=%i URL=%s", Engine->ChallengeResponse(Connection->Challenge), *Str );
@@ -332,6 +343,16 @@ void UNetConnection::Destroy()
 	for( FChannelIterator It(this); It; ++It )
 		delete *It;
 
+	// Free the channel table.
+	appFree( Channels      );
+	appFree( OutReliable   );
+	appFree( OutSequence   );
+	appFree( LastInRetired );
+	appFree( LastInRcvd    );
+	Channels = NULL;
+	OutReliable = OutSequence = LastInRetired = LastInRcvd = NULL;
+	NumChannelSlots = 0;
+
 	Super::Destroy();
 	unguard;
 }
@@ -356,13 +377,50 @@ UNetConnection::UNetConnection( UNetDriver* InDriver )
 ,	LastSendTime		( Driver->Time )
 ,	LastTickTime		( Driver->Time )
 ,	QueuedBytes			( 0 )
+,	GetRelevantCycles	( 0 )
+,	NumRelevant			( 0 )
+,	StatUpdateTime		( Driver->Time )
 ,	OutNum				( 0 )
+,	MaxChannels			( BASE_CHANNELS )
+,	NumChannelSlots		( 0 )
+,	FirstFreeChannel	( 0 )
+,	Channels			( NULL )
+,	OutReliable			( NULL )
+,	OutSequence			( NULL )
+,	LastInRetired		( NULL )
+,	LastInRcvd			( NULL )
 ,	URL					()
 {
 	guard(UNetConnection::UNetConnection);
 
-	// Init the list of channels.
-	for( INT i=0; i<MAX_CHANNELS; i++ )
+	// Init the channel table; it grows as channels are opened.
+	GrowChannelSlots( 0 );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Channel table.
+-----------------------------------------------------------------------------*/
+
+//
+// Grow the channel table so it includes a channel index.
+//
+void UNetConnection::GrowChannelSlots( INT ChIndex )
+{
+	guard(UNetConnection::GrowChannelSlots);
+	check(ChIndex<MAX_CHANNELS);
+	if( ChIndex < NumChannelSlots )
+		return;
+
+	// Grow geometrically.
+	INT OldNum = NumChannelSlots;
+	NumChannelSlots = Clamp( ::Max( 2*OldNum, ChIndex+1 ), 64, (INT)MAX_CHANNELS );
+	Channels        = (FChannel**)appRealloc( Channels,      NumChannelSlots*sizeof(FChannel*), "Channels"      );
+	OutReliable     = (_WORD*    )appRealloc( OutReliable,   NumChannelSlots*sizeof(_WORD),     "OutReliable"   );
+	OutSequence     = (_WORD*    )appRealloc( OutSequence,   NumChannelSlots*sizeof(_WORD),     "OutSequence"   );
+	LastInRetired   = (_WORD*    )appRealloc( LastInRetired, NumChannelSlots*sizeof(_WORD),     "LastInRetired" );
+	LastInRcvd      = (_WORD*    )appRealloc( LastInRcvd,    NumChannelSlots*sizeof(_WORD),     "LastInRcvd"    );
+	for( INT i=OldNum; i<NumChannelSlots; i++ )
 	{
 		Channels     [i] = NULL;
 		OutReliable  [i] = SEQ_None;
@@ -373,6 +431,17 @@ UNetConnection::UNetConnection( UNetDriver* InDriver )
 	unguard;
 }
 
+//
+// Raise the channel limit to what the other side asked for.  Channel
+// indices past BASE_CHANNELS use a header bit older peers don't know.
+//
+void UNetConnection::NegotiateMaxChannels( INT Requested )
+{
+	guard(UNetConnection::NegotiateMaxChannels);
+	MaxChannels = Clamp( Requested, MaxChannels, (INT)MAX_CHANNELS );
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	Validation.
 -----------------------------------------------------------------------------*/
@@ -400,6 +469,29 @@ void UNetConnection::FlushNet( UBOOL Duplicate )
 {
 	guard(UNetConnection::FlushNet);
 	LastBunchEnd = 0;
+	if( OutNum )
+	{
+		OutBytes += OutNum;
+		OutPackets++;
+	}
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Packet size negotiation.
+-----------------------------------------------------------------------------*/
+
+//
+// Grow the maximum packet size to what the other side asked for, within
+// our driver's configured limit.  Packets never shrink below the size
+// every connection starts with, so no bunch already queued can overflow.
+//
+void UNetConnection::NegotiateMaxPacket( INT Requested )
+{
+	guard(UNetConnection::NegotiateMaxPacket);
+	INT Limit = Clamp( Driver->MaxPacketSize, (INT)BASE_PACKET_SIZE, (INT)MAX_PACKET_SIZE );
+	MaxPacket = Clamp( Requested, MaxPacket, ::Max(MaxPacket,Limit) );
+	debugf( NAME_DevNet, "Negotiated packet size %i (requested %i)", MaxPacket, Requested );
 	unguard;
 }
 
@@ -427,7 +519,29 @@ void UNetConnection::WriteBinary( const void* Data, int Length, EName MsgType )
 UBOOL UNetConnection::IsNetReady()
 {
 	guard(UNetConnection::IsReady);
-	return QueuedBytes <= 0;
+	return QueuedBytes + OutNum <= 0;
+	unguard;
+}
+
+//
+// Describe the connection's traffic rates.
+//
+char* UNetConnection::DescribeStats( char* String256 )
+{
+	guard(UNetConnection::DescribeStats);
+	appSprintf
+	(
+		String256,
+		"packet=%i in=%i/%i/%i out=%i/%i/%i (bytes/packets/bunches per sec)",
+		MaxPacket,
+		(INT)InBytesPerSecond,
+		(INT)InPacketsPerSecond,
+		(INT)InBunchesPerSecond,
+		(INT)OutBytesPerSecond,
+		(INT)OutPacketsPerSecond,
+		(INT)OutBunchesPerSecond
+	);
+	return String256;
 	unguard;
 }
 
@@ -443,6 +557,10 @@ void UNetConnection::ReceivedPacket( BYTE* Data, INT Size )
 	guard(UNetConnection::ReceivedPacket);
 	AssertValid();
 
+	// Update stats.
+	InBytes += Size;
+	InPackets++;
+
 	// Disassemble and dispatch all bunches in the packet.
 	while( Size > 0 )
 	{
@@ -467,7 +585,7 @@ void UNetConnection::ReceivedPacket( BYTE* Data, INT Size )
 
 			// Forward the ack to the channel.
 			debugfSlow( NAME_DevNetTraffic, "   Received ack %i: %i!", ChannelIndex, BunchHeader->Sequence );
-			if( Channels[ChannelIndex] )
+			if( GetChannel(ChannelIndex) )
 			{
 				if( Bunch->ChIndex & CHF_AckNak )
 					Channels[ChannelIndex]->ReceivedNak( BunchHeader->Sequence );
@@ -494,6 +612,12 @@ void UNetConnection::ReceivedPacket( BYTE* Data, INT Size )
 			Data += Bunch->GetTotalSize();
 			Size -= Bunch->GetTotalSize();
 			INT ChIndex = Bunch->ChIndex & CHF_Mask;
+			if( ChIndex >= MaxChannels )
+			{
+				debugfSlow( NAME_DevNetTraffic, "Bunch on channel %i beyond limit %i", ChIndex, MaxChannels );
+				continue;
+			}
+			GrowChannelSlots( ChIndex );
 			if( Channels[ChIndex] )
 			{
 				// Verify channel type.
@@ -546,6 +670,7 @@ void UNetConnection::ReceivedPacket( BYTE* Data, INT Size )
 			}
 
 			// Dispatch the raw, unsequenced bunch to the channel.
+			InBunches++;
 			FInBunch LocalBunch( this, Bunch, BunchData );
 			Channels[ChIndex]->ReceivedRawBunch( LocalBunch, 1 );
 		}
@@ -615,22 +740,26 @@ FChannel* UNetConnection::CreateChannel( EChannelType ChType, UBOOL bOpenedLocal
 	// If no channel index was specified, find the first available.
 	if( ChIndex == MAXWORD )
 	{
-		for( ChIndex=0; ChIndex<MAX_CHANNELS; ChIndex++ )
+		for( ChIndex=FirstFreeChannel; ChIndex<NumChannelSlots; ChIndex++ )
 			if( !Channels[ChIndex] )
 				break;
-		if( ChIndex == MAX_CHANNELS )
+		FirstFreeChannel = ChIndex+1;
+		if( ChIndex >= MaxChannels )
 			return NULL;
 	}
 
 	// Make sure channel is valid.
-	check(ChIndex<MAX_CHANNELS);
+	check(ChIndex<MaxChannels);
+	GrowChannelSlots( ChIndex );
 	check(Channels[ChIndex]==NULL);
 
 	// Create channel.
-	Channels[ChIndex] = GChannelConstructors[ChType]( this, ChIndex, bOpenedLocally );
+	FChannel* Channel = GChannelConstructors[ChType]( this, ChIndex, bOpenedLocally );
+	Channels[ChIndex]  = Channel;
+	Channel->OpenIndex = OpenChannels.AddItem( Channel );
 	//debugf( "Created channel %i of type %i", ChIndex, ChType);
 
-	return Channels[ChIndex];
+	return Channel;
 	unguard;
 }
 
@@ -647,6 +776,20 @@ void UNetConnection::Tick()
 	guard(UNetConnection::Tick);
 	AssertValid();
 
+	// Update per-second traffic stats.
+	FLOAT StatSeconds = Driver->Time - StatUpdateTime;
+	if( StatSeconds >= 1.0 )
+	{
+		InBytesPerSecond    = InBytes    / StatSeconds;
+		OutBytesPerSecond   = OutBytes   / StatSeconds;
+		InPacketsPerSecond  = InPackets  / StatSeconds;
+		OutPacketsPerSecond = OutPackets / StatSeconds;
+		InBunchesPerSecond  = InBunches  / StatSeconds;
+		OutBunchesPerSecond = OutBunches / StatSeconds;
+		InBytes = OutBytes = InPackets = OutPackets = InBunches = OutBunches = 0;
+		StatUpdateTime = Driver->Time;
+	}
+
 	// Update queued byte count.
 	FLOAT AllowedLatency = -ByteLimit/20.0;
 	QueuedBytes -= (Driver->Time - LastTickTime) * ByteLimit;
@@ -699,6 +842,23 @@ FActorChannel* UNetConnection::GetActorChannel( AActor* Actor )
 	unguardSlow;
 }
 
+//
+// Return the relevant cache entry of an actor which was visible to this
+// connection on the most recent relevancy pass, or NULL if it wasn't.
+//
+FRelevantCacheEntry* UNetConnection::FindRelevantActor( AActor* Actor )
+{
+	guardSlow(UNetConnection::FindRelevantActor);
+	if( !RelevantCache.Num() )
+		return NULL;
+	INT Mask = RelevantCache.Num()-1;
+	for( INT i=((DWORD)Actor>>4)&Mask; RelevantCache(i).Actor; i=(i+1)&Mask )
+		if( RelevantCache(i).Actor==Actor )
+			return &RelevantCache(i);
+	return NULL;
+	unguardSlow;
+}
+
 /*---------------------------------------------------------------------------------------
 	File transfer.
 ---------------------------------------------------------------------------------------*/
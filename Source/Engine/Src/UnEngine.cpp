@@ -66,11 +66,22 @@ void UEngine::Init()
 
 	// Subsystems.
 	FURL::Init();
-	GCache.Init( 1024 * 1024 * Clamp(CacheSizeMegs,1,1024), 4096 );
+	UBOOL ConcurrentCache = 0;
+	GetConfigBool( "Engine.Engine", "ConcurrentCache", ConcurrentCache );
+	GCache.Init( 1024 * 1024 * Clamp(CacheSizeMegs,1,1024), 4096, NULL, 0, ConcurrentCache );
 
 	// Objects.
 	Cylinder = new UPrimitive;
 
+	// Loaded resources don't change during play, so the garbage collector
+	// can tenure them.
+	GObj.AddTenureClass( UTexture::StaticClass );
+	GObj.AddTenureClass( UPalette::StaticClass );
+	GObj.AddTenureClass( USound::StaticClass );
+	GObj.AddTenureClass( UMusic::StaticClass );
+	GObj.AddTenureClass( UMesh::StaticClass );
+	GObj.AddTenureClass( UModel::StaticClass );
+
 	// Add to root.
 	GObj.AddToRoot( this );
 
@@ -202,6 +213,13 @@ UBOOL UEngine::Exec( const char* Cmd, FOutputDevice* Out )
 		Out->Log( "Flushed engine caches" );
 		return 1;
 	}
+	else if( ParseCommand(&Str,"MESHBENCH") )
+	{
+		INT Passes=16;
+		Parse( Str, "PASSES=", Passes );
+		UMesh::BenchmarkAnim( Out, Max(Passes,1) );
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
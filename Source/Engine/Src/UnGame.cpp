@@ -468,6 +468,11 @@ ULevel* UGameEngine::LoadMap( const FURL& URL, UPendingLevel* Pending, char* Err
 	}
 	unguard;
 
+	// Finish loading any packages read ahead of time, such as this map.
+	guard(FlushAsyncLoading);
+	GObj.FlushAsyncLoading();
+	unguard;
+
 	// Verify that we can load all packages we need.
 	FGuid* Guid = NULL;
 	UObject* MapParent = NULL;
@@ -1089,6 +1094,13 @@ void UGameEngine::Tick( FLOAT DeltaSeconds )
 			GLevel->TravelItems = TravelItems;
 			return;
 		}
+		else
+		{
+			// Read the next map in the background while counting down.
+			FURL NextURL( &LastURL, GLevel->GetLevelInfo()->NextURL, TRAVEL_Relative );
+			if( NextURL.Valid && NextURL.IsLocalInternal() )
+				GObj.RequestPackage( PATH(*NextURL.Map) );
+		}
 	}
 	unguard;
 
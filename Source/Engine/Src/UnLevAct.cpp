@@ -73,6 +73,7 @@ AActor* ULevel::SpawnActor
 	INT iActor = Add();
 	ModifyItem( iActor );
     AActor* Actor = Actors(iActor) = (AActor*)GObj.ConstructObject( Class, GetParent(), InName, 0, Template );
+	GObj.NoteWrite( this );
 	Actor->SetFlags( RF_Transactional );
 
 	// Set base actor properties.
@@ -14,7 +14,7 @@
 -----------------------------------------------------------------------------*/
 
 //
-// Priority sortable list for appSort.
+// Replication priority of a relevant actor.
 //
 struct FActorPriority
 {
@@ -34,8 +34,11 @@ struct FActorPriority
 		}
 		else
 		{
-			// Priority of spawning a new actor = high.
-			Priority = Actor->NetPriority * InConnection->Driver->SpawnPrioritySeconds;
+			// Priority of spawning a new actor = high, and keeps rising for
+			// as long as the actor has been waiting for a channel.
+			FRelevantCacheEntry* Entry = InConnection->FindRelevantActor( Actor );
+			FLOAT Waiting = Entry ? InConnection->Driver->Time - Entry->FirstRelevantTime : 0.0;
+			Priority = Actor->NetPriority * (InConnection->Driver->SpawnPrioritySeconds + Waiting);
 		}
 		if( InActor->bNetOptional )
 		{
@@ -43,11 +46,46 @@ struct FActorPriority
 			Priority -= 100000.0;
 		}
 	}
-	friend inline INT Compare( const FActorPriority& A, const FActorPriority& B )
+};
+
+//
+// Binary max-heap of actor priorities.  Building it is linear, and only as
+// many actors as the connection's bandwidth allows are ever popped, so we
+// never pay for fully sorting the relevant set.
+//
+static void SiftDownPriority( FActorPriority* Heap, INT Num, INT i )
+{
+	guardSlow(SiftDownPriority);
+	FActorPriority Item = Heap[i];
+	for( INT Child=i*2+1; Child<Num; Child=i*2+1 )
 	{
-		return B.Priority - A.Priority;
+		if( Child+1<Num && Heap[Child+1].Priority>Heap[Child].Priority )
+			Child++;
+		if( Heap[Child].Priority<=Item.Priority )
+			break;
+		Heap[i] = Heap[Child];
+		i       = Child;
 	}
-};
+	Heap[i] = Item;
+	unguardSlow;
+}
+static void BuildPriorityHeap( FActorPriority* Heap, INT Num )
+{
+	guardSlow(BuildPriorityHeap);
+	for( INT i=Num/2-1; i>=0; i-- )
+		SiftDownPriority( Heap, Num, i );
+	unguardSlow;
+}
+static FActorPriority PopPriorityHeap( FActorPriority* Heap, INT& Num )
+{
+	guardSlow(PopPriorityHeap);
+	FActorPriority Result = Heap[0];
+	Heap[0] = Heap[--Num];
+	if( Num > 0 )
+		SiftDownPriority( Heap, Num, 0 );
+	return Result;
+	unguardSlow;
+}
 
 /*-----------------------------------------------------------------------------
 	Tick a single actor.
@@ -427,9 +465,13 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 	||	Connection->State!=USOCK_Open )
 		return 0;
 
-	// Get list of visible/relevant actors.
-	AActor* Relevant[256];
-	INT NumRelevant = GetRelevantActors( Connection->Actor, Relevant, ARRAY_COUNT(Relevant) );
+	// Get list of visible/relevant actors.  Every relevant actor is a dynamic
+	// actor, and each open channel adds at most one more below, so together
+	// they bound the list.
+	FMemMark Mark(GMem);
+	INT MaxRelevant = ::Max( Num() - iFirstDynamicActor + Connection->OpenChannels.Num(), 1 );
+	AActor** Relevant = new(GMem,MaxRelevant)AActor*;
+	INT NumRelevant = GetRelevantActors( Connection->Actor, Relevant, MaxRelevant );
 
 	// If an actor's relevence has timed out, delete its channel; otherwise
 	// treat it as relevant for now.
@@ -449,8 +491,8 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 			:	(NetDriver->Time-It->RelevantTime<NetDriver->DumbProxyTimeout) )
 			{
 				// This actor's relevence hasn't timed out yet.
-				if( NumRelevant<ARRAY_COUNT(Relevant) )
-					Relevant[NumRelevant++] = Actor;
+				check(NumRelevant<MaxRelevant);
+				Relevant[NumRelevant++] = Actor;
 			}
 			else
 			{
@@ -463,25 +505,28 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 		}
 	}
 
-	// Make priority-sorted list.
-	FMemMark Mark(GMem);
+	// Make priority heap.
 	FActorPriority* PriorityActors = new(GMem,NumRelevant)FActorPriority;
 	INT j;
 	for( j=0; j<NumRelevant; j++ )
 		PriorityActors[j] = FActorPriority( Connection, Relevant[j] );
-	appSort( PriorityActors, NumRelevant );
+	BuildPriorityHeap( PriorityActors, NumRelevant );
 
-	// Update all relevant actors in sorted order.
-	for( j=0; j<NumRelevant && Connection->IsNetReady(); j++ )
+	// Update the most important actors until the connection's bandwidth is used up.
+	// Actors left over keep their old update time, so their priority rises until
+	// they win a later tick.
+	INT NumLeft = NumRelevant;
+	while( NumLeft>0 && Connection->IsNetReady() )
 	{
 		// Find or create the channel for this actor.
-		//debugf("%i...%f...%f",j,PriorityActors[j].Priority,PriorityActors[j].Channel ? PriorityActors[j].Channel->LastUpdateTime:0);
-		FActorChannel* Channel = PriorityActors[j].Channel;
-		if( !Channel && NetDriver->Map.ObjectToIndex(PriorityActors[j].Actor->GetClass())!=INDEX_NONE )
+		FActorPriority Top = PopPriorityHeap( PriorityActors, NumLeft );
+		FActorChannel* Channel = Top.Channel;
+		if( !Channel && NetDriver->Map.ObjectToIndex(Top.Actor->GetClass())!=INDEX_NONE )
 		{
 			// Create a new channel for this actor.
 			Channel = (FActorChannel *)Connection->CreateChannel( CHTYPE_Actor, 1 );
-			Channel->Actor = PriorityActors[j].Actor;
+			if( Channel )
+				Channel->Actor = Top.Actor;
 		}
 
 		// Send updates to the remote player.
@@ -490,9 +535,9 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 			check(Channel->State==UCHAN_Open);
 			if( Channel->IsNetReady(0) )
 			{
+				// Bunches from all channels are packed into the connection's
+				// packet, which is flushed once full and after all clients are ticked.
 				Channel->ReplicateActor( 1 );
-				if( Connection->OutNum > UNetConnection::IDEAL_PACKET_SIZE )
-					Connection->FlushNet();
 				Updated++;
 			}
 		}
@@ -515,8 +560,24 @@ void ULevel::TickNetServer( FLOAT DeltaSeconds )
 	uclock(NetTickCycles);
 	INT Updated=0;
 	INT i;
+
+	// Rebuild the relevancy index shared by all clients.
+	uclock(GetRelevantCycles);
+	if( !RelevancyIndex )
+		RelevancyIndex = new FRelevancyIndex;
+	RelevancyIndex->Build( this );
+	uunclock(GetRelevantCycles);
+
+	// Replicate to each client, sharing work between clients.
+	NetDriver->RepCache.Begin();
 	for( i=0; i<NetDriver->Connections.Num(); i++ )
 		Updated += ServerTickClient( NetDriver->Connections(i), DeltaSeconds );
+	NetDriver->RepCache.End();
+
+	// Send whatever each client's packet holds, so updates don't wait a tick.
+	for( i=0; i<NetDriver->Connections.Num(); i++ )
+		if( NetDriver->Connections(i)->State==USOCK_Open )
+			NetDriver->Connections(i)->FlushNet();
 	uunclock(NetTickCycles);
 
 	// Stats.
@@ -536,14 +597,18 @@ void ULevel::TickNetServer( FLOAT DeltaSeconds )
 			appSprintf
 			(
 				Stats,
-				"cli=%i act=%03.1f (%i) see=%03.1f net=%03.1f pv/c=%i rep/c=%i",
+				"cli=%i act=%03.1f (%i) see=%03.1f (%03.1f %i) net=%03.1f pv/c=%i rep/c=%i shr=%i/%i",
 				NetDriver->Connections.Num(),
 				GSecondsPerCycle*1000 * ActorTickCycles,
 				NumActors,
 				GSecondsPerCycle*1000 * GetRelevantCycles,
+				GSecondsPerCycle*1000 * Connection->GetRelevantCycles,
+				Connection->NumRelevant,
 				GSecondsPerCycle*1000 * (NetTickCycles - GetRelevantCycles),
 				NumPV/NetDriver->Connections.Num(),
-				NumReps/NetDriver->Connections.Num()
+				NumReps/NetDriver->Connections.Num(),
+				NetDriver->RepCache.NumShared,
+				NetDriver->RepCache.NumEncoded
 			);
 			Connection->Actor->eventClientMessage(Stats);
 		}
@@ -639,6 +704,10 @@ void ULevel::Tick( ELevelTick TickType, FLOAT DeltaSeconds )
 	if( NetDriver && !NetDriver->ServerConnection )
 		TickNetServer( DeltaSeconds );
 
+	// Send any packets the net driver batched up this tick.
+	if( NetDriver )
+		NetDriver->TickFlush();
+
 	// Finish up.
 	Ticked = !Ticked;
 	InTick = 0;
@@ -209,6 +209,20 @@ void ULevel::Destroy()
 		Hash = NULL; /* Required because actors may try to unhash themselves */
 	}
 
+	// Free the relevancy index.
+	if( RelevancyIndex )
+	{
+		delete RelevancyIndex;
+		RelevancyIndex = NULL;
+	}
+
+	// Free the navigation graph.
+	if( NavGraph )
+	{
+		delete NavGraph;
+		NavGraph = NULL;
+	}
+
 	if( BrushTracker )
 	{
 		delete BrushTracker;
@@ -337,6 +351,22 @@ UBOOL ULevel::Exec( const char* Cmd, FOutputDevice* Out )
 	guard(ULevel::Exec);
 	const char* Str = Cmd;
 	if( NetDriver && NetDriver->Exec( Cmd, Out ) ) return 1;
+	else if( ParseCommand(&Str,"NAVGRAPH") )
+	{
+		if( NavGraph )
+			Out->Logf
+			(
+				"Navigation graph: %i nodes, %i edges, %i buckets, routes %i hits %i misses",
+				NavGraph->Nodes.Num(),
+				NavGraph->DownEdges.Num(),
+				NavGraph->Buckets.Num(),
+				NavGraph->RouteHits,
+				NavGraph->RouteMisses
+			);
+		else
+			Out->Log( "No navigation graph" );
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
@@ -563,10 +593,17 @@ void ULevel::NotifyReceivedText( UNetConnection* Connection, const char* Text )
 				return;
 			}
 
+			// Negotiate packet size and channel limit with clients that support it.
+			INT MaxPacket, MaxChannels;
+			if( Parse( Text, "MAXPACKET=", MaxPacket ) )
+				Connection->NegotiateMaxPacket( MaxPacket );
+			if( Parse( Text, "MAXCHANNELS=", MaxChannels ) )
+				Connection->NegotiateMaxChannels( MaxChannels );
+
 			// Get byte limit.
 			Connection->ByteLimit = NetDriver->DefaultByteLimit;
 			Connection->Challenge = appCycles();
-			Connection->Logf( "CHALLENGE CHALLENGE=%i", Connection->Challenge );
+			Connection->Logf( "CHALLENGE CHALLENGE=%i MAXPACKET=%i MAXCHANNELS=%i", Connection->Challenge, Connection->MaxPacket, Connection->MaxChannels );
 			Connection->FlushNet();
 		}
 		else if( ParseCommand(&Text,"LOGIN") )
@@ -766,13 +803,119 @@ static UBOOL CanSee
 	unguardSlow;
 }
 
+/*-----------------------------------------------------------------------------
+	FRelevancyIndex implementation.
+-----------------------------------------------------------------------------*/
+
+FRelevancyIndex::FRelevancyIndex()
+:	Actors()
+{
+	guard(FRelevancyIndex::FRelevancyIndex);
+	for( INT i=0; i<ARRAY_COUNT(BucketStart); i++ )
+		BucketStart[i] = 0;
+	unguard;
+}
+
+//
+// Return the bucket an actor belongs in.  Zone infos and brushes are relevant
+// from anywhere, and owned actors follow their top owner since inventory
+// locations are not kept up to date while held.
+//
+static INT GetRelevancyBucket( AActor* Actor )
+{
+	guardSlow(GetRelevancyBucket);
+	if( Actor->Brush || Actor->IsA(AZoneInfo::StaticClass) )
+		return FRelevancyIndex::ANY_ZONE;
+	INT iZone = Actor->GetTopOwner()->Region.ZoneNumber;
+	return iZone<FRelevancyIndex::ANY_ZONE ? iZone : FRelevancyIndex::ANY_ZONE;
+	unguardSlow;
+}
+
+//
+// Bucket all replicated dynamic actors by zone.
+//
+void FRelevancyIndex::Build( ULevel* Level )
+{
+	guard(FRelevancyIndex::Build);
+	FMemMark Mark(GMem);
+	BYTE* Buckets = new(GMem,Level->Num())BYTE;
+
+	// Count actors in each bucket.
+	INT i;
+	for( i=0; i<ARRAY_COUNT(BucketStart); i++ )
+		BucketStart[i] = 0;
+	for( i=Level->iFirstDynamicActor; i<Level->Num(); i++ )
+	{
+		AActor* Actor = Level->Actors(i);
+		if( Actor && Actor->RemoteRole!=ROLE_None )
+		{
+			Buckets[i] = GetRelevancyBucket( Actor );
+			BucketStart[Buckets[i]+1]++;
+		}
+	}
+	for( i=1; i<ARRAY_COUNT(BucketStart); i++ )
+		BucketStart[i] += BucketStart[i-1];
+
+	// Distribute actors, preserving their level order within each bucket.
+	INT Fill[ANY_ZONE+1];
+	for( i=0; i<ARRAY_COUNT(Fill); i++ )
+		Fill[i] = BucketStart[i];
+	Actors.Empty();
+	Actors.Add( BucketStart[ANY_ZONE+1] );
+	for( i=Level->iFirstDynamicActor; i<Level->Num(); i++ )
+	{
+		AActor* Actor = Level->Actors(i);
+		if( Actor && Actor->RemoteRole!=ROLE_None )
+			Actors(Fill[Buckets[i]]++) = Actor;
+	}
+	Mark.Pop();
+	unguard;
+}
+
+//
+// Return a bitmask of the zones possibly visible from a viewpoint.
+// Zones which aren't connected through any chain of portals can never see
+// each other; zone 0 is used by unzoned maps and can't be culled.
+//
+QWORD FRelevancyIndex::GetVisibleZones( ULevel* Level, FVector Location, FVector Ahead )
+{
+	guard(FRelevancyIndex::GetVisibleZones);
+	UBspNodes* Nodes = Level->Model->Nodes;
+	if( !Nodes->NumZones )
+		return ~(QWORD)0;
+	INT iViewZones[2];
+	iViewZones[0] = Level->Model->PointRegion( Level->GetLevelInfo(), Location ).ZoneNumber;
+	iViewZones[1] = Level->Model->PointRegion( Level->GetLevelInfo(), Ahead    ).ZoneNumber;
+	QWORD Result  = 1;
+	for( INT i=0; i<ARRAY_COUNT(iViewZones); i++ )
+	{
+		INT iViewZone = iViewZones[i];
+		if( iViewZone==0 )
+			return ~(QWORD)0;
+		for( INT iZone=1; iZone<UBspNodes::MAX_ZONES; iZone++ )
+			if
+			(	(Nodes->Zones[iViewZone].Visibility & ((QWORD)1<<iZone))
+			&&	Level->ZoneDist[iViewZone][iZone]!=255 )
+				Result |= ((QWORD)1<<iZone);
+	}
+	return Result;
+	unguard;
+}
+
 //
 // Get a list of actors that are relevant to a given network player pawn.
 // These actors are replicated over the net.
 //
+// Only actors in zones which could be seen from the viewpoint are tested.
+// Actors found visible are remembered by the connection and aren't traced
+// again until RelevantCacheSeconds have passed; actors which weren't visible
+// are retested every tick, so newly visible actors appear as quickly as before.
+//
 INT ULevel::GetRelevantActors( APlayerPawn* InViewer, AActor** List, INT Max )
 {
 	guard(ULevel::GetRelevantActors);
+	UNetConnection* Connection = Cast<UNetConnection>( InViewer->Player );
+	DWORD StartCycles = appCycles();
 	uclock(GetRelevantCycles);
 	debug(Max>0);
 	NetTag++;
@@ -802,21 +945,86 @@ INT ULevel::GetRelevantActors( APlayerPawn* InViewer, AActor** List, INT Max )
 	Hit.Location = Location + Ahead;
 	Viewer->XLevel->Model->LineCheck(Hit,NULL,Hit.Location,Location,FVector(0,0,0),NF_NotVisBlocking);
 
-	// Slow version which doesn't use any precomputed visibility.
+	// Make sure the index exists even if we weren't called from TickNetServer.
+	if( !RelevancyIndex )
+	{
+		RelevancyIndex = new FRelevancyIndex;
+		RelevancyIndex->Build( this );
+	}
+	QWORD VisibleZones = RelevancyIndex->GetVisibleZones( this, Location, Hit.Location );
+
+	// Test all actors in possibly visible zones.
+	FMemMark Mark(GMem);
+	FRelevantCacheEntry* Visible = new(GMem,Max)FRelevantCacheEntry;
+	DOUBLE Time = NetDriver->Time;
 	INT Count=0;
-	for( INT i=iFirstDynamicActor; i<Num(); i++ )
+	for( INT iBucket=0; iBucket<=FRelevancyIndex::ANY_ZONE && Count<Max; iBucket++ )
 	{
-		if
-		(	Actors(i)
-		&&	Actors(i)->RemoteRole!=ROLE_None
-		&&	(Actors(i)==InViewer || CanSee(Viewer,Location,Actors(i),Hit.Location)) )
+		if( iBucket<FRelevancyIndex::ANY_ZONE && !(VisibleZones & ((QWORD)1<<iBucket)) )
+			continue;
+		AActor** Bucket = RelevancyIndex->GetBucket( iBucket );
+		for( INT i=0; i<RelevancyIndex->Num(iBucket); i++ )
 		{
-			Actors(i)->NetTag = NetTag;
-			List[Count++] = Actors(i);
-			if( Count == Max )
-				break;
+			AActor* Actor = Bucket[i];
+			if( Actor->bDeleteMe )
+				continue;
+			UBOOL Relevant = 0;
+			DOUBLE ExpireTime = Time, FirstRelevantTime = Time;
+			if( Actor==InViewer )
+			{
+				Relevant = 1;
+			}
+			else if( Connection )
+			{
+				FRelevantCacheEntry* Entry = Connection->FindRelevantActor( Actor );
+				FirstRelevantTime = Entry ? Entry->FirstRelevantTime : Time;
+				if( Entry && Entry->ExpireTime>Time )
+				{
+					Relevant   = 1;
+					ExpireTime = Entry->ExpireTime;
+				}
+				else if( CanSee(Viewer,Location,Actor,Hit.Location) )
+				{
+					Relevant   = 1;
+					ExpireTime = Time + NetDriver->RelevantCacheSeconds;
+				}
+			}
+			else Relevant = CanSee(Viewer,Location,Actor,Hit.Location);
+			if( Relevant )
+			{
+				Actor->NetTag = NetTag;
+				Visible[Count].Actor      = Actor;
+				Visible[Count].ExpireTime = ExpireTime;
+				Visible[Count].FirstRelevantTime = FirstRelevantTime;
+				List[Count++] = Actor;
+				if( Count == Max )
+					break;
+			}
 		}
 	}
+
+	// Replace the connection's cache with this tick's visible set.
+	if( Connection )
+	{
+		INT CacheSize;
+		for( CacheSize=16; CacheSize<Count*2; CacheSize*=2 );
+		if( Connection->RelevantCache.Num()!=CacheSize )
+		{
+			Connection->RelevantCache.Empty();
+			Connection->RelevantCache.AddZeroed( CacheSize );
+		}
+		else appMemset( &Connection->RelevantCache(0), 0, CacheSize*sizeof(FRelevantCacheEntry) );
+		for( INT i=0; i<Count; i++ )
+		{
+			INT Mask = CacheSize-1, j;
+			for( j=((DWORD)Visible[i].Actor>>4)&Mask; Connection->RelevantCache(j).Actor; j=(j+1)&Mask );
+			Connection->RelevantCache(j) = Visible[i];
+		}
+		Connection->GetRelevantCycles = appCycles() - StartCycles;
+		Connection->NumRelevant       = Count;
+	}
+	Mark.Pop();
+
 	NumPV += Count;
 	uunclock(GetRelevantCycles);
 	return Count;
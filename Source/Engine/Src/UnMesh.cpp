@@ -10,6 +10,16 @@
 #include "UnRender.h"
 #include "Amd3d.h"
 
+// SIMD versions of the vertex animation loop.  The scalar loop handles other
+// targets and whatever is left over at the end.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define MESH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MESH_NEON 1
+#include <arm_neon.h>
+#endif
+
 /*-----------------------------------------------------------------------------
 	UMesh object implementation.
 -----------------------------------------------------------------------------*/
@@ -126,6 +136,170 @@ UBOOL UMesh::LineCheck
 	unguardobj;
 }
 
+/*-----------------------------------------------------------------------------
+	Vertex animation.
+-----------------------------------------------------------------------------*/
+
+//
+// Interpolate Num packed vertices from V1 to V2 by Alpha into Cached, and
+// transform them into Result, which has a stride of Size bytes.  If V1 is
+// NULL, tween from the vertices already in Cached instead.
+//
+static void AnimVertsScalar
+(
+	const FMeshVert*	V1,
+	const FMeshVert*	V2,
+	FLOAT				Alpha,
+	FVector*			Cached,
+	const FVector&		Origin,
+	const FCoords&		Coords,
+	FVector*			Result,
+	INT					Size,
+	INT					Num
+)
+{
+	guardSlow(AnimVertsScalar);
+	for( INT i=0; i<Num; i++ )
+	{
+		FVector Base = V1 ? FVector( V1[i].X, V1[i].Y, V1[i].Z ) : Cached[i];
+		FVector Next( V2[i].X, V2[i].Y, V2[i].Z );
+		Cached[i] = Base + (Next-Base)*Alpha;
+		*Result = (Cached[i] - Origin).TransformPointBy(Coords);
+		*(BYTE**)&Result += Size;
+	}
+	unguardSlow;
+}
+
+#if MESH_SSE2
+// Unpack four 11/11/10 bit vertices into X, Y and Z lanes.
+static inline void UnpackVerts( const FMeshVert* V, __m128& X, __m128& Y, __m128& Z )
+{
+	__m128i D = _mm_loadu_si128( (__m128i*)V );
+	X = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_slli_epi32( D, 21 ), 21 ) );
+	Y = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_slli_epi32( D, 10 ), 21 ) );
+	Z = _mm_cvtepi32_ps( _mm_srai_epi32( D, 22 ) );
+}
+#elif MESH_NEON
+static inline void UnpackVerts( const FMeshVert* V, float32x4_t& X, float32x4_t& Y, float32x4_t& Z )
+{
+	int32x4_t D = vld1q_s32( (const int32_t*)V );
+	X = vcvtq_f32_s32( vshrq_n_s32( vshlq_n_s32( D, 21 ), 21 ) );
+	Y = vcvtq_f32_s32( vshrq_n_s32( vshlq_n_s32( D, 10 ), 21 ) );
+	Z = vcvtq_f32_s32( vshrq_n_s32( D, 22 ) );
+}
+#endif
+
+//
+// AnimVertsScalar four vertices at a time.  The arithmetic is done in the
+// same order, so the results match.
+//
+static void AnimVerts
+(
+	const FMeshVert*	V1,
+	const FMeshVert*	V2,
+	FLOAT				Alpha,
+	FVector*			Cached,
+	const FVector&		Origin,
+	const FCoords&		Coords,
+	FVector*			Result,
+	INT					Size,
+	INT					Num
+)
+{
+	guardSlow(AnimVerts);
+	INT i=0;
+#if MESH_SSE2
+	const __m128 A  = _mm_set1_ps( Alpha );
+	const __m128 OX = _mm_set1_ps( Origin.X ),       OY = _mm_set1_ps( Origin.Y ),       OZ = _mm_set1_ps( Origin.Z );
+	const __m128 CX = _mm_set1_ps( Coords.Origin.X ), CY = _mm_set1_ps( Coords.Origin.Y ), CZ = _mm_set1_ps( Coords.Origin.Z );
+	const __m128 XX = _mm_set1_ps( Coords.XAxis.X ),  XY = _mm_set1_ps( Coords.XAxis.Y ),  XZ = _mm_set1_ps( Coords.XAxis.Z );
+	const __m128 YX = _mm_set1_ps( Coords.YAxis.X ),  YY = _mm_set1_ps( Coords.YAxis.Y ),  YZ = _mm_set1_ps( Coords.YAxis.Z );
+	const __m128 ZX = _mm_set1_ps( Coords.ZAxis.X ),  ZY = _mm_set1_ps( Coords.ZAxis.Y ),  ZZ = _mm_set1_ps( Coords.ZAxis.Z );
+	for( ; i+4<=Num; i+=4 )
+	{
+		// Get the base vertices, packed or from the cache.
+		__m128 X1, Y1, Z1, X2, Y2, Z2;
+		FVector* C = &Cached[i];
+		if( V1 )
+		{
+			UnpackVerts( &V1[i], X1, Y1, Z1 );
+		}
+		else
+		{
+			// Cache holds x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3.
+			__m128 P = _mm_loadu_ps( &C[0].X ), Q = _mm_loadu_ps( &C[1].Y ), R = _mm_loadu_ps( &C[2].Z );
+			X1 = _mm_shuffle_ps( P, _mm_shuffle_ps( Q, R, _MM_SHUFFLE(0,1,0,2) ), _MM_SHUFFLE(2,0,3,0) );
+			Y1 = _mm_shuffle_ps( _mm_shuffle_ps( P, Q, _MM_SHUFFLE(0,0,0,1) ), _mm_shuffle_ps( Q, R, _MM_SHUFFLE(0,2,0,3) ), _MM_SHUFFLE(2,0,2,0) );
+			Z1 = _mm_shuffle_ps( _mm_shuffle_ps( P, Q, _MM_SHUFFLE(0,1,0,2) ), R, _MM_SHUFFLE(3,0,2,0) );
+		}
+		UnpackVerts( &V2[i], X2, Y2, Z2 );
+
+		// Interpolate and cache.
+		__m128 X = _mm_add_ps( X1, _mm_mul_ps( _mm_sub_ps( X2, X1 ), A ) );
+		__m128 Y = _mm_add_ps( Y1, _mm_mul_ps( _mm_sub_ps( Y2, Y1 ), A ) );
+		__m128 Z = _mm_add_ps( Z1, _mm_mul_ps( _mm_sub_ps( Z2, Z1 ), A ) );
+		__m128 XY01 = _mm_unpacklo_ps( X, Y ), XY23 = _mm_unpackhi_ps( X, Y );
+		__m128 ZZXX = _mm_shuffle_ps( Z, X, _MM_SHUFFLE(1,0,1,0) );
+		__m128 YYZZ = _mm_shuffle_ps( Y, Z, _MM_SHUFFLE(1,1,1,1) );
+		__m128 ZZXY = _mm_shuffle_ps( Z, XY23, _MM_SHUFFLE(3,2,3,2) );
+		_mm_storeu_ps( &C[0].X, _mm_shuffle_ps( XY01, ZZXX, _MM_SHUFFLE(3,0,1,0) ) );
+		_mm_storeu_ps( &C[1].Y, _mm_shuffle_ps( YYZZ, XY23, _MM_SHUFFLE(1,0,2,0) ) );
+		_mm_storeu_ps( &C[2].Z, _mm_shuffle_ps( ZZXY, ZZXY, _MM_SHUFFLE(1,3,2,0) ) );
+
+		// Transform.
+		X = _mm_sub_ps( _mm_sub_ps( X, OX ), CX );
+		Y = _mm_sub_ps( _mm_sub_ps( Y, OY ), CY );
+		Z = _mm_sub_ps( _mm_sub_ps( Z, OZ ), CZ );
+		__m128 RX = _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, XX ), _mm_mul_ps( Y, XY ) ), _mm_mul_ps( Z, XZ ) );
+		__m128 RY = _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, YX ), _mm_mul_ps( Y, YY ) ), _mm_mul_ps( Z, YZ ) );
+		__m128 RZ = _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, ZX ), _mm_mul_ps( Y, ZY ) ), _mm_mul_ps( Z, ZZ ) );
+
+		// Store each vertex's 12 bytes, leaving the rest of the stride alone.
+		__m128 R01 = _mm_unpacklo_ps( RX, RY ), R23 = _mm_unpackhi_ps( RX, RY );
+		_mm_storel_pi( (__m64*)&Result->X, R01 ); _mm_store_ss( &Result->Z, RZ );                                         *(BYTE**)&Result += Size;
+		_mm_storeh_pi( (__m64*)&Result->X, R01 ); _mm_store_ss( &Result->Z, _mm_shuffle_ps( RZ, RZ, _MM_SHUFFLE(1,1,1,1) ) ); *(BYTE**)&Result += Size;
+		_mm_storel_pi( (__m64*)&Result->X, R23 ); _mm_store_ss( &Result->Z, _mm_movehl_ps( RZ, RZ ) );                       *(BYTE**)&Result += Size;
+		_mm_storeh_pi( (__m64*)&Result->X, R23 ); _mm_store_ss( &Result->Z, _mm_shuffle_ps( RZ, RZ, _MM_SHUFFLE(3,3,3,3) ) ); *(BYTE**)&Result += Size;
+	}
+#elif MESH_NEON
+	const float32x4_t A  = vdupq_n_f32( Alpha );
+	const float32x4_t OX = vdupq_n_f32( Origin.X ),       OY = vdupq_n_f32( Origin.Y ),       OZ = vdupq_n_f32( Origin.Z );
+	const float32x4_t CX = vdupq_n_f32( Coords.Origin.X ), CY = vdupq_n_f32( Coords.Origin.Y ), CZ = vdupq_n_f32( Coords.Origin.Z );
+	for( ; i+4<=Num; i+=4 )
+	{
+		// Get the base vertices, packed or from the cache.
+		float32x4x3_t B, N;
+		if( V1 )
+			UnpackVerts( &V1[i], B.val[0], B.val[1], B.val[2] );
+		else
+			B = vld3q_f32( &Cached[i].X );
+		UnpackVerts( &V2[i], N.val[0], N.val[1], N.val[2] );
+
+		// Interpolate and cache.
+		for( INT k=0; k<3; k++ )
+			B.val[k] = vaddq_f32( B.val[k], vmulq_f32( vsubq_f32( N.val[k], B.val[k] ), A ) );
+		vst3q_f32( &Cached[i].X, B );
+
+		// Transform.
+		float32x4_t X = vsubq_f32( vsubq_f32( B.val[0], OX ), CX );
+		float32x4_t Y = vsubq_f32( vsubq_f32( B.val[1], OY ), CY );
+		float32x4_t Z = vsubq_f32( vsubq_f32( B.val[2], OZ ), CZ );
+		float32x4x3_t R;
+		R.val[0] = vaddq_f32( vaddq_f32( vmulq_n_f32( X, Coords.XAxis.X ), vmulq_n_f32( Y, Coords.XAxis.Y ) ), vmulq_n_f32( Z, Coords.XAxis.Z ) );
+		R.val[1] = vaddq_f32( vaddq_f32( vmulq_n_f32( X, Coords.YAxis.X ), vmulq_n_f32( Y, Coords.YAxis.Y ) ), vmulq_n_f32( Z, Coords.YAxis.Z ) );
+		R.val[2] = vaddq_f32( vaddq_f32( vmulq_n_f32( X, Coords.ZAxis.X ), vmulq_n_f32( Y, Coords.ZAxis.Y ) ), vmulq_n_f32( Z, Coords.ZAxis.Z ) );
+
+		// Store each vertex's 12 bytes, leaving the rest of the stride alone.
+		vst3q_lane_f32( &Result->X, R, 0 ); *(BYTE**)&Result += Size;
+		vst3q_lane_f32( &Result->X, R, 1 ); *(BYTE**)&Result += Size;
+		vst3q_lane_f32( &Result->X, R, 2 ); *(BYTE**)&Result += Size;
+		vst3q_lane_f32( &Result->X, R, 3 ); *(BYTE**)&Result += Size;
+	}
+#endif
+	AnimVertsScalar( V1 ? V1+i : NULL, V2+i, Alpha, Cached+i, Origin, Coords, Result, Size, Num-i );
+	unguardSlow;
+}
+
 /*-----------------------------------------------------------------------------
 	UMesh animation interface.
 -----------------------------------------------------------------------------*/
@@ -192,16 +366,7 @@ void UMesh::GetFrame
 		}
 
 		// Interpolate two frames.
-		FMeshVert* MeshVertex1 = &Verts( iFrameOffset1 );
-		FMeshVert* MeshVertex2 = &Verts( iFrameOffset2 );
-		for( INT i=0; i<FrameVerts; i++ )
-		{
-			FVector V1( MeshVertex1[i].X, MeshVertex1[i].Y, MeshVertex1[i].Z );
-			FVector V2( MeshVertex2[i].X, MeshVertex2[i].Y, MeshVertex2[i].Z );
-			CachedVerts[i] = V1 + (V2-V1)*Alpha;
-			*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-			*(BYTE**)&ResultVerts += Size;
-		}
+		AnimVerts( &Verts(iFrameOffset1), &Verts(iFrameOffset2), Alpha, CachedVerts, Origin, Coords, ResultVerts, Size, FrameVerts );
 	}
 	else
 	{
@@ -217,14 +382,7 @@ void UMesh::GetFrame
 		}
 
 		// Tween all points.
-		FMeshVert* MeshVertex = &Verts( iFrameOffset );
-		for( INT i=0; i<FrameVerts; i++ )
-		{
-			FVector V2( MeshVertex[i].X, MeshVertex[i].Y, MeshVertex[i].Z );
-			CachedVerts[i] += (V2 - CachedVerts[i]) * Alpha;
-			*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-			*(BYTE**)&ResultVerts += Size;
-		}
+		AnimVerts( NULL, &Verts(iFrameOffset), Alpha, CachedVerts, Origin, Coords, ResultVerts, Size, FrameVerts );
 
 		// Update cached frame.
 		CachedFrame = Owner->AnimFrame;
@@ -233,6 +391,91 @@ void UMesh::GetFrame
 	unguardobj;
 }
 
+//
+// Time the vertex animation loop against the scalar one on every loaded mesh,
+// interpolating and then tweening across each of its frames Passes times.
+//
+void UMesh::BenchmarkAnim( FOutputDevice* Out, INT Passes )
+{
+	guard(UMesh::BenchmarkAnim);
+	FCoords Coords = GMath.UnitCoords * FVector(0,0,512) * FRotator(2048,8192,0);
+	DOUBLE  TotalTime[2] = {0.0,0.0};
+	INT     TotalMeshes=0, TotalVerts=0;
+	for( TObjectIterator<UMesh> It; It; ++It )
+	{
+		UMesh* Mesh = *It;
+		if( Mesh->FrameVerts<=0 || Mesh->AnimFrames<=0 || Mesh->Verts.Num()<Mesh->FrameVerts*Mesh->AnimFrames )
+			continue;
+		FMemMark Mark(GMem);
+		FVector*       Cached  = New<FVector>(GMem,Mesh->FrameVerts);
+		FVector*       Check   = New<FVector>(GMem,Mesh->FrameVerts);
+		FTransTexture* Samples = New<FTransTexture>(GMem,Mesh->FrameVerts);
+
+		// Time both loops.
+		DOUBLE Time[2];
+		for( INT k=0; k<2; k++ )
+		{
+			Time[k] = appSeconds();
+			for( INT Pass=0; Pass<Passes; Pass++ )
+			{
+				for( INT f=0; f<Mesh->AnimFrames; f++ )
+				{
+					FMeshVert* V1 = &Mesh->Verts( f * Mesh->FrameVerts );
+					FMeshVert* V2 = &Mesh->Verts( ((f+1) % Mesh->AnimFrames) * Mesh->FrameVerts );
+					if( k==0 )
+					{
+						AnimVertsScalar( V1, V2, 0.375, Cached, Mesh->Origin, Coords, &Samples->Point, sizeof(Samples[0]), Mesh->FrameVerts );
+						AnimVertsScalar( NULL, V1, 0.5, Cached, Mesh->Origin, Coords, &Samples->Point, sizeof(Samples[0]), Mesh->FrameVerts );
+					}
+					else
+					{
+						AnimVerts( V1, V2, 0.375, Cached, Mesh->Origin, Coords, &Samples->Point, sizeof(Samples[0]), Mesh->FrameVerts );
+						AnimVerts( NULL, V1, 0.5, Cached, Mesh->Origin, Coords, &Samples->Point, sizeof(Samples[0]), Mesh->FrameVerts );
+					}
+				}
+			}
+			Time[k] = (appSeconds() - Time[k]) / (2 * Passes * Mesh->AnimFrames);
+			TotalTime[k] += Time[k];
+		}
+
+		// Compare their results for an interpolation and then a tween.
+		FVector*   CheckCached = New<FVector>(GMem,Mesh->FrameVerts);
+		FMeshVert* First       = &Mesh->Verts( 0 );
+		FMeshVert* Last        = &Mesh->Verts( (Mesh->AnimFrames-1) * Mesh->FrameVerts );
+		FLOAT      MaxError    = 0.0;
+		for( INT k=0; k<2; k++ )
+		{
+			AnimVertsScalar( k ? NULL : First, k ? First : Last, 0.375, CheckCached, Mesh->Origin, Coords, Check, sizeof(FVector), Mesh->FrameVerts );
+			AnimVerts      ( k ? NULL : First, k ? First : Last, 0.375, Cached, Mesh->Origin, Coords, &Samples->Point, sizeof(Samples[0]), Mesh->FrameVerts );
+			for( INT i=0; i<Mesh->FrameVerts; i++ )
+				MaxError = Max( MaxError, (Samples[i].Point - Check[i]).SizeSquared() );
+		}
+		Out->Logf
+		(
+			"%s: %i verts, %i frames: scalar %.2f us, SIMD %.2f us (%.2fx), error %g",
+			Mesh->GetName(),
+			Mesh->FrameVerts,
+			Mesh->AnimFrames,
+			Time[0] * 1000000.0,
+			Time[1] * 1000000.0,
+			Time[0] / Max(Time[1],1e-9),
+			appSqrt(MaxError)
+		);
+		TotalMeshes++;
+		TotalVerts += Mesh->FrameVerts;
+	}
+	Out->Logf
+	(
+		"%i meshes, %i verts: scalar %.2f ms, SIMD %.2f ms per frame of all meshes (%.2fx)",
+		TotalMeshes,
+		TotalVerts,
+		TotalTime[0] * 1000.0,
+		TotalTime[1] * 1000.0,
+		TotalTime[0] / Max(TotalTime[1],1e-9)
+	);
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	UMesh constructor.
 -----------------------------------------------------------------------------*/
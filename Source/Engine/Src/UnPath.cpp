@@ -182,6 +182,13 @@ void ENGINE_API FPathBuilder::undefinePaths (ULevel *ownerLevel)
 	debugf(NAME_DevPath,"Remove %d old reachspecs", Level->ReachSpecs.Num());
 	Level->ReachSpecs.Empty();
 
+	// discard the flattened navigation graph
+	if( Level->NavGraph )
+	{
+		delete Level->NavGraph;
+		Level->NavGraph = NULL;
+	}
+
 	// clear navigationpointlist
 	Level->GetLevelInfo()->NavigationPointList = NULL;
 
@@ -249,21 +256,30 @@ void ENGINE_API FPathBuilder::definePaths (ULevel *ownerLevel)
 		}
 	}
 
-	//calculate and add reachspecs to pathnodes
-	debugf(NAME_DevPath,"Add reachspecs");
+	//gather navigation points once, rather than scanning the level for each one
+	NavPoints.Empty();
 	for (i=0; i<Level->Num(); i++)
 	{
 		AActor *Actor = Level->Actors(i); 
 		if (Actor && Actor->IsA(ANavigationPoint::StaticClass))
-		{
-			((ANavigationPoint *)Actor)->nextNavigationPoint = Level->GetLevelInfo()->NavigationPointList;
-			Level->GetLevelInfo()->NavigationPointList = (ANavigationPoint *)Actor;
-			addReachSpecs(Actor);
-			debugf( NAME_DevPath, "Added reachspecs to %s",Actor->GetName() );
-		}
+			NavPoints.AddItem((ANavigationPoint *)Actor);
 	}
 
-	debugf(NAME_DevPath,"Added %d reachspecs", Level->ReachSpecs.Num()); 
+	//calculate and add reachspecs to pathnodes
+	debugf(NAME_DevPath,"Add reachspecs");
+	DOUBLE StartTime = appSeconds();
+	numTested = numSkipped = 0;
+	for (i=0; i<NavPoints.Num(); i++)
+	{
+		ANavigationPoint *Nav = NavPoints(i);
+		Nav->nextNavigationPoint = Level->GetLevelInfo()->NavigationPointList;
+		Level->GetLevelInfo()->NavigationPointList = Nav;
+		addReachSpecs(Nav);
+		debugf( NAME_DevPath, "Added reachspecs to %s",Nav->GetName() );
+	}
+	NavPoints.Empty();
+
+	debugf(NAME_DevPath,"Added %d reachspecs in %.1f seconds (%d pairs tested, %d skipped)", Level->ReachSpecs.Num(), appSeconds() - StartTime, numTested, numSkipped); 
 	//remove extra reachspecs from teleporters
 
 	//prune excess reachspecs
@@ -481,6 +497,15 @@ int FPathBuilder::insertReachSpec(INT *SpecArray, FReachSpec &Spec)
 	unguard;
 }
 
+/* whether insertReachSpec could place a spec of at least minDistance in the array.
+*/
+int FPathBuilder::canInsertReachSpec(INT *SpecArray, INT minDistance)
+{
+	guard(FPathBuilder::canInsertReachSpec);
+	return ( (SpecArray[15] == -1) || (Level->ReachSpecs(SpecArray[0]).distance > minDistance) );
+	unguard;
+}
+
 /* add reachspecs to path for every path reachable from it. Also add the reachspec to that
 paths upstreamPath list
 */
@@ -575,12 +600,19 @@ void FPathBuilder::addReachSpecs(AActor *start)
 		}
 	}
 
-	for (INT i=0; i<Level->Num(); i++)
+	for (INT i=0; i<NavPoints.Num(); i++)
 	{
-		AActor *Actor = Level->Actors(i); 
-		if (Actor && Actor->IsA(ANavigationPoint::StaticClass) && !Actor->IsA(ALiftCenter::StaticClass) 
-				&& (Actor != node) && ((node->Location - Actor->Location).SizeSquared() < 1000000) )
+		ANavigationPoint *Actor = NavPoints(i); 
+		FLOAT distSquared = (node->Location - Actor->Location).SizeSquared();
+		if ( (distSquared < 1000000) && (Actor != node) && !Actor->IsA(ALiftCenter::StaticClass) )
 		{
+			// a full path list can't take a spec longer than all of its own
+			if ( !canInsertReachSpec(node->Paths, (int)appSqrt(distSquared)) )
+			{
+				numSkipped++;
+				continue;
+			}
+			numTested++;
 			newSpec.Init();
 			if (newSpec.defineFor(node, Actor, Scout))
 			{
@@ -54,6 +54,125 @@ public:
 
 };
 
+//
+// Search state for one navigation point.
+//
+struct FPathSearchNode
+{
+	ANavigationPoint*	Nav;
+	INT					Weight;		// Best path weight found so far.
+	INT					Heuristic;	// Lower bound on the remaining weight.
+	INT					HeapIndex;	// Position in the open heap, or INDEX_NONE.
+	ANavigationPoint*	StartPath;	// First node of the path, for inventory searches.
+};
+
+//
+// Scratch state for one navigation search: the nodes it has touched and a
+// binary heap of open nodes ordered by Weight+Heuristic.  Everything lives
+// on a memory stack, so nothing is written to the navigation points until
+// Publish.
+//
+class FPathSearch
+{
+public:
+	FPathSearch( FMemStack& InMem );
+	FPathSearchNode* Find( ANavigationPoint* Nav );
+	void Open( FPathSearchNode* Node );
+	FPathSearchNode* Pop();
+	void Publish();
+
+private:
+	FMemStack&			Mem;
+	FPathSearchNode*	Nodes;
+	INT					NumNodes, MaxNodes;
+	INT*				Hash;
+	INT					HashMask;
+	INT*				Heap;
+	INT					NumHeap;
+
+	void Grow();
+	void SiftUp( INT i );
+	void SiftDown( INT i );
+	INT Estimate( INT i ) {return Nodes[Heap[i]].Weight + Nodes[Heap[i]].Heuristic;}
+};
+
+//
+// A reach spec as stored in the navigation graph.
+//
+struct FNavEdge
+{
+	INT		Node;		// Index of the node at the other end.
+	INT		Distance;	// Reach spec distance.
+	INT		Bucket;		// Index of the spec's requirements in Buckets.
+};
+
+//
+// Collision size and move flags required by a group of reach specs.
+//
+struct FNavBucket
+{
+	INT		CollisionRadius;
+	INT		CollisionHeight;
+	INT		reachFlags;
+};
+
+//
+// Shortest distance and next node towards one goal, from every node.
+//
+struct FNavRoute
+{
+	INT		Goal;		// Goal node, or INDEX_NONE if unused.
+	QWORD	Mask;		// Buckets usable on this route.
+	UBOOL	bPlayer;	// Whether player only nodes may be passed through.
+	DWORD	LastUsed;	// For replacing the least recently used route.
+	INT*	Dist;		// Distance to the goal, or UNREACHABLE.
+	INT*	NextHop;	// Next node towards the goal, or INDEX_NONE.
+};
+
+//
+// The navigation network flattened into compressed adjacency arrays, in
+// NavigationPointList order.  Reach specs are bucketed by their collision
+// size and move flags, so a pawn's requirements become one bit mask per
+// query instead of a supports() test per spec.  Routes to recently used
+// goals are kept, making repeated searches a table lookup.
+//
+class FNavGraph
+{
+public:
+	enum {MAX_BUCKETS=64};
+	enum {UNREACHABLE=MAXINT};
+
+	// Variables.
+	TArray<ANavigationPoint*>	Nodes;
+	TArray<INT>					UpStart;	// First upstream edge of each node, plus one past the end.
+	TArray<FNavEdge>			UpEdges;	// Specs leading into each node.
+	TArray<INT>					DownStart;	// First downstream edge of each node, plus one past the end.
+	TArray<FNavEdge>			DownEdges;	// Specs leading out of each node.
+	TArray<FNavBucket>			Buckets;
+	INT							NumSpecs;	// Level reach specs when built.
+	FLOAT						HeuristicScale;	// Lower bound on path weight per unit of distance.
+	INT							RouteHits, RouteMisses;
+
+	// Constructor/destructor.
+	FNavGraph( ULevel* Level );
+	~FNavGraph();
+
+	// FNavGraph interface.
+	UBOOL IsCurrent( ULevel* Level );
+	INT FindNode( ANavigationPoint* Nav );
+	QWORD GetMask( INT iRadius, INT iHeight, INT moveFlags );
+	FNavRoute* GetRoute( INT Goal, QWORD Mask, UBOOL bPlayer );
+
+private:
+	INT*		NodeHash;
+	INT			NodeHashMask;
+	FNavRoute*	Routes;
+	INT			NumRoutes;
+	DWORD		RouteClock;
+
+	void BuildRoute( FNavRoute* Route );
+};
+
 class FPathMarker
 {
 public:
@@ -110,6 +229,8 @@ private:
 	INT	numMarkers;
 	FLOAT humanRadius;
 	int optlevel;
+	TArray<ANavigationPoint*> NavPoints;	// Navigation points in level order, for addReachSpecs.
+	INT numTested, numSkipped;
 
 	int Prune(AActor *Node);
 	void CheckDoor(AActor *Node);
@@ -144,4 +265,5 @@ private:
 	void nearestThirtyAngle (FVector &currentDirection);
 	void addReachSpecs(AActor * start);
 	int insertReachSpec(INT *SpecArray, FReachSpec &Spec);
+	int canInsertReachSpec(INT *SpecArray, INT minDistance);
 };
@@ -688,130 +688,629 @@ int APawn::TraverseFrom(AActor *start, int moveFlags)
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	FPathSearch.
+-----------------------------------------------------------------------------*/
+
+#define UNVISITED_WEIGHT 10000000 // As set by clearPath.
+
+FPathSearch::FPathSearch( FMemStack& InMem )
+:	Mem			( InMem )
+,	Nodes		( NULL )
+,	NumNodes	( 0 )
+,	MaxNodes	( 0 )
+,	Hash		( NULL )
+,	HashMask	( 0 )
+,	Heap		( NULL )
+,	NumHeap		( 0 )
+{
+	Grow();
+}
+
+//
+// Double the room for nodes and rebuild the hash, which is kept at most
+// half full.  The old arrays are left on the memory stack.
+//
+void FPathSearch::Grow()
+{
+	guard(FPathSearch::Grow);
+	MaxNodes = MaxNodes ? MaxNodes*2 : 128;
+	FPathSearchNode* NewNodes = New<FPathSearchNode>( Mem, MaxNodes );
+	INT*             NewHeap  = New<INT>( Mem, MaxNodes );
+	if( NumNodes )
+	{
+		appMemcpy( NewNodes, Nodes, NumNodes*sizeof(FPathSearchNode) );
+		appMemcpy( NewHeap,  Heap,  NumHeap *sizeof(INT) );
+	}
+	Nodes    = NewNodes;
+	Heap     = NewHeap;
+	HashMask = MaxNodes*2 - 1;
+	Hash     = New<INT>( Mem, HashMask+1 );
+	for( INT i=0; i<=HashMask; i++ )
+		Hash[i] = INDEX_NONE;
+	for( INT i=0; i<NumNodes; i++ )
+	{
+		INT j;
+		for( j=((size_t)Nodes[i].Nav>>4) & HashMask; Hash[j]!=INDEX_NONE; j=(j+1) & HashMask );
+		Hash[j] = i;
+	}
+	unguard;
+}
+
+//
+// Find the search state of a navigation point, adding it unvisited if
+// this search hasn't touched it yet.
+//
+FPathSearchNode* FPathSearch::Find( ANavigationPoint* Nav )
+{
+	guardSlow(FPathSearch::Find);
+	INT j;
+	for( j=((size_t)Nav>>4) & HashMask; Hash[j]!=INDEX_NONE; j=(j+1) & HashMask )
+		if( Nodes[Hash[j]].Nav==Nav )
+			return &Nodes[Hash[j]];
+	if( NumNodes==MaxNodes )
+	{
+		Grow();
+		for( j=((size_t)Nav>>4) & HashMask; Hash[j]!=INDEX_NONE; j=(j+1) & HashMask );
+	}
+	FPathSearchNode* Node = &Nodes[NumNodes];
+	Node->Nav       = Nav;
+	Node->Weight    = UNVISITED_WEIGHT;
+	Node->Heuristic = 0;
+	Node->HeapIndex = INDEX_NONE;
+	Node->StartPath = NULL;
+	Hash[j] = NumNodes++;
+	return Node;
+	unguardSlow;
+}
+
+//
+// Add a node to the open heap, or move it up after its weight dropped.
+//
+void FPathSearch::Open( FPathSearchNode* Node )
+{
+	guardSlow(FPathSearch::Open);
+	if( Node->HeapIndex==INDEX_NONE )
+	{
+		Node->HeapIndex = NumHeap;
+		Heap[NumHeap++] = Node - Nodes;
+	}
+	SiftUp( Node->HeapIndex );
+	unguardSlow;
+}
+
+//
+// Remove and return the open node with the lowest estimate, or NULL.
+//
+FPathSearchNode* FPathSearch::Pop()
+{
+	guardSlow(FPathSearch::Pop);
+	if( !NumHeap )
+		return NULL;
+	FPathSearchNode* Result = &Nodes[Heap[0]];
+	Result->HeapIndex = INDEX_NONE;
+	if( --NumHeap )
+	{
+		Heap[0] = Heap[NumHeap];
+		Nodes[Heap[0]].HeapIndex = 0;
+		SiftDown( 0 );
+	}
+	return Result;
+	unguardSlow;
+}
+
+void FPathSearch::SiftUp( INT i )
+{
+	while( i>0 && Estimate((i-1)/2) > Estimate(i) )
+	{
+		INT Parent = (i-1)/2;
+		Exchange( Heap[i], Heap[Parent] );
+		Nodes[Heap[i]].HeapIndex      = i;
+		Nodes[Heap[Parent]].HeapIndex = Parent;
+		i = Parent;
+	}
+}
+
+void FPathSearch::SiftDown( INT i )
+{
+	for( ; ; )
+	{
+		INT Best = i;
+		if( 2*i+1<NumHeap && Estimate(2*i+1)<Estimate(Best) )
+			Best = 2*i+1;
+		if( 2*i+2<NumHeap && Estimate(2*i+2)<Estimate(Best) )
+			Best = 2*i+2;
+		if( Best==i )
+			break;
+		Exchange( Heap[i], Heap[Best] );
+		Nodes[Heap[i]].HeapIndex    = i;
+		Nodes[Heap[Best]].HeapIndex = Best;
+		i = Best;
+	}
+}
+
+//
+// Copy the path weights found into visitedWeight, where findAltEndPoint
+// and script code expect them.
+//
+void FPathSearch::Publish()
+{
+	guard(FPathSearch::Publish);
+	for( INT i=0; i<NumNodes; i++ )
+		Nodes[i].Nav->visitedWeight = Nodes[i].Weight;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FNavGraph.
+-----------------------------------------------------------------------------*/
+
+//
+// Add a node's reach specs to one direction of the graph, bucketing them
+// by their requirements.
+//
+static void AddNavEdges( FNavGraph* Graph, ULevel* Level, INT* Specs, UBOOL bUpstream, TArray<FNavEdge>& Edges )
+{
+	guard(AddNavEdges);
+	for( INT i=0; i<16 && Specs[i]!=-1; i++ )
+	{
+		FReachSpec& Spec = Level->ReachSpecs(Specs[i]);
+		INT iNode = Graph->FindNode( (ANavigationPoint*)(bUpstream ? Spec.Start : Spec.End) );
+		if( iNode==INDEX_NONE )
+			continue;
+		INT iBucket;
+		for( iBucket=0; iBucket<Graph->Buckets.Num(); iBucket++ )
+		{
+			FNavBucket& Bucket = Graph->Buckets(iBucket);
+			if
+			(	Bucket.CollisionRadius==Spec.CollisionRadius
+			&&	Bucket.CollisionHeight==Spec.CollisionHeight
+			&&	Bucket.reachFlags     ==Spec.reachFlags )
+				break;
+		}
+		if( iBucket==Graph->Buckets.Num() )
+		{
+			FNavBucket* Bucket = new(Graph->Buckets)FNavBucket;
+			Bucket->CollisionRadius = Spec.CollisionRadius;
+			Bucket->CollisionHeight = Spec.CollisionHeight;
+			Bucket->reachFlags      = Spec.reachFlags;
+		}
+		FNavEdge* Edge = new(Edges)FNavEdge;
+		Edge->Node     = iNode;
+		Edge->Distance = Spec.distance;
+		Edge->Bucket   = iBucket;
+	}
+	unguard;
+}
+
+FNavGraph::FNavGraph( ULevel* Level )
+:	NumSpecs	( Level->ReachSpecs.Num() )
+,	HeuristicScale( 1.0 )
+,	RouteHits	( 0 )
+,	RouteMisses	( 0 )
+,	NodeHash	( NULL )
+,	NodeHashMask( 0 )
+,	Routes		( NULL )
+,	NumRoutes	( 0 )
+,	RouteClock	( 0 )
+{
+	guard(FNavGraph::FNavGraph);
+	ANavigationPoint* Nav;
+	for( Nav=Level->GetLevelInfo()->NavigationPointList; Nav; Nav=Nav->nextNavigationPoint )
+		Nodes.AddItem( Nav );
+
+	// Hash the nodes by address.
+	for( NodeHashMask=63; NodeHashMask<Nodes.Num()*2; NodeHashMask=NodeHashMask*2+1 );
+	NodeHash = (INT*)appMalloc( (NodeHashMask+1)*sizeof(INT), "NavGraphHash" );
+	INT i;
+	for( i=0; i<=NodeHashMask; i++ )
+		NodeHash[i] = INDEX_NONE;
+	for( i=0; i<Nodes.Num(); i++ )
+	{
+		INT j;
+		for( j=((size_t)Nodes(i)>>4) & NodeHashMask; NodeHash[j]!=INDEX_NONE; j=(j+1) & NodeHashMask );
+		NodeHash[j] = i;
+	}
+
+	// Flatten the reach specs in both directions.
+	for( i=0; i<Nodes.Num(); i++ )
+	{
+		UpStart.AddItem( UpEdges.Num() );
+		AddNavEdges( this, Level, Nodes(i)->upstreamPaths, 1, UpEdges );
+		DownStart.AddItem( DownEdges.Num() );
+		AddNavEdges( this, Level, Nodes(i)->Paths, 0, DownEdges );
+	}
+	UpStart.AddItem( UpEdges.Num() );
+	DownStart.AddItem( DownEdges.Num() );
+
+	// The scale which turns straight-line distance into a lower bound on
+	// path weight.  Teleporters and lifts have reach specs shorter than the
+	// distance they cover, so this is the smallest ratio of any spec.
+	for( i=0; i<NumSpecs; i++ )
+	{
+		FReachSpec& Spec = Level->ReachSpecs(i);
+		if( Spec.Start && Spec.End )
+		{
+			FLOAT Length = (Spec.End->Location - Spec.Start->Location).Size();
+			if( Length > 1.0 )
+				HeuristicScale = Min( HeuristicScale, ::Max(Spec.distance,0) / Length );
+		}
+	}
+
+	// Allocate the route cache.
+	if( Buckets.Num()<=MAX_BUCKETS && Nodes.Num() )
+	{
+		NumRoutes = 64;
+		GetConfigInt( "Engine.Engine", "RouteCacheSize", NumRoutes );
+		NumRoutes = Clamp( NumRoutes, 0, 1024 );
+	}
+	if( NumRoutes )
+	{
+		Routes = (FNavRoute*)appMalloc( NumRoutes*sizeof(FNavRoute), "NavRoutes" );
+		for( i=0; i<NumRoutes; i++ )
+		{
+			Routes[i].Goal     = INDEX_NONE;
+			Routes[i].LastUsed = 0;
+			Routes[i].Dist     = (INT*)appMalloc( Nodes.Num()*2*sizeof(INT), "NavRoute" );
+			Routes[i].NextHop  = Routes[i].Dist + Nodes.Num();
+		}
+	}
+	debugf( NAME_DevPath, "Navigation graph: %i nodes, %i edges, %i buckets, %i cached routes", Nodes.Num(), DownEdges.Num(), Buckets.Num(), NumRoutes );
+	unguard;
+}
+
+FNavGraph::~FNavGraph()
+{
+	guard(FNavGraph::~FNavGraph);
+	for( INT i=0; i<NumRoutes; i++ )
+		appFree( Routes[i].Dist );
+	if( Routes )
+		appFree( Routes );
+	appFree( NodeHash );
+	unguard;
+}
+
+//
+// Whether the graph still matches the level's paths.
+//
+UBOOL FNavGraph::IsCurrent( ULevel* Level )
+{
+	guardSlow(FNavGraph::IsCurrent);
+	ANavigationPoint* First = Level->GetLevelInfo()->NavigationPointList;
+	return NumSpecs==Level->ReachSpecs.Num() && (Nodes.Num() ? Nodes(0)==First : First==NULL);
+	unguardSlow;
+}
+
+//
+// Return the index of a navigation point, or INDEX_NONE.
+//
+INT FNavGraph::FindNode( ANavigationPoint* Nav )
+{
+	guardSlow(FNavGraph::FindNode);
+	for( INT j=((size_t)Nav>>4) & NodeHashMask; NodeHash[j]!=INDEX_NONE; j=(j+1) & NodeHashMask )
+		if( Nodes(NodeHash[j])==Nav )
+			return NodeHash[j];
+	return INDEX_NONE;
+	unguardSlow;
+}
+
+//
+// Return the buckets a pawn's requirements are supported by, as in
+// FReachSpec::supports.
+//
+QWORD FNavGraph::GetMask( INT iRadius, INT iHeight, INT moveFlags )
+{
+	guardSlow(FNavGraph::GetMask);
+	QWORD Mask = 0;
+	for( INT i=0; i<Buckets.Num() && i<MAX_BUCKETS; i++ )
+	{
+		FNavBucket& Bucket = Buckets(i);
+		if
+		(	Bucket.CollisionRadius>=iRadius
+		&&	Bucket.CollisionHeight>=iHeight
+		&&	(Bucket.reachFlags & moveFlags)==Bucket.reachFlags )
+			Mask |= (QWORD)1 << i;
+	}
+	return Mask;
+	unguardSlow;
+}
+
+//
+// Return the route to a goal, computing it over the least recently used
+// one if it isn't cached.  Returns NULL if routes can't be cached.
+//
+FNavRoute* FNavGraph::GetRoute( INT Goal, QWORD Mask, UBOOL bPlayer )
+{
+	guard(FNavGraph::GetRoute);
+	if( !NumRoutes )
+		return NULL;
+	FNavRoute* Oldest = &Routes[0];
+	for( INT i=0; i<NumRoutes; i++ )
+	{
+		FNavRoute* Route = &Routes[i];
+		if( Route->Goal==Goal && Route->Mask==Mask && Route->bPlayer==bPlayer )
+		{
+			Route->LastUsed = ++RouteClock;
+			RouteHits++;
+			return Route;
+		}
+		if( Route->LastUsed < Oldest->LastUsed )
+			Oldest = Route;
+	}
+	Oldest->Goal     = Goal;
+	Oldest->Mask     = Mask;
+	Oldest->bPlayer  = bPlayer;
+	Oldest->LastUsed = ++RouteClock;
+	BuildRoute( Oldest );
+	RouteMisses++;
+	return Oldest;
+	unguard;
+}
+
+//
+// Dijkstra search backwards from a route's goal over every node.  As in
+// breadthPathFrom, pawns which aren't players may end at a player only
+// node but not pass through one.
+//
+void FNavGraph::BuildRoute( FNavRoute* Route )
+{
+	guard(FNavGraph::BuildRoute);
+	INT i;
+	for( i=0; i<Nodes.Num(); i++ )
+	{
+		Route->Dist[i]    = UNREACHABLE;
+		Route->NextHop[i] = INDEX_NONE;
+	}
+
+	// Binary heap of (distance, node) with stale entries skipped on pop.
+	FMemMark Mark(GMem);
+	INT* Heap = New<INT>( GMem, (UpEdges.Num()+1)*2 );
+	INT NumHeap = 0;
+	Route->Dist[Route->Goal] = 0;
+	Heap[0] = 0;
+	Heap[1] = Route->Goal;
+	NumHeap = 1;
+	while( NumHeap )
+	{
+		INT Dist = Heap[0], iNode = Heap[1];
+		if( --NumHeap )
+		{
+			INT LastDist = Heap[NumHeap*2], LastNode = Heap[NumHeap*2+1];
+			INT j = 0;
+			for( ; ; )
+			{
+				INT Child = j*2+1;
+				if( Child>=NumHeap )
+					break;
+				if( Child+1<NumHeap && Heap[(Child+1)*2]<Heap[Child*2] )
+					Child++;
+				if( Heap[Child*2]>=LastDist )
+					break;
+				Heap[j*2]   = Heap[Child*2];
+				Heap[j*2+1] = Heap[Child*2+1];
+				j = Child;
+			}
+			Heap[j*2]   = LastDist;
+			Heap[j*2+1] = LastNode;
+		}
+		if( Dist>Route->Dist[iNode] )
+			continue;
+		if( iNode!=Route->Goal && Nodes(iNode)->bPlayerOnly && !Route->bPlayer )
+			continue;
+		for( INT e=UpStart(iNode); e<UpStart(iNode+1); e++ )
+		{
+			FNavEdge& Edge = UpEdges(e);
+			INT NewDist    = Dist + Edge.Distance;
+			if( (Route->Mask & ((QWORD)1<<Edge.Bucket)) && NewDist<Route->Dist[Edge.Node] )
+			{
+				Route->Dist[Edge.Node]    = NewDist;
+				Route->NextHop[Edge.Node] = iNode;
+				INT j = NumHeap++;
+				while( j>0 && Heap[((j-1)/2)*2]>NewDist )
+				{
+					Heap[j*2]   = Heap[((j-1)/2)*2];
+					Heap[j*2+1] = Heap[((j-1)/2)*2+1];
+					j = (j-1)/2;
+				}
+				Heap[j*2]   = NewDist;
+				Heap[j*2+1] = Edge.Node;
+			}
+		}
+	}
+	Mark.Pop();
+	unguard;
+}
+
+//
+// Return the level's navigation graph, building it if paths have changed.
+//
+static FNavGraph* GetNavGraph( ULevel* Level )
+{
+	guard(GetNavGraph);
+	if( Level->NavGraph && !Level->NavGraph->IsCurrent(Level) )
+	{
+		delete Level->NavGraph;
+		Level->NavGraph = NULL;
+	}
+	if( !Level->NavGraph )
+		Level->NavGraph = new FNavGraph( Level );
+	return Level->NavGraph;
+	unguard;
+}
+
+//
+// Answer breadthPathFrom from the route cache, leaving the same weights
+// behind.  Returns -1 if the route can't be cached or if the best route
+// passes through a node given a cost for this search, such as the
+// pawn's anchor, so the search must be run instead.
+//
+static INT CachedPathFrom( APawn* Pawn, ANavigationPoint* Goal, AActor*& bestPath, INT moveFlags )
+{
+	guard(CachedPathFrom);
+	FNavGraph* Graph = GetNavGraph( Pawn->GetLevel() );
+	INT iGoal = Graph->FindNode( Goal );
+	if( iGoal==INDEX_NONE || Graph->Buckets.Num()>FNavGraph::MAX_BUCKETS )
+		return -1;
+	QWORD Mask = Graph->GetMask( (INT)Pawn->CollisionRadius, (INT)Pawn->CollisionHeight, moveFlags );
+	FNavRoute* Route = Graph->GetRoute( iGoal, Mask, (moveFlags & R_PLAYERONLY)!=0 );
+	if( !Route )
+		return -1;
+
+	// Find the endpoint with the lowest weight counting only its own cost
+	// and path weight.  The nodes on the way can only add to that.
+	FMemMark Mark(GMem);
+	INT* Ends = New<INT>( GMem, Graph->Nodes.Num() );
+	INT NumEnds = 0;
+	INT Base = Goal->visitedWeight;
+	INT BestWeight = MAXINT, iBest = INDEX_NONE;
+	INT i;
+	if( Goal->bEndPoint )
+		iBest = iGoal;
+	else for( i=0; i<Graph->Nodes.Num(); i++ )
+	{
+		ANavigationPoint* Nav = Graph->Nodes(i);
+		if( Nav->bEndPoint && Route->Dist[i]!=FNavGraph::UNREACHABLE )
+		{
+			Ends[NumEnds++] = i;
+			INT Weight = Base + Route->Dist[i] + Nav->cost + Nav->bestPathWeight;
+			if( Weight < BestWeight )
+			{
+				BestWeight = Weight;
+				iBest      = i;
+			}
+		}
+	}
+	if( iBest==INDEX_NONE )
+	{
+		Mark.Pop();
+		return 0;
+	}
+
+	// The route only minimizes distance, so it's the search's answer only
+	// if no node on the way has a cost or is an endpoint the search would
+	// have stopped at.
+	for( i=Route->NextHop[iBest]; i!=INDEX_NONE && i!=iGoal; i=Route->NextHop[i] )
+	{
+		if( Graph->Nodes(i)->cost!=0 || Graph->Nodes(i)->bEndPoint )
+		{
+			Mark.Pop();
+			return -1;
+		}
+	}
+
+	// Leave the weights the search would have found on the path, and on
+	// the other endpoints, which findAltEndPoint compares.  Those count
+	// the costs and path weights of the nodes on their way.
+	for( i=iBest; i!=INDEX_NONE && i!=iGoal; i=Route->NextHop[i] )
+	{
+		ANavigationPoint* Nav = Graph->Nodes(i);
+		Nav->visitedWeight = Base + Route->Dist[i] + Nav->cost + Nav->bEndPoint * Nav->bestPathWeight;
+	}
+	for( INT j=0; j<NumEnds; j++ )
+	{
+		if( Ends[j]==iBest )
+			continue;
+		ANavigationPoint* Nav = Graph->Nodes(Ends[j]);
+		INT Weight = Base + Route->Dist[Ends[j]] + Nav->cost + Nav->bestPathWeight;
+		for( i=Route->NextHop[Ends[j]]; i!=INDEX_NONE && i!=iGoal; i=Route->NextHop[i] )
+			Weight += Graph->Nodes(i)->cost + Graph->Nodes(i)->bEndPoint * Graph->Nodes(i)->bestPathWeight;
+		Nav->visitedWeight = Weight;
+	}
+	Mark.Pop();
+	bestPath = Graph->Nodes(iBest);
+	return 1;
+	unguard;
+}
+
 /* breadthPathFrom()
-Breadth First Search through navigation network
-startnode is the starting path
+A* search backwards through the navigation network, from startnode (the
+destination) to the nearest endpoint the pawn can reach directly.
+The heuristic is the scaled distance to the nearest endpoint plus that
+endpoint's bestPathWeight, which never overestimates.
 */
 int APawn::breadthPathFrom(AActor *start, AActor *&bestPath, int bSinglePath, int moveFlags)
 {
 	guard(APawn::breadthPathFrom);
-	//FIXME - perhaps track and bound number of edges to search or max depth?
-	ANavigationPoint* currentnode = (ANavigationPoint *)start;
-	ANavigationPoint* nextnode;
-	ANavigationPoint* BinTree = currentnode;
-
+	ULevel* MyLevel = GetLevel();
 	int iRadius = (int)CollisionRadius;
 	int iHeight = (int)CollisionHeight;
-	int p = 0;
+
+	// Routes are cached without the step limit of single path searches.
+	if( !bSinglePath )
+	{
+		int cached = CachedPathFrom( this, (ANavigationPoint*)start, bestPath, moveFlags );
+		if( cached>=0 )
+			return cached;
+	}
+
+	// Gather the endpoints for the heuristic; with many of them it isn't worth it.
+	enum {MAX_HEURISTIC_ENDPOINTS=16};
+	ANavigationPoint* EndPoints[MAX_HEURISTIC_ENDPOINTS];
+	INT numEndPoints = 0;
+	FLOAT Scale = GetNavGraph( MyLevel )->HeuristicScale;
+	for( ANavigationPoint* Nav=MyLevel->GetLevelInfo()->NavigationPointList; Nav; Nav=Nav->nextNavigationPoint )
+	{
+		if( Nav->bEndPoint )
+		{
+			if( numEndPoints==MAX_HEURISTIC_ENDPOINTS )
+			{
+				Scale = 0.0;
+				break;
+			}
+			EndPoints[numEndPoints++] = Nav;
+		}
+	}
+
+	FMemMark Mark(GMem);
+	FPathSearch Search(GMem);
+	FPathSearchNode* StartNode = Search.Find( (ANavigationPoint*)start );
+	StartNode->Weight = ((ANavigationPoint*)start)->visitedWeight;
+	Search.Open( StartNode );
+
 	int n = 0;
-	int realSplit = 1;
-	FReachSpec *spec;
-	while ( currentnode )
+	int result = 0;
+	FPathSearchNode* Current;
+	while( (Current=Search.Pop())!=NULL )
 	{
+		ANavigationPoint* currentnode = Current->Nav;
 		if ( currentnode->bEndPoint )
 		{
 			bestPath = currentnode;
-			return 1;
+			result = 1;
+			break;
 		}
 		if ( (!currentnode->bPlayerOnly || bIsPlayer) || (currentnode == start) )
 		{
-			int i = 0;
-			while ( i<16 )
+			for( int i=0; i<16 && currentnode->upstreamPaths[i]!=-1; i++ )
 			{
-				if (currentnode->upstreamPaths[i] == -1)
-					i = 16;
-				else
+				FReachSpec* spec = &MyLevel->ReachSpecs(currentnode->upstreamPaths[i]);
+				if (spec->supports(iRadius, iHeight, moveFlags))
 				{
-					spec = &GetLevel()->ReachSpecs(currentnode->upstreamPaths[i]);
-					//debugf("check path from %s to %s with %d, %d",spec->Start->GetName(), spec->End->GetName(), spec->CollisionRadius, spec->CollisionHeight);
-					if (spec->supports(iRadius, iHeight, moveFlags))
+					ANavigationPoint* startnode = (ANavigationPoint* )spec->Start;
+					int newVisit = spec->distance + startnode->cost + Current->Weight + startnode->bEndPoint * startnode->bestPathWeight; 
+					FPathSearchNode* Next = Search.Find( startnode );
+					if ( Next->Weight > newVisit )
 					{
-						ANavigationPoint* startnode = (ANavigationPoint* )spec->Start;
-						int nextweight = spec->distance + startnode->cost;
-						int newVisit = nextweight + currentnode->visitedWeight + startnode->bEndPoint * startnode->bestPathWeight; 
-						//debugf("Path from %s to %s costs %d total %d", spec->Start->GetName(), spec->End->GetName(), nextweight, newVisit);
-						if ( startnode->visitedWeight > newVisit )
+						if( Next->Weight==UNVISITED_WEIGHT && !startnode->bEndPoint && Scale>0.0 )
 						{
-							if ( startnode->prevOrdered ) //remove from old position
-							{
-								startnode->prevOrdered->nextOrdered = startnode->nextOrdered;
-								if (startnode->nextOrdered)
-									startnode->nextOrdered->prevOrdered = startnode->prevOrdered;
-								if ( BinTree == startnode )
-								{
-									if ( startnode->prevOrdered->visitedWeight > newVisit )
-										BinTree = startnode->prevOrdered;
-								}
-								else if ( (startnode->visitedWeight > BinTree->visitedWeight)
-									&& (newVisit < BinTree->visitedWeight) )
-									realSplit--;	
-							}
-							else if ( newVisit > BinTree->visitedWeight )
-								realSplit++;
-							else
-								realSplit--;
-							//debugf("find spot for %s with BinTree = %s",startnode->GetName(), BinTree->GetName());
-							startnode->visitedWeight = newVisit;
-							if (  BinTree->visitedWeight < startnode->visitedWeight )
-								nextnode = BinTree;
-							else
-								nextnode = currentnode;
-							//debugf(" start at %s with %d to place %s with %d",nextnode->GetName(),nextnode->visitedWeight, startnode->GetName(), startnode->visitedWeight);
-							int numList = 0; //TEMP FIXME
-							while ( nextnode->nextOrdered && (nextnode->nextOrdered->visitedWeight < startnode->visitedWeight) )
-							{
-								numList++;
-								if ( numList > 500 )
-								{
-									//debugf("Breadth path list overflow");
-									return 0;
-								}
-								nextnode = nextnode->nextOrdered;
-							}
-							if (nextnode->nextOrdered != startnode)
-							{
-								if (nextnode->nextOrdered)
-									nextnode->nextOrdered->prevOrdered = startnode;
-								startnode->nextOrdered = nextnode->nextOrdered;
-								nextnode->nextOrdered = startnode;
-								startnode->prevOrdered = nextnode;
-							}
-							//if (startnode->nextOrdered)
-							//	debugf(" place %s after %s before %s ", startnode->GetName(), nextnode->GetName(), startnode->nextOrdered->GetName());
-							//else
-							//	debugf(" place %s after %s at end ", startnode->GetName(), nextnode->GetName());
+							FLOAT Best = UNVISITED_WEIGHT;
+							for( INT j=0; j<numEndPoints; j++ )
+								Best = Min( Best, Scale*(EndPoints[j]->Location - startnode->Location).Size() + EndPoints[j]->bestPathWeight );
+							Next->Heuristic = (INT)Best;
 						}
+						Next->Weight = newVisit;
+						Search.Open( Next );
 					}
-					i++;
 				}
 			}
-			realSplit++;
-			int move = (int)(0.5 * realSplit);
-			while ( p < move )
-			{
-				p++;
-				if (BinTree->nextOrdered)
-					BinTree = BinTree->nextOrdered;
-			}
 		}
 		n++;
 		if ( bSinglePath && ( n > 4) )
-			return 0;
-		if ( n > 1000 )
-		{
-			//debugf(NAME_DevPath,"2000 navigation nodes searched!");
-			return 0;
-		}
-		//debugf("Done with %s",currentnode->GetName());
-		currentnode = currentnode->nextOrdered;
-		//nextnode = currentnode;
-		//while (nextnode)
-		//{
-		//	debugf("Next %s",nextnode->GetName());
-		//	nextnode = nextnode->nextOrdered;
-		//}
+			break;
 	}
-	return 0;
+	Search.Publish();
+	Mark.Pop();
+	return result;
 	
 	unguard;
 }
@@ -871,8 +1370,23 @@ inline void FSortedPathList::removePath(int p)
 	unguard;
 }
 
+//
+// Offer a path from the current node of an inventory search.
+//
+static inline void RelaxInventoryPath( FPathSearch& Search, FPathSearchNode* Current, ANavigationPoint* endnode, INT distance )
+{
+	int newVisit = distance + endnode->cost + Current->Weight;
+	FPathSearchNode* Next = Search.Find( endnode );
+	if ( Next->Weight > newVisit )
+	{
+		Next->StartPath = Current->StartPath;
+		Next->Weight    = newVisit;
+		Search.Open( Next );
+	}
+}
+
 /* breadthPathToInventory()
-Breadth First Search through navigation network
+Dijkstra search through navigation network
 starting from path bot is on.
 When encounter inventoryspot, query its item's botdesireability
 keep track of best weight and the nextpath associated with it
@@ -880,132 +1394,76 @@ keep track of best weight and the nextpath associated with it
 FLOAT APawn::breadthPathToInventory(AActor *start, AActor *&bestPath, int moveFlags, FLOAT bestInventoryWeight, INT bPredictRespawns)
 {
 	guard(APawn::breadthPathToInventory);
-
-	ANavigationPoint* currentnode = (ANavigationPoint *)start;
-	ANavigationPoint* nextnode;
-	ANavigationPoint* BinTree = currentnode;
-
+	ULevel* MyLevel = GetLevel();
 	int iRadius = (int)CollisionRadius;
 	int iHeight = (int)CollisionHeight;
-	int p = 0;
-	int n = 0;
-	int realSplit = 1;
 
-	FReachSpec *spec;
-	while ( currentnode )
+	FNavGraph* Graph = GetNavGraph( MyLevel );
+	QWORD Mask = 0;
+	if( Graph->Buckets.Num() <= FNavGraph::MAX_BUCKETS )
+		Mask = Graph->GetMask( iRadius, iHeight, moveFlags );
+	else
+		Graph = NULL;
+
+	FMemMark Mark(GMem);
+	FPathSearch Search(GMem);
+	FPathSearchNode* StartNode = Search.Find( (ANavigationPoint*)start );
+	StartNode->Weight    = ((ANavigationPoint*)start)->visitedWeight;
+	StartNode->StartPath = ((ANavigationPoint*)start)->startPath;
+	Search.Open( StartNode );
+
+	int n = 0;
+	FPathSearchNode* Current;
+	while( (Current=Search.Pop())!=NULL )
 	{
-		//debugf(NAME_DevPath,"Distance to %s is %d", currentnode->GetName(), currentnode->visitedWeight);
+		ANavigationPoint* currentnode = Current->Nav;
 		if ( currentnode->bEndPoint )
-		{
-			//debugf("start path is %s",currentnode->GetName());
-			currentnode->startPath = currentnode;
-		}
+			Current->StartPath = currentnode;
 
 		if ( currentnode->IsA(AInventorySpot::StaticClass) )
 		{
 			AInventory* item = ((AInventorySpot *)currentnode)->markedItem;
 			if ( item && (item->IsProbing(NAME_Touch) || (bPredictRespawns && (item->LatentFloat < 5.0))) 
-					&& (item->MaxDesireability/currentnode->visitedWeight > bestInventoryWeight) )
+					&& (item->MaxDesireability/Current->Weight > bestInventoryWeight) )
 			{
-				FLOAT thisItemWeight = item->eventBotDesireability(this)/currentnode->visitedWeight;
-				//debugf(NAME_DevPath,"looking at %s with weight %f (dist %d) (and touch %d with latent %f)", item->GetName(), thisItemWeight, currentnode->visitedWeight, item->IsProbing(NAME_Touch), item->LatentFloat );
+				FLOAT thisItemWeight = item->eventBotDesireability(this)/Current->Weight;
 				if ( thisItemWeight > bestInventoryWeight )
 				{
 					bestInventoryWeight = thisItemWeight;
-					bestPath = currentnode->startPath;
+					bestPath = Current->StartPath;
 				}
 			} 
 		}
 
-			int i = 0;
-			while ( i<16 )
-			{
-				if (currentnode->Paths[i] == -1)
-					i = 16;
-				else
-				{
-					spec = &GetLevel()->ReachSpecs(currentnode->Paths[i]);
-					//debugf(NAME_DevPath,"check path from %s to %s with %f, %f",spec->Start->GetName(), spec->End->GetName(), spec->CollisionRadius, spec->CollisionHeight);
-					if (spec->supports(iRadius, iHeight, moveFlags))
-					{
-						ANavigationPoint* endnode = (ANavigationPoint* )spec->End;
-						int nextweight = spec->distance + endnode->cost;
-						int newVisit = nextweight + currentnode->visitedWeight; // + endnode->bEndPoint * endnode->bestPathWeight; 
-						//debugf(NAME_DevPath,"Path from %s to %s costs %d total %d", spec->Start->GetName(), spec->End->GetName(), nextweight, newVisit);
-						if ( endnode->visitedWeight > newVisit )
-						{
-							endnode->startPath = currentnode->startPath;
-							if ( endnode->prevOrdered ) //remove from old position
-							{
-								endnode->prevOrdered->nextOrdered = endnode->nextOrdered;
-								if (endnode->nextOrdered)
-									endnode->nextOrdered->prevOrdered = endnode->prevOrdered;
-								if ( BinTree == endnode )
-								{
-									if ( endnode->prevOrdered->visitedWeight > newVisit )
-										BinTree = endnode->prevOrdered;
-								}
-								else if ( (endnode->visitedWeight > BinTree->visitedWeight)
-									&& (newVisit < BinTree->visitedWeight) )
-									realSplit--;	
-							}
-							else if ( newVisit > BinTree->visitedWeight )
-								realSplit++;
-							else
-								realSplit--;
-							//debugf(NAME_DevPath,"find spot for %s with BinTree = %s",endnode->GetName(), BinTree->GetName());
-							endnode->visitedWeight = newVisit;
-							if (  BinTree->visitedWeight < endnode->visitedWeight )
-								nextnode = BinTree;
-							else
-								nextnode = currentnode;
-							//debugf(NAME_DevPath," start at %s with %d to place %s with %d",nextnode->GetName(),nextnode->visitedWeight, endnode->GetName(), endnode->visitedWeight);
-							int numList = 0; //TEMP FIXME
-							while ( nextnode->nextOrdered && (nextnode->nextOrdered->visitedWeight < endnode->visitedWeight) )
-							{
-								numList++;
-								if ( numList > 500 )
-								{
-									//debugf("Breadth path list %d", numList);
-									return 0;
-								}
-								nextnode = nextnode->nextOrdered;
-							}
-							if (nextnode->nextOrdered != endnode)
-							{
-								if (nextnode->nextOrdered)
-									nextnode->nextOrdered->prevOrdered = endnode;
-								endnode->nextOrdered = nextnode->nextOrdered;
-								nextnode->nextOrdered = endnode;
-								endnode->prevOrdered = nextnode;
-							}
-						}
-					}
-					i++;
-				}
-			}
-			realSplit++;
-			int move = (int)(0.5 * realSplit);
-			while ( p < move )
+		INT iNode = Graph ? Graph->FindNode( currentnode ) : INDEX_NONE;
+		if( iNode!=INDEX_NONE )
+		{
+			for( INT e=Graph->DownStart(iNode); e<Graph->DownStart(iNode+1); e++ )
 			{
-				p++;
-				if (BinTree->nextOrdered)
-					BinTree = BinTree->nextOrdered;
+				FNavEdge& Edge = Graph->DownEdges(e);
+				if( Mask & ((QWORD)1<<Edge.Bucket) )
+					RelaxInventoryPath( Search, Current, Graph->Nodes(Edge.Node), Edge.Distance );
 			}
+		}
+		else for( int i=0; i<16 && currentnode->Paths[i]!=-1; i++ )
+		{
+			FReachSpec* spec = &MyLevel->ReachSpecs(currentnode->Paths[i]);
+			if (spec->supports(iRadius, iHeight, moveFlags))
+				RelaxInventoryPath( Search, Current, (ANavigationPoint*)spec->End, spec->distance );
+		}
 
+		// Bound the number of desireability queries once an item is found.
 		n++;
 		if ( n > 250 )
 		{
 			if ( bestInventoryWeight > 0 )
-				return bestInventoryWeight;
+				break;
 			else
 				n = 200;
 		}
-
-		//}
-		//debugf(NAME_DevPath,"Done with %s",currentnode->GetName());
-		currentnode = currentnode->nextOrdered;
 	}
+	Search.Publish();
+	Mark.Pop();
 	return bestInventoryWeight;
 	
 	unguard;
@@ -68,6 +68,65 @@ void* ResolveThreadEntry( void* Arg )
 	return 0;
 }
 
+/*-----------------------------------------------------------------------------
+	Packet queues.
+-----------------------------------------------------------------------------*/
+
+//
+// A datagram passed between the network thread and the game thread.
+//
+struct FQueuedPacket
+{
+	DOUBLE		Time;		// When it was received or queued.
+	sockaddr_in	Addr;		// Source or destination address.
+	INT			Size;		// Size of data.
+	BYTE		Data[UNetConnection::MAX_PACKET_SIZE];
+};
+
+//
+// A fixed size ring of packets with exactly one producer thread and
+// one consumer thread, which need no lock between them.
+//
+class FPacketQueue
+{
+public:
+	enum {QUEUE_SIZE=1024};
+
+	// Constructor.
+	FPacketQueue()
+	:	Head( 0 )
+	,	Tail( 0 )
+	{}
+
+	// Producer interface: get the slot to fill, or NULL if full, then push it.
+	FQueuedPacket* GetPushSlot()
+	{
+		INT H = Head.load( std::memory_order_relaxed );
+		return ((H+1)&(QUEUE_SIZE-1))==Tail.load( std::memory_order_acquire ) ? NULL : &Packets[H];
+	}
+	void Push()
+	{
+		Head.store( (Head.load( std::memory_order_relaxed )+1)&(QUEUE_SIZE-1), std::memory_order_release );
+	}
+
+	// Consumer interface: get the oldest packet, or NULL if empty, then pop it.
+	FQueuedPacket* GetPopSlot()
+	{
+		INT T = Tail.load( std::memory_order_relaxed );
+		return T==Head.load( std::memory_order_acquire ) ? NULL : &Packets[T];
+	}
+	void Pop()
+	{
+		Tail.store( (Tail.load( std::memory_order_relaxed )+1)&(QUEUE_SIZE-1), std::memory_order_release );
+	}
+
+private:
+	// Variables.
+	std::atomic<INT> Head;
+	std::atomic<INT> Tail;
+	FQueuedPacket	 Packets[QUEUE_SIZE];
+};
+
 /*-----------------------------------------------------------------------------
 	UTcpNetDriver.
 -----------------------------------------------------------------------------*/
@@ -79,13 +138,50 @@ class DLL_EXPORT UTcpNetDriver : public UNetDriver
 {
 	DECLARE_CLASS(UTcpNetDriver,UNetDriver,CLASS_Transient|CLASS_Config)
 
+	// Constants.
+	enum {CONNECTION_HASH_SIZE=256}; // Buckets in the address to connection hash.
+	enum {IO_BATCH=32};              // Most datagrams moved by one batched call.
+
 	// Variables.
 	sockaddr_in	LocalAddr;
 	SOCKET		Socket;
 	in_addr		HostAddr;
 	char		HostName[256];
+	UBOOL		BatchRecv;
+	UBOOL		BatchSend;
+	UBOOL		ThreadedIO;
+	UTcpipConnection* ConnectionHash[CONNECTION_HASH_SIZE];
+
+	// Network thread, which owns the socket in threaded mode.
+	UTHREAD		NetThread;
+	FPacketQueue* InQueue;
+	FPacketQueue* OutQueue;
+	std::atomic<INT> NetThreadRunning;
+
+	// Outgoing packets waiting for a batched send.
+	INT			NumPending;
+	INT			PendingSize[IO_BATCH];
+	sockaddr_in	PendingAddr[IO_BATCH];
+	BYTE		PendingData[IO_BATCH][UNetConnection::MAX_PACKET_SIZE];
+
+	// Stats.
+	INT			StatTicks;
+	INT			StatRecvCalls;
+	INT			StatRecvPackets;
+	INT			StatSendCalls;
+	INT			StatSendPackets;
+	DWORD		StatRecvCycles;
+	DWORD		RecvCycles;
+	INT			StatOutOverflow;
+	DOUBLE		StatQueueDelay;
+
+	// Stats kept by the network thread, added to the above when reported.
+	std::atomic<INT> NetRecvCalls;
+	std::atomic<INT> NetSendCalls;
+	std::atomic<INT> NetInStalls;
 
 	// Constructor.
+	static void InternalClassInitializer( UClass* Class );
 
 	// UObject interface.
 	void Destroy();
@@ -93,6 +189,7 @@ class DLL_EXPORT UTcpNetDriver : public UNetDriver
 	// UNetDriver interface.
 	UBOOL Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& ConnectURL, char* Error256 );
 	void Tick();
+	void TickFlush();
 	UBOOL IsInternet() {return 1;}
 
 	// FExec interface.
@@ -100,9 +197,48 @@ class DLL_EXPORT UTcpNetDriver : public UNetDriver
 
 	// UTcpNetDriver interface.
 	UTcpipConnection* GetServerConnection() {return (UTcpipConnection*)ServerConnection;}
+	UTcpipConnection* FindConnection( sockaddr_in& Addr );
+	void HashConnection( UTcpipConnection* Connection );
+	void UnhashConnection( UTcpipConnection* Connection );
+	void ReceivedPacket( sockaddr_in& FromAddr, BYTE* Data, INT Size, DOUBLE ReceiveTime );
+	UBOOL SendPacket( sockaddr_in& Addr, BYTE* Data, INT Num );
+	void FlushPackets();
+	void StartNetThread();
+	void StopNetThread();
+	void NetThreadMain();
+	static INT GetAddrHash( sockaddr_in& Addr )
+	{
+		DWORD Ip;
+		IpGetInt( Addr.sin_addr, Ip );
+		Ip ^= Addr.sin_port;
+		return (Ip ^ (Ip>>8) ^ (Ip>>16) ^ (Ip>>24)) & (CONNECTION_HASH_SIZE-1);
+	}
 };
 IMPLEMENT_CLASS(UTcpNetDriver);
 
+void UTcpNetDriver::InternalClassInitializer( UClass* Class )
+{
+	guard(UTcpNetDriver::InternalClassInitializer);
+	if( Class==UTcpNetDriver::StaticClass )
+	{
+		new(Class,"ThreadedIO",RF_Public)UBoolProperty( CPP_PROPERTY(ThreadedIO), "Client", CPF_Config );
+	}
+	unguard;
+}
+
+//
+// Network thread entry point.
+//
+#ifdef PLATFORM_WIN32
+DWORD __stdcall NetThreadEntry( void* Arg )
+#else
+void* NetThreadEntry( void* Arg )
+#endif
+{
+	((UTcpNetDriver*)Arg)->NetThreadMain();
+	return 0;
+}
+
 /*-----------------------------------------------------------------------------
 	UTcpipConnection.
 -----------------------------------------------------------------------------*/
@@ -120,6 +256,7 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 	UBOOL			OpenedLocally;
 	char            LastStatusText[256];
 	FResolveInfo*	ResolveInfo;
+	UTcpipConnection* HashNext;
 
 	// Latent queue.
 	struct FLatentQueue
@@ -171,6 +308,8 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 			Channels[0]->Close();
 			FlushNet();
 		}
+		if( !OpenedLocally )
+			GetDriver()->UnhashConnection( this );
 		Super::Destroy();
 		unguard;
 	}
@@ -188,7 +327,7 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 		{
 			if( Driver->Time - (*Q)->Time > SimLatency/1000.0 )
 			{
-				sendto( GetDriver()->Socket, (char*)(*Q)->Data, (*Q)->Num, 0, (sockaddr*)&RemoteAddr, sizeof(RemoteAddr) );
+				GetDriver()->SendPacket( RemoteAddr, (*Q)->Data, (*Q)->Num );
 				FLatentQueue* Next = (*Q)->Next;
 				delete *Q;
 				*Q = Next;
@@ -249,14 +388,14 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 				// Send now.
 				if(	!SimPacketLoss || 100*appFrand()>SimPacketLoss )
 				{
-					if( sendto( GetDriver()->Socket, (char*)OutData, OutNum, 0, (sockaddr*)&RemoteAddr, sizeof(RemoteAddr) )!=OutNum )
+					if( !GetDriver()->SendPacket( RemoteAddr, OutData, OutNum ) )
 						debugf( NAME_DevNet, "Failed to send UDP packet" );
 				}
 				if( Duplicate )
 				{
 					// Send a copy in case packets were lost.
 					if(	!SimPacketLoss || 100*appFrand()>SimPacketLoss )
-						sendto( GetDriver()->Socket, (char*)OutData, OutNum, 0, (sockaddr*)&RemoteAddr, sizeof(RemoteAddr) );
+						GetDriver()->SendPacket( RemoteAddr, OutData, OutNum );
 					QueuedBytes += OutNum + UDP_HEADER_SIZE;
 				}
 			}
@@ -422,6 +561,14 @@ UBOOL UTcpNetDriver::Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& URL, c
 		return 0;
 	}
 
+	// Servers move datagrams in batches where the platform allows it.  Sends are
+	// only batched on servers, where all clients are flushed during the tick.
+	BatchRecv  = SOCKETS_HAVE_MMSG && !Connect;
+	BatchSend  = SOCKETS_HAVE_MMSG && !Connect;
+	NumPending = 0;
+	for( INT i=0; i<CONNECTION_HASH_SIZE; i++ )
+		ConnectionHash[i] = NULL;
+
 	// Connect to remote.
 	if( Connect )
 	{
@@ -475,6 +622,10 @@ UBOOL UTcpNetDriver::Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& URL, c
 	// Init server's connection list.
 	Connections.Empty();
 
+	// Hand the socket to the network thread, if desired.
+	if( ThreadedIO )
+		StartNetThread();
+
 	// Success: link into the linked list of drivers.
 	GDrivers.AddItem( this );
 
@@ -515,6 +666,10 @@ void UTcpNetDriver::Destroy()
 	// Remove from linked list of drivers.
 	GDrivers.RemoveItem( this );
 
+	// Send anything the connections left behind.
+	FlushPackets();
+	StopNetThread();
+
 	// Close the socket.
 	guard(CloseSocket);
 	if( Socket )
@@ -531,6 +686,193 @@ void UTcpNetDriver::Destroy()
 	UTcpNetDriver polling.
 -----------------------------------------------------------------------------*/
 
+//
+// Find the client connection with a remote address, or NULL if none.
+//
+UTcpipConnection* UTcpNetDriver::FindConnection( sockaddr_in& Addr )
+{
+	guardSlow(UTcpNetDriver::FindConnection);
+	for( UTcpipConnection* Connection=ConnectionHash[GetAddrHash(Addr)]; Connection; Connection=Connection->HashNext )
+		if( IpMatches( Connection->RemoteAddr, Addr ) )
+			return Connection;
+	return NULL;
+	unguardSlow;
+}
+
+//
+// Add a client connection to the address hash.
+//
+void UTcpNetDriver::HashConnection( UTcpipConnection* Connection )
+{
+	guard(UTcpNetDriver::HashConnection);
+	INT iHash = GetAddrHash( Connection->RemoteAddr );
+	Connection->HashNext = ConnectionHash[iHash];
+	ConnectionHash[iHash] = Connection;
+	unguard;
+}
+
+//
+// Remove a client connection from the address hash.
+//
+void UTcpNetDriver::UnhashConnection( UTcpipConnection* Connection )
+{
+	guard(UTcpNetDriver::UnhashConnection);
+	for( UTcpipConnection** Link=&ConnectionHash[GetAddrHash(Connection->RemoteAddr)]; *Link; Link=&(*Link)->HashNext )
+	{
+		if( *Link==Connection )
+		{
+			*Link = Connection->HashNext;
+			break;
+		}
+	}
+	Connection->HashNext = NULL;
+	unguard;
+}
+
+//
+// Forward an incoming packet to the connection it came from, creating
+// a new connection if the server accepts it.
+//
+void UTcpNetDriver::ReceivedPacket( sockaddr_in& FromAddr, BYTE* Data, INT Size, DOUBLE ReceiveTime )
+{
+	guard(UTcpNetDriver::ReceivedPacket);
+
+	// Figure out which socket it came from.
+	UTcpipConnection* Connection=NULL;
+	if( GetServerConnection() && IpMatches(GetServerConnection()->RemoteAddr,FromAddr) )
+		Connection = GetServerConnection();
+	else
+		Connection = FindConnection( FromAddr );
+
+	// If we didn't find a connection, maybe create a new one.		
+	if( Connection==NULL )
+	{
+		// Notify the server that the connection was created.
+		if( Notify->NotifyAcceptingConnection()!=ACCEPTC_Accept )
+			return;
+
+		// Create connection.
+		Connection = new UTcpipConnection( this, FromAddr, USOCK_Open, 0 );
+		char Temp[256];
+		appSprintf
+		(
+			Temp,
+			"%i.%i.%i.%i",
+			IPBYTE(FromAddr.sin_addr, 1),
+			IPBYTE(FromAddr.sin_addr, 2),
+			IPBYTE(FromAddr.sin_addr, 3),
+			IPBYTE(FromAddr.sin_addr, 4)
+		);
+		Connection->URL.Host = Temp;//!!format
+		Notify->NotifyAcceptedConnection( Connection );
+		Connections.AddItem( Connection );
+		HashConnection( Connection );
+	}
+
+	// Send the packet to the connection for processing.
+	//warning: ReceivedPacket may destroy Connection.
+	debugfSlow( NAME_DevNetTraffic, "%03i: Received %i", (INT)(appSeconds()*1000)%1000, Size );
+	Connection->LastReceiveTime = ReceiveTime;
+	Connection->ReceivedPacket( Data, Size );
+	unguard;
+}
+
+//
+// Send a packet, or queue it for the next batched send.
+// Returns whether it was sent or queued successfully.
+//
+UBOOL UTcpNetDriver::SendPacket( sockaddr_in& Addr, BYTE* Data, INT Num )
+{
+	guard(UTcpNetDriver::SendPacket);
+	check(Num<=UNetConnection::MAX_PACKET_SIZE);
+	if( NetThread )
+	{
+		// Pass it to the network thread.  If its queue is full, wait for it to
+		// free a slot rather than sending here, so the network thread stays the
+		// only sender and packets go out in the order they were queued.
+		FQueuedPacket* Packet = OutQueue->GetPushSlot();
+		if( !Packet )
+		{
+			StatOutOverflow++;
+			while( (Packet=OutQueue->GetPushSlot())==NULL )
+				appSleep( 0.0001f );
+		}
+		Packet->Time = Time;
+		Packet->Addr = Addr;
+		Packet->Size = Num;
+		appMemcpy( Packet->Data, Data, Num );
+		OutQueue->Push();
+		return 1;
+	}
+	else if( BatchSend )
+	{
+		if( NumPending==IO_BATCH )
+			FlushPackets();
+		PendingAddr[NumPending] = Addr;
+		PendingSize[NumPending] = Num;
+		appMemcpy( PendingData[NumPending], Data, Num );
+		NumPending++;
+		return 1;
+	}
+	StatSendCalls++;
+	StatSendPackets++;
+	return sendto( Socket, (char*)Data, Num, 0, (sockaddr*)&Addr, sizeof(Addr) )==Num;
+	unguard;
+}
+
+//
+// Send all queued packets.
+//
+void UTcpNetDriver::FlushPackets()
+{
+	guard(UTcpNetDriver::FlushPackets);
+	INT Sent=0;
+#if SOCKETS_HAVE_MMSG
+	if( NumPending>1 )
+	{
+		mmsghdr Msgs[IO_BATCH];
+		iovec   Iovs[IO_BATCH];
+		appMemset( Msgs, 0, NumPending*sizeof(Msgs[0]) );
+		for( INT i=0; i<NumPending; i++ )
+		{
+			Iovs[i].iov_base          = PendingData[i];
+			Iovs[i].iov_len           = PendingSize[i];
+			Msgs[i].msg_hdr.msg_name    = &PendingAddr[i];
+			Msgs[i].msg_hdr.msg_namelen = sizeof(PendingAddr[i]);
+			Msgs[i].msg_hdr.msg_iov     = &Iovs[i];
+			Msgs[i].msg_hdr.msg_iovlen  = 1;
+		}
+		while( Sent<NumPending )
+		{
+			INT Count = sendmmsg( Socket, Msgs+Sent, NumPending-Sent, 0 );
+			if( Count<=0 )
+			{
+				if( Count<0 && errno==ENOSYS )
+				{
+					// Not supported by this kernel, so stop batching.
+					debugf( NAME_Log, "WinSock: sendmmsg unavailable, sending unbatched" );
+					BatchSend = 0;
+				}
+				break;
+			}
+			StatSendCalls++;
+			StatSendPackets += Count;
+			Sent += Count;
+		}
+	}
+#endif
+	for( INT i=Sent; i<NumPending; i++ )
+	{
+		// Send the remainder one at a time.
+		StatSendCalls++;
+		StatSendPackets++;
+		if( sendto( Socket, (char*)PendingData[i], PendingSize[i], 0, (sockaddr*)&PendingAddr[i], sizeof(PendingAddr[i]) )!=PendingSize[i] )
+			debugf( NAME_DevNet, "Failed to send UDP packet" );
+	}
+	NumPending = 0;
+	unguard;
+}
+
 //
 // Poll the driver and forward all incoming packets to their appropriate sockets.
 // Update all socket states.
@@ -541,80 +883,235 @@ void UTcpNetDriver::Tick()
 
 	// Get new time.
 	Time = appSeconds();
+	StatTicks++;
+	RecvCycles = 0;
+	uclock(RecvCycles);
 
 	// Process all incoming packets.
-	BYTE Data[UNetConnection::MAX_PACKET_SIZE];
-	sockaddr_in FromAddr;
-	INT Count=0;
-	while( 1 )
+	if( NetThread )
 	{
-		// Get data, if any.
-		socklen_t FromSize = sizeof(FromAddr);
-		INT Size = recvfrom( Socket, (char*)Data, sizeof(Data), 0, (sockaddr*)&FromAddr, &FromSize );
-
-		// Handle result.
-		if( Size==SOCKET_ERROR && WSAGetLastError()==WSAEWOULDBLOCK )
+		// Drain the packets received by the network thread.
+		for( FQueuedPacket* Packet=InQueue->GetPopSlot(); Packet; Packet=InQueue->GetPopSlot() )
 		{
-			break;
+			StatQueueDelay += Time - Packet->Time;
+			StatRecvPackets++;
+			ReceivedPacket( Packet->Addr, Packet->Data, Packet->Size, Packet->Time );
+			InQueue->Pop();
 		}
-		else if( Size==SOCKET_ERROR )
+	}
+	else
+	{
+#if SOCKETS_HAVE_MMSG
+		while( BatchRecv )
 		{
-			static UBOOL FirstError=1;
-			if( FirstError )
-				debugf( "UDP recvfrom error: %s", SocketError() );
-			FirstError=0;
+			// Get a batch of datagrams, if any.
+			BYTE        Data[IO_BATCH][UNetConnection::MAX_PACKET_SIZE];
+			sockaddr_in FromAddrs[IO_BATCH];
+			mmsghdr     Msgs[IO_BATCH];
+			iovec       Iovs[IO_BATCH];
+			appMemset( Msgs, 0, sizeof(Msgs) );
+			for( INT i=0; i<IO_BATCH; i++ )
+			{
+				Iovs[i].iov_base            = Data[i];
+				Iovs[i].iov_len             = sizeof(Data[i]);
+				Msgs[i].msg_hdr.msg_name    = &FromAddrs[i];
+				Msgs[i].msg_hdr.msg_namelen = sizeof(FromAddrs[i]);
+				Msgs[i].msg_hdr.msg_iov     = &Iovs[i];
+				Msgs[i].msg_hdr.msg_iovlen  = 1;
+			}
+			INT Count = recvmmsg( Socket, Msgs, IO_BATCH, 0, NULL );
+
+			// Handle result.
+			if( Count==SOCKET_ERROR && errno==ENOSYS )
+			{
+				// Not supported by this kernel, so fall back to recvfrom.
+				debugf( NAME_Log, "WinSock: recvmmsg unavailable, receiving unbatched" );
+				BatchRecv = 0;
+				break;
+			}
+			else if( Count==SOCKET_ERROR && WSAGetLastError()==WSAEWOULDBLOCK )
+			{
+				break;
+			}
+			else if( Count==SOCKET_ERROR )
+			{
+				static UBOOL FirstError=1;
+				if( FirstError )
+					debugf( "UDP recvmmsg error: %s", SocketError() );
+				FirstError=0;
+				break;
+			}
+			StatRecvCalls++;
+			StatRecvPackets += Count;
+
+			// Forward the packets.
+			for( INT i=0; i<Count; i++ )
+				ReceivedPacket( FromAddrs[i], Data[i], Msgs[i].msg_len, Time );
+			if( Count<IO_BATCH )
+				break;
 		}
-		Count++;
-
-		// Figure out which socket it came from.
-		UTcpipConnection* Connection=NULL;
-		if( GetServerConnection() && IpMatches(GetServerConnection()->RemoteAddr,FromAddr) )
-			Connection = GetServerConnection();
-		for( INT i=0; i<Connections.Num() && !Connection; i++ )
-			if( IpMatches( ((UTcpipConnection*)Connections(i))->RemoteAddr, FromAddr ) )
-				Connection = (UTcpipConnection*)Connections(i);
-
-		// If we didn't find a connection, maybe create a new one.		
-		if( Connection==NULL )
+		if( !BatchRecv )
+#endif
 		{
-			// Notify the server that the connection was created.
-			if( Notify->NotifyAcceptingConnection()!=ACCEPTC_Accept )
-				continue;
+			BYTE Data[UNetConnection::MAX_PACKET_SIZE];
+			sockaddr_in FromAddr;
+			while( 1 )
+			{
+				// Get data, if any.
+				socklen_t FromSize = sizeof(FromAddr);
+				INT Size = recvfrom( Socket, (char*)Data, sizeof(Data), 0, (sockaddr*)&FromAddr, &FromSize );
 
-			// Create connection.
-			Connection = new UTcpipConnection( this, FromAddr, USOCK_Open, 0 );
-			char Temp[256];
-			appSprintf
-			(
-				Temp,
-				"%i.%i.%i.%i",
-				IPBYTE(FromAddr.sin_addr, 1),
-				IPBYTE(FromAddr.sin_addr, 2),
-				IPBYTE(FromAddr.sin_addr, 3),
-				IPBYTE(FromAddr.sin_addr, 4)
-			);
-			Connection->URL.Host = Temp;//!!format
-			Notify->NotifyAcceptedConnection( Connection );
-			Connections.AddItem( Connection );
+				// Handle result.
+				if( Size==SOCKET_ERROR && WSAGetLastError()==WSAEWOULDBLOCK )
+				{
+					break;
+				}
+				else if( Size==SOCKET_ERROR )
+				{
+					static UBOOL FirstError=1;
+					if( FirstError )
+						debugf( "UDP recvfrom error: %s", SocketError() );
+					FirstError=0;
+					continue;
+				}
+				StatRecvCalls++;
+				StatRecvPackets++;
+				ReceivedPacket( FromAddr, Data, Size, Time );
+			}
 		}
-
-		// Send the packet to the connection for processing.
-		//warning: ReceivedPacket may destroy Connection.
-		debugfSlow( NAME_DevNetTraffic, "%03i: Received %i", (INT)(appSeconds()*1000)%1000, Size );
-		Connection->LastReceiveTime = Time;
-		Connection->ReceivedPacket( Data, Size );
 	}
-	//debugf( "%i", Count );
+	uunclock(RecvCycles);
+	StatRecvCycles += RecvCycles;
 
 	// Poll all sockets.
 	if( GetServerConnection() )
 		GetServerConnection()->Tick();
 	for( INT i=0; i<Connections.Num(); i++ )
 		Connections(i)->Tick();
+	FlushPackets();
+
+	unguard;
+}
+
+//
+// Send the packets batched up during the level tick.
+//
+void UTcpNetDriver::TickFlush()
+{
+	guard(UTcpNetDriver::TickFlush);
+	FlushPackets();
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	UTcpNetDriver network thread.
+-----------------------------------------------------------------------------*/
+
+//
+// Start the network thread.  From then on, it receives all packets and
+// sends those queued by SendPacket, so acks and pings don't wait for the
+// game thread to finish its tick.  Falls back to inline I/O on failure.
+//
+void UTcpNetDriver::StartNetThread()
+{
+	guard(UTcpNetDriver::StartNetThread);
+	check(!NetThread);
+	InQueue  = new FPacketQueue;
+	OutQueue = new FPacketQueue;
+	NetThreadRunning.store( 1 );
+	NetThread = appThreadSpawn( NetThreadEntry, (void*)this, "NetThread", 0, NULL );
+	if( NetThread )
+	{
+		debugf( NAME_Init, "WinSock: Started network thread" );
+	}
+	else
+	{
+		debugf( NAME_Init, "WinSock: Failed to start network thread, using inline I/O" );
+		delete InQueue;
+		delete OutQueue;
+		InQueue = OutQueue = NULL;
+	}
+	unguard;
+}
 
+//
+// Stop the network thread, and send any packets it left behind.
+//
+void UTcpNetDriver::StopNetThread()
+{
+	guard(UTcpNetDriver::StopNetThread);
+	if( NetThread )
+	{
+		NetThreadRunning.store( 0 );
+		appThreadJoin( NetThread );
+		NetThread = NULL;
+		for( FQueuedPacket* Packet=OutQueue->GetPopSlot(); Packet; Packet=OutQueue->GetPopSlot() )
+		{
+			sendto( Socket, (char*)Packet->Data, Packet->Size, 0, (sockaddr*)&Packet->Addr, sizeof(Packet->Addr) );
+			OutQueue->Pop();
+		}
+		delete InQueue;
+		delete OutQueue;
+		InQueue = OutQueue = NULL;
+	}
 	unguard;
 }
 
+//
+// Network thread main loop.  This is the only producer of InQueue and the
+// only consumer of OutQueue; the game thread is the other side of both.
+//warning: Runs outside of the game thread, so it must not touch
+// connections, names or objects.
+//
+void UTcpNetDriver::NetThreadMain()
+{
+	while( NetThreadRunning.load() )
+	{
+		// Send everything the game thread queued.
+		for( FQueuedPacket* Packet=OutQueue->GetPopSlot(); Packet; Packet=OutQueue->GetPopSlot() )
+		{
+			NetSendCalls++;
+			sendto( Socket, (char*)Packet->Data, Packet->Size, 0, (sockaddr*)&Packet->Addr, sizeof(Packet->Addr) );
+			OutQueue->Pop();
+		}
+
+		// Wait briefly for incoming data.
+		fd_set ReadSet;
+		FD_ZERO( &ReadSet );
+		FD_SET( Socket, &ReadSet );
+		timeval Wait;
+		Wait.tv_sec  = 0;
+		Wait.tv_usec = 1000;
+		if( select( Socket+1, &ReadSet, NULL, NULL, &Wait )<=0 )
+			continue;
+
+		// Receive and timestamp everything that's available.
+		while( 1 )
+		{
+			FQueuedPacket* Packet = InQueue->GetPushSlot();
+			if( !Packet )
+			{
+				// The game thread is behind, so leave the rest in the socket's buffer.
+				NetInStalls++;
+				appSleep( 0.001f );
+				break;
+			}
+			socklen_t FromSize = sizeof(Packet->Addr);
+			INT Size = recvfrom( Socket, (char*)Packet->Data, sizeof(Packet->Data), 0, (sockaddr*)&Packet->Addr, &FromSize );
+			if( Size==SOCKET_ERROR )
+			{
+				if( WSAGetLastError()==WSAEWOULDBLOCK )
+					break;
+				continue;
+			}
+			NetRecvCalls++;
+			Packet->Time = appSeconds();
+			Packet->Size = Size;
+			InQueue->Push();
+		}
+	}
+}
+
 /*-----------------------------------------------------------------------------
 	UTcpNetDriver command line.
 -----------------------------------------------------------------------------*/
@@ -637,6 +1134,7 @@ INT UTcpNetDriver::Exec( const char* Cmd, FOutputDevice* Out )
 		{
 			GetServerConnection()->Describe( String );
 			Out->Logf( "   %s", String );
+			Out->Logf( "      %s", GetServerConnection()->DescribeStats(Other) );
 			for( FChannelIterator It(GetServerConnection()); It; ++It )
 				Out->Logf( "      Channel %i: %s", It.GetIndex(), It->Describe(Other) );
 		}
@@ -644,11 +1142,47 @@ INT UTcpNetDriver::Exec( const char* Cmd, FOutputDevice* Out )
 		{
 			Connections(i)->Describe( String );
 			Out->Logf( "   %s", String );
+			Out->Logf( "      %s", Connections(i)->DescribeStats(Other) );
 			for( FChannelIterator It(Connections(i)); It; ++It )
 				Out->Logf( "      Channel %i: %s", It.GetIndex(), It->Describe(Other) );
 		}
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,"NETSTATS") )
+	{
+		if( ParseCommand(&Cmd,"RESET") )
+		{
+			StatTicks = StatRecvCalls = StatRecvPackets = StatSendCalls = StatSendPackets = 0;
+			StatOutOverflow = 0;
+			StatRecvCycles = 0;
+			StatQueueDelay = 0.0;
+			NetRecvCalls = NetSendCalls = NetInStalls = 0;
+			return 1;
+		}
+		INT NumHashed=0, NumBuckets=0, MaxChain=0;
+		for( INT i=0; i<CONNECTION_HASH_SIZE; i++ )
+		{
+			INT Chain=0;
+			for( UTcpipConnection* Connection=ConnectionHash[i]; Connection; Connection=Connection->HashNext )
+				Chain++;
+			NumHashed  += Chain;
+			NumBuckets += Chain!=0;
+			MaxChain    = ::Max( MaxChain, Chain );
+		}
+		INT RecvCalls   = StatRecvCalls + NetRecvCalls.load();
+		INT SendCalls   = StatSendCalls + NetSendCalls.load();
+		INT SendPackets = StatSendPackets + NetSendCalls.load();
+		Out->Logf( "Network driver stats over %i ticks:", StatTicks );
+		Out->Logf( "   Receive: %i packets in %i calls (%.2f per call), %s", StatRecvPackets, RecvCalls, StatRecvPackets/(FLOAT)::Max(RecvCalls,1), BatchRecv ? "batched" : "unbatched" );
+		Out->Logf( "   Send: %i packets in %i calls (%.2f per call), %s", SendPackets, SendCalls, SendPackets/(FLOAT)::Max(SendCalls,1), BatchSend ? "batched" : "unbatched" );
+		Out->Logf( "   Receive time: %.3f msec per tick, %.3f msec last tick", GSecondsPerCycle*1000*StatRecvCycles/::Max(StatTicks,1), GSecondsPerCycle*1000*RecvCycles );
+		Out->Logf( "   Connection hash: %i connections in %i/%i buckets, longest chain %i", NumHashed, NumBuckets, CONNECTION_HASH_SIZE, MaxChain );
+		if( NetThread )
+			Out->Logf( "   Network thread: %.3f msec average queue delay, %i receive stalls, %i send queue waits", 1000.0*StatQueueDelay/::Max(StatRecvPackets,1), NetInStalls.load(), StatOutOverflow );
+		else
+			Out->Logf( "   Inline I/O" );
+		return 1;
+	}
 	else if( ParseCommand(&Cmd,"URL") )
 	{
 		FURL URL(NULL,Cmd,TRAVEL_Absolute);
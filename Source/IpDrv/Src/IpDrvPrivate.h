@@ -28,6 +28,7 @@ Revision history:
 
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
 
 #include "Engine.h"
 #include "UnNet.h"
@@ -44,6 +44,13 @@ typedef char* LPSTR;
 #define IPBYTE(A, N) ((BYTE*)&A.s_addr)[N-1]
 #endif
 
+// Whether recvmmsg and sendmmsg may be available.
+#if defined(__linux__) && !defined(PLATFORM_PSVITA)
+#define SOCKETS_HAVE_MMSG 1
+#else
+#define SOCKETS_HAVE_MMSG 0
+#endif
+
 /*----------------------------------------------------------------------------
 	Functions.
 ----------------------------------------------------------------------------*/
@@ -214,6 +214,10 @@ extern FLightManagerBase* GLightManager;
 
 		// IllumStats.
 		INT IllumTime;
+		INT IllumShadowTime, IllumSpatialTime, IllumMergeTime, IllumFogTime;
+		INT IllumMaps;			// Lights whose maps were generated or merged.
+		INT IllumParallel;		// Batches of maps spread over the worker threads.
+		INT IllumReused;		// Dynamic lightmaps reused because their layers were unchanged.
 
 		// PolyVStats.
 		INT PolyVTime;
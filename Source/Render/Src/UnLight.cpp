@@ -100,6 +100,16 @@ Revision history:
 #include "RenderPrivate.h"
 #include <math.h>
 
+// SIMD versions of the map generation inner loops.  The scalar loops handle
+// other targets and whatever is left over at the end of each row.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define LIGHT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LIGHT_NEON 1
+#include <arm_neon.h>
+#endif
+
 #define SHADOW_SMOOTHING 1 /* Smooth shadows (should be 1) */
 #define ZERO_FLOAT_LIGHT (FLOAT)((3<<22) + 0x10)
 
@@ -136,6 +146,9 @@ public:
 	// Constants.
 	class FLightInfo;
 	enum {MAX_LIGHTS=256};
+	enum {MAX_MAP_U=1024};			// Widest map row, in bytes.
+	enum {MAX_BATCH=16};			// Lights whose maps are generated together.
+	enum {PARALLEL_TEXELS=4096};	// Least texels in a batch worth spreading over the worker threads.
 
 	// Function pointer types.
 	typedef void (*LIGHT_SPATIAL_FUNC)( FTextureInfo& Tex, FLightInfo* Info, BYTE* Src, BYTE* Dest );
@@ -213,12 +226,55 @@ public:
 	static void spatial_Shell       ( FTextureInfo& Tex, FLightInfo* Info, BYTE* Src, BYTE* Dest );
 	static void spatial_Test		( FTextureInfo& Tex, FLightInfo* Info, BYTE* Src, BYTE* Dest );
 
+	// A light whose maps are generated by FlushMapJobs.
+	struct FMapJob
+	{
+		FLightInfo*	Info;
+		BYTE*		ShadowBits;				// Shadow bitmask, or NULL for none.
+		BYTE*		ShadowMap;				// Filtered shadow map.
+		UBOOL		NeedShadow;				// Whether ShadowMap must be generated.
+		UBOOL		NeedIllum;				// Whether Info->IlluminationMap must be generated.
+	};
+
+	// One dynamic light's contribution to a cached dynamic lightmap.
+	struct FLightLayer
+	{
+		AActor*		Actor;
+		FVector		Location;				// Light's world location.
+		FRotator	Rotation;				// Light's view rotation, which aims spotlights.
+		FVector		Color;					// Light's scaled color, which its palette comes from.
+		FLOAT		Radius;
+		INT			Shape;					// LightEffect and LightCone.
+	};
+
+	// Header of a cached dynamic lightmap: the static lightmap plus the scaled layers
+	// of the dynamic lights.  If none of them change, the map is reused as it is.
+	enum {MAX_LAYERS=16};
+	struct FLayerStamp
+	{
+		DOUBLE		Time;					// Viewport time it was last used.
+		INT			NumLayers;				// Number of layers, or MAX_LAYERS+1 if it can't be reused.
+		INT			Pad;
+		FLightLayer	Layers[MAX_LAYERS];
+	};
+
 	// FLightManager functions.
-	static void Merge( FTextureInfo& Tex, BYTE LightEffect, INT Key, FLightInfo* Light, DWORD* Stream, DWORD* Dest );
-	static FLOAT Volumetric( FLightInfo* Info, FVector& Vertex );
-	void ShadowMapGen( FTextureInfo& Tex, BYTE* SrcBits, BYTE* Dest1 );
+	static void Merge( FTextureInfo& Tex, BYTE LightEffect, INT Key, FLightInfo* Light, DWORD* Stream, DWORD* Dest, INT StartV, INT EndV );
+	static FLOAT Volumetric( FLightInfo* Info, FVector& Vertex, INT& FogRejectionMethod );
+	static void ShadowMapGen( FTextureInfo& Tex, BYTE* SrcBits, BYTE* Dest1 );
+	static void ShadowFilterRow( BYTE* Src, DWORD* Outer, DWORD* Centre );
 	UBOOL AddLight( AActor* Actor, AActor* Other );
 
+	// Map generation jobs.
+	static void AddMapJob( FLightInfo* Info, BYTE* ShadowBits, BYTE* ShadowMap, UBOOL NeedShadow, UBOOL NeedIllum );
+	static void FlushMapJobs( DWORD* Stream, INT Key );
+	static void RunJobs( void (*Func)( INT Job ), INT NumJobs, UBOOL Parallel );
+	static INT  NumBands( INT Rows, UBOOL Parallel );
+	static void ShadowJob( INT Job );
+	static void SpatialJob( INT Job );
+	static void MergeJob( INT Band );
+	static void FogJob( INT Band );
+
 	// Variables.
 	static FCoords			*MapCoords, MapUncoords;
 	static FVector			VertexBase, VertexDU, VertexDV;
@@ -248,6 +304,14 @@ public:
 	enum {MAX_UNLOCKED_ITEMS=256};
 	static FCacheItem* ItemsToUnlock[MAX_UNLOCKED_ITEMS];
 	static FCacheItem** TopItemToUnlock;
+
+	// Map generation jobs.
+	static FMapJob			MapJobs[MAX_BATCH];
+	static INT				NumMapJobs, MergeBands, MergeKey;
+	static DWORD*			MergeStream;
+	static FLightInfo*		FogLights[MAX_LIGHTS];
+	static INT				NumFogLights, FogBands;
+	static FVector			FogBase, FogDU, FogDV;
 };
 
 FCoords*						FLightManager::MapCoords;
@@ -284,6 +348,17 @@ FLOAT							FLightManager::BackdropBrightness;
 FLOAT							FLightManager::LightSqrt[4096];
 FCacheItem*						FLightManager::ItemsToUnlock[MAX_UNLOCKED_ITEMS];
 FCacheItem**					FLightManager::TopItemToUnlock;
+FLightManager::FMapJob			FLightManager::MapJobs[MAX_BATCH];
+INT								FLightManager::NumMapJobs;
+INT								FLightManager::MergeBands;
+INT								FLightManager::MergeKey;
+DWORD*							FLightManager::MergeStream;
+FLightManager::FLightInfo*		FLightManager::FogLights[MAX_LIGHTS];
+INT								FLightManager::NumFogLights;
+INT								FLightManager::FogBands;
+FVector							FLightManager::FogBase;
+FVector							FLightManager::FogDU;
+FVector							FLightManager::FogDV;
 
 const FLightManager::FLocalEffectEntry FLightManager::Effects[LE_MAX] =
 {
@@ -311,6 +386,179 @@ const FLightManager::FLocalEffectEntry FLightManager::Effects[LE_MAX] =
 {/* Unused		 */	spatial_None,			0,		0        },
 };
 
+/*------------------------------------------------------------------------------------
+	Worker threads.
+------------------------------------------------------------------------------------*/
+
+//
+// A pool of threads which runs batches of independent lighting jobs, with
+// the calling thread taking jobs too.  Idle workers sleep on their own event
+// until a batch is posted, and the caller sleeps until the last job is done.
+//
+class FLightWorkers
+{
+public:
+	typedef void (*JOB_FUNC)( INT Job );
+	enum {MAX_THREADS=8};
+
+	FLightWorkers()
+	:	NumThreads( 0 )
+	,	Lock( NULL )
+	,	Done( NULL )
+	,	Func( NULL )
+	,	NumJobs( 0 )
+	,	NextJob( 0 )
+	,	DoneJobs( 0 )
+	,	Exiting( 0 )
+	,	Failed( 0 )
+	{
+		Error[0] = 0;
+	}
+	void Init( INT InNumThreads )
+	{
+		guard(FLightWorkers::Init);
+		Lock     = new FMutex( "LightJobs" );
+		Done     = new FEvent( "LightDone" );
+		Exiting  = 0;
+		Failed   = 0;
+		for( NumThreads=0; NumThreads<Min(InNumThreads-1,(INT)MAX_THREADS); NumThreads++ )
+		{
+			FWorker& Worker = Workers[NumThreads];
+			Worker.Pool     = this;
+			Worker.Wake     = new FEvent( "LightWake" );
+			Worker.Thread   = appThreadSpawn( ThreadEntry, &Worker, "LightWorker", 0, NULL );
+			if( !Worker.Thread )
+			{
+				delete Worker.Wake;
+				break;
+			}
+		}
+		unguard;
+	}
+	void Exit()
+	{
+		guard(FLightWorkers::Exit);
+		appInterlockedAdd( &Exiting, 1 );
+		for( INT i=0; i<NumThreads; i++ )
+		{
+			Workers[i].Wake->Trigger();
+			appThreadJoin( Workers[i].Thread );
+			delete Workers[i].Wake;
+		}
+		NumThreads = 0;
+		delete Done;
+		Done = NULL;
+		delete Lock;
+		Lock = NULL;
+		unguard;
+	}
+	INT GetNumThreads()
+	{
+		return NumThreads + 1;
+	}
+	void Run( JOB_FUNC InFunc, INT InNumJobs )
+	{
+		guard(FLightWorkers::Run);
+		if( NumThreads==0 || InNumJobs<=1 )
+		{
+			for( INT i=0; i<InNumJobs; i++ )
+				InFunc( i );
+			return;
+		}
+
+		// Post the batch, wake as many workers as can help, help with it,
+		// and wait for the stragglers.
+		Lock->Lock();
+		Func     = InFunc;
+		NumJobs  = InNumJobs;
+		NextJob  = 0;
+		DoneJobs = 0;
+		Failed   = 0;
+		Error[0] = 0;
+		Lock->Unlock();
+		for( INT i=0; i<Min(NumThreads,InNumJobs-1); i++ )
+			Workers[i].Wake->Trigger();
+		while( RunOne() );
+		while( appInterlockedAdd( &DoneJobs, 0 ) < InNumJobs )
+			Done->Wait();
+		if( Failed )
+			appErrorf( "Lighting failed on a worker thread: %s", Error );
+		unguard;
+	}
+private:
+	struct FWorker
+	{
+		FLightWorkers*	Pool;
+		FEvent*			Wake;
+		UTHREAD			Thread;
+	};
+	INT			NumThreads;
+	FWorker		Workers[MAX_THREADS];
+	FMutex*		Lock;
+	FEvent*		Done;
+	JOB_FUNC	Func;
+	INT			NumJobs, NextJob;
+	volatile INT DoneJobs, Exiting, Failed;
+	char		Error[1024];
+
+	UBOOL RunOne()
+	{
+		Lock->Lock();
+		INT      Job     = NextJob<NumJobs ? NextJob++ : INDEX_NONE;
+		JOB_FUNC JobFunc = Func;
+		Lock->Unlock();
+		if( Job==INDEX_NONE )
+			return 0;
+		try
+		{
+			JobFunc( Job );
+		}
+		catch( char* Err )
+		{
+			Fail( Err );
+		}
+		catch( ... )
+		{
+			Fail( GIsCriticalError ? GErrorHist : "Unknown exception" );
+		}
+		if( appInterlockedAdd( &DoneJobs, 1 )+1 == NumJobs )
+			Done->Trigger();
+		return 1;
+	}
+	void Fail( const char* Msg )
+	{
+		// Keep the first error for the thread which posted the batch to report.
+		Lock->Lock();
+		if( !Failed )
+		{
+			appStrncpy( Error, Msg, ARRAY_COUNT(Error) );
+			Failed = 1;
+		}
+		Lock->Unlock();
+	}
+	void Work( FEvent* Wake )
+	{
+		for( ;; )
+		{
+			Wake->Wait();
+			if( Exiting )
+				break;
+			while( RunOne() );
+		}
+	}
+#ifdef PLATFORM_WIN32
+	static DWORD __stdcall ThreadEntry( void* Arg )
+#else
+	static void* ThreadEntry( void* Arg )
+#endif
+	{
+		FWorker* Worker = (FWorker*)Arg;
+		Worker->Pool->Work( Worker->Wake );
+		return 0;
+	}
+};
+static FLightWorkers GLightWorkers;
+
 /*------------------------------------------------------------------------------------
 	Init & Exit.
 ------------------------------------------------------------------------------------*/
@@ -431,8 +679,13 @@ void FLightManager::Init()
 	// Cache items.
 	TopItemToUnlock = &ItemsToUnlock[0];
 
+	// Worker threads for map generation, 0=one per core.
+	INT LightThreads = 0;
+	GetConfigInt( "Render.Render", "LightThreads", LightThreads );
+	GLightWorkers.Init( LightThreads>0 ? LightThreads : appNumCores() );
+
 	// Success.
-	debugf( NAME_Init, "Lighting subsystem initialized" );
+	debugf( NAME_Init, "Lighting subsystem initialized (%i threads)", GLightWorkers.GetNumThreads() );
 	unguard;
 }
 
@@ -443,6 +696,7 @@ void FLightManager::Exit()
 {
 	guard(FLightManager::Exit);
 
+	GLightWorkers.Exit();
 	debugf( NAME_Exit, "Lighting subsystem shut down" );
 	unguard;
 }
@@ -474,38 +728,34 @@ void FLightManager::ShadowMapGen( FTextureInfo& Tex, BYTE* SrcBits, BYTE* Dest1
 	debug(((INT)Dest1 & 3)==0);
 
 	// Generate smooth shadow map by convolving the shadow bitmask with a smoothing filter.
+	// The filter's top and bottom rows are the same, so each bitmask row is filtered
+	// horizontally into an outer and a centre row, and each output row is the sum of
+	// its centre row and the outer rows above and below it, repeated at the edges.
 	INT Size4 = (ShadowMaskU*8)/4;
-	appMemset( Dest1, 0, ShadowMaskSpace*8 );
-	DWORD* Dests[3] = { (DWORD*)Dest1, (DWORD*)Dest1, (DWORD*)Dest1 + Size4 };
+	debug(Size4<=MAX_MAP_U/4);
+	DWORD Outer[3][MAX_MAP_U/4], Centre[3][MAX_MAP_U/4];
+	ShadowFilterRow( SrcBits, Outer[0], Centre[0] );
 	for( INT V=0; V<Tex.VClamp; V++ )
 	{
-		// Get initial bits, with low bit shifted in.
-		BYTE* Src = SrcBits;
-
-		// Offset of shadow map relative to convolution filter left edge.
-		DWORD D = (DWORD)*Src++ << (8+2);
-		if( D & 0x400 ) D |= 0x300;
-
-		// Filter everything.
-		for( INT U=0; U<ShadowMaskU; U++ )
+		if( V+1 < Tex.VClamp )
+			ShadowFilterRow( SrcBits + (V+1)*ShadowMaskU, Outer[(V+1)%3], Centre[(V+1)%3] );
+		DWORD* Above = Outer [V>0 ? (V-1)%3 : 0];
+		DWORD* Below = Outer [V+1<Tex.VClamp ? (V+1)%3 : V%3];
+		DWORD* Mid   = Centre[V%3];
+		DWORD* Dest  = (DWORD*)Dest1 + V*Size4;
+		INT    i     = 0;
+#if LIGHT_SSE2
+		for( ; i+4<=Size4; i+=4 )
 		{
-			D = D >> 8;
-			D += (U<ShadowMaskU-1) ? (((DWORD)*Src++) << (8+2)) : (D&0x200) ? 0xC00 : 0;
-
-
-			FILTER_TAB& Tab1 = FilterTab[D & 0x7f];
-			*Dests[0]++     += Tab1[0];
-			*Dests[1]++     += Tab1[1];
-			*Dests[2]++     += Tab1[2];
-
-			FILTER_TAB& Tab2 = FilterTab[(D>>4) & 0x7f];
-			*Dests[0]++     += Tab2[0];
-			*Dests[1]++     += Tab2[1];
-			*Dests[2]++     += Tab2[2];
+			__m128i Sum = _mm_add_epi32( _mm_loadu_si128((__m128i*)&Above[i]), _mm_loadu_si128((__m128i*)&Mid[i]) );
+			_mm_storeu_si128( (__m128i*)&Dest[i], _mm_add_epi32( Sum, _mm_loadu_si128((__m128i*)&Below[i]) ) );
 		}
-		SrcBits += ShadowMaskU;
-		if( V == 0            ) Dests[0] -= Size4;
-		if( V == Tex.VClamp-2 ) Dests[2] -= Size4;
+#elif LIGHT_NEON
+		for( ; i+4<=Size4; i+=4 )
+			vst1q_u32( (uint32_t*)&Dest[i], vaddq_u32( vaddq_u32( vld1q_u32((uint32_t*)&Above[i]), vld1q_u32((uint32_t*)&Mid[i]) ), vld1q_u32((uint32_t*)&Below[i]) ) );
+#endif
+		for( ; i<Size4; i++ )
+			Dest[i] = Above[i] + Mid[i] + Below[i];
 	}
 #if !__INTEL_BYTE_ORDER__
 	Size4 = (ShadowMaskSpace*8)/4;
@@ -518,6 +768,31 @@ void FLightManager::ShadowMapGen( FTextureInfo& Tex, BYTE* SrcBits, BYTE* Dest1
 	unguardSlow;
 }
 
+//
+// Filter one row of a shadow bitmask horizontally, into the outer and centre
+// rows of the smoothing filter.
+//
+void FLightManager::ShadowFilterRow( BYTE* Src, DWORD* Outer, DWORD* Centre )
+{
+	// Get initial bits, with low bit shifted in.
+	DWORD D = (DWORD)*Src++ << (8+2);
+	if( D & 0x400 ) D |= 0x300;
+
+	// Filter everything.
+	for( INT U=0; U<ShadowMaskU; U++ )
+	{
+		D = D >> 8;
+		D += (U<ShadowMaskU-1) ? (((DWORD)*Src++) << (8+2)) : (D&0x200) ? 0xC00 : 0;
+
+		FILTER_TAB& Tab1 = FilterTab[D & 0x7f];
+		FILTER_TAB& Tab2 = FilterTab[(D>>4) & 0x7f];
+		*Outer++  = Tab1[0];
+		*Outer++  = Tab2[0];
+		*Centre++ = Tab1[1];
+		*Centre++ = Tab2[1];
+	}
+}
+
 /*------------------------------------------------------------------------------------
 	Vertex lighting and fogging.
 ------------------------------------------------------------------------------------*/
@@ -610,6 +885,7 @@ inline FPlane FLightManager::Fog(FTransSample& Vert, DWORD PolyFlags )
 	{
 		STAT(uclock(GStat.MeshLightTime));
 		FPlane Fog(0,0,0,0);
+		static INT FogRejectionMethod = 0;
 
 		// First fog light is copied, all next lights are merged.
 		// Look for the first volumetric light.
@@ -623,7 +899,7 @@ inline FPlane FLightManager::Fog(FTransSample& Vert, DWORD PolyFlags )
 			if( LightInfo->IsVolumetric ) 
 			{
 				FPlane LocalFog;
-				FLOAT VolumeValue = 2.0f * Volumetric( LightInfo, Vert.Point);
+				FLOAT VolumeValue = 2.0f * Volumetric( LightInfo, Vert.Point, FogRejectionMethod );
 				LocalFog.R = LightInfo->VolumetricColor.R * VolumeValue;
 				LocalFog.G = LightInfo->VolumetricColor.G * VolumeValue;
 				LocalFog.B = LightInfo->VolumetricColor.B * VolumeValue;
@@ -648,7 +924,7 @@ inline FPlane FLightManager::Fog(FTransSample& Vert, DWORD PolyFlags )
 				// todo: MinPositiveFloat scaling shouldn't be necessary ??
 
 				FPlane LocalFog;
-				FLOAT VolumeValue = 2.0f * Volumetric( LightInfo, Vert.Point);
+				FLOAT VolumeValue = 2.0f * Volumetric( LightInfo, Vert.Point, FogRejectionMethod );
 				if (*(DWORD*)&VolumeValue != 0)	// quick zero test 
 				{
 					LocalFog.R = LightInfo->VolumetricColor.R * VolumeValue;
@@ -682,30 +958,35 @@ inline FPlane FLightManager::Fog(FTransSample& Vert, DWORD PolyFlags )
 	Light merging.
 ------------------------------------------------------------------------------------*/
 
-void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo* Info, DWORD* Stream, DWORD* Dest )
+//
+// Merge a light's illumination map into rows StartV to EndV of a lightmap.
+//
+void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo* Info, DWORD* Stream, DWORD* Dest, INT StartV, INT EndV )
 {
 	guardSlow(FLightManager::Merge);
 
-	static INT Count; 
+	INT Count;
 	FColor* Palette;
-    INT Skip;
 
 	// Merge the two streams of light.
 	BYTE* Src = Info->IlluminationMap;
 	Palette   = Info->Palette;
-	Skip      = Info->MinU;
 	Count     = Info->MaxU - Info->MinU;
+	StartV    = Max( StartV, Info->MinV );
+	EndV      = Min( EndV,   Info->MaxV );
 
-	if( Count<=0 ) return;
+	if( Count<=0 || StartV>=EndV ) return;
 
 	UBOOL FXDetect = ( (Effect==LE_TorchWaver) || (Effect==LE_FireWaver) || (Effect==LE_WateryShimmer) );
 
-	Src    += Info->MinV * Tex.UClamp;
-	Dest   += Info->MinV * Tex.USize;
-	Stream += Info->MinV * Tex.USize;
+	// Effects take one key per texel, so carry on from where the rows above left off.
+	Key    += (StartV - Info->MinV) * Count;
+	Src    += StartV * Tex.UClamp;
+	Dest   += StartV * Tex.USize;
+	Stream += StartV * Tex.USize;
 
 
-	for( INT i=Info->MinV; i<Info->MaxV; i++ )
+	for( INT i=StartV; i<EndV; i++ )
 	{
 		BYTE* NewSrc = Src;
 
@@ -731,8 +1012,31 @@ void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo*
 			}
 		}
 
-		// Scale and merge the lighting.
-		for( INT j=Info->MinU; j<Info->MaxU; j++ )
+		// Scale and merge the lighting, four texels at a time where possible.
+		// Saturation is done without branches, the same way as the scalar loop.
+		INT j = Info->MinU;
+#if LIGHT_SSE2
+		const __m128i Low7 = _mm_set1_epi32( 0x7f7f7f7f ), High1 = _mm_set1_epi32( 0x80808080 );
+		for( ; j+4<=Info->MaxU; j+=4 )
+		{
+			__m128i Light  = _mm_setr_epi32( Palette[NewSrc[j]].D, Palette[NewSrc[j+1]].D, Palette[NewSrc[j+2]].D, Palette[NewSrc[j+3]].D );
+			__m128i Sum    = _mm_add_epi32( _mm_loadu_si128((__m128i*)&Stream[j]), Light );
+			__m128i SatBit = _mm_and_si128( Sum, High1 );
+			__m128i SatMask= _mm_sub_epi32( SatBit, _mm_srli_epi32( SatBit, 7 ) );
+			_mm_storeu_si128( (__m128i*)&Dest[j], _mm_or_si128( _mm_and_si128( Sum, Low7 ), SatMask ) );
+		}
+#elif LIGHT_NEON
+		const uint32x4_t Low7 = vdupq_n_u32( 0x7f7f7f7f ), High1 = vdupq_n_u32( 0x80808080 );
+		for( ; j+4<=Info->MaxU; j+=4 )
+		{
+			uint32_t   Colors[4] = { Palette[NewSrc[j]].D, Palette[NewSrc[j+1]].D, Palette[NewSrc[j+2]].D, Palette[NewSrc[j+3]].D };
+			uint32x4_t Sum       = vaddq_u32( vld1q_u32((uint32_t*)&Stream[j]), vld1q_u32(Colors) );
+			uint32x4_t SatBit    = vandq_u32( Sum, High1 );
+			uint32x4_t SatMask   = vsubq_u32( SatBit, vshrq_n_u32( SatBit, 7 ) );
+			vst1q_u32( (uint32_t*)&Dest[j], vorrq_u32( vandq_u32( Sum, Low7 ), SatMask ) );
+		}
+#endif
+		for( ; j<Info->MaxU; j++ )
 		{
 			Dest[j] = Stream[j] + Palette[NewSrc[j]].D;
 			if( Dest[j] & 0x80808080 )
@@ -764,8 +1068,6 @@ void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo*
 // RRadiusMult	= Inverse radius multiplier
 //
 #define SPATIAL_PRE \
-	STAT(GStat.MeshPtsGen+=Map.UClamp*Map.VClamp); \
-	STAT(GStat.MeshesGen++); \
 	/* Compute values for stepping through mesh points */ \
 	FVector Vertex1 = VertexBase + VertexDV*Info->MinV + VertexDU*Info->MinU; \
 	Src  += (ShadowMaskU*8)*Info->MinV + Info->MinU; \
@@ -803,16 +1105,14 @@ void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo*
 void FLightManager::spatial_None( FTextureInfo& Map, FLightInfo* Info, BYTE* Src, BYTE* Dest )
 {
 	guardSlow(FLightManager::spatial_None);
-	STAT(GStat.MeshPtsGen+=Map.UClamp*Map.VClamp);
-	STAT(GStat.MeshesGen++);
 
 	// Variables.
-	static FVector Vertex;
-	static FLOAT   Scale, Diffuse;
-	static INT     Dist, DistU, DistV, DistUU, DistVV, DistUV;
-	static INT     Interp00, Interp10, Interp20, Interp01, Interp11, Interp02;
-	static DWORD   Inner0, Inner1;
-	static INT     Hecker;
+	FVector Vertex;
+	FLOAT   Scale, Diffuse;
+	INT     Dist, DistU, DistV, DistUU, DistVV, DistUV;
+	INT     Interp00, Interp10, Interp20, Interp01, Interp11, Interp02;
+	DWORD   Inner0, Inner1;
+	INT     Hecker;
 
 	// Compute values for stepping through mesh points.
 #if 0
@@ -861,9 +1161,72 @@ void FLightManager::spatial_None( FTextureInfo& Map, FLightInfo* Info, BYTE* Src
 	for( INT VCounter=Info->MinV; VCounter<Info->MaxV; VCounter++ )
 	{
 		// Forward difference the square of the distance between the points.
-		Inner0 = Interp00;
-		Inner1 = Interp01;
-		for( INT U=Info->MinU; U<Info->MaxU; U++ )
+		Inner0  = Interp00;
+		Inner1  = Interp01;
+		INT U   = Info->MinU;
+#if LIGHT_SSE2 || LIGHT_NEON
+		// Four texels at a time: each lane steps four texels along, by a
+		// difference which itself grows by 16*Interp02 per step.
+		DWORD Step = Interp02;
+		DWORD Start[4] = { Inner0, Inner0+Inner1, Inner0+2*Inner1+Step, Inner0+3*Inner1+3*Step };
+		DWORD Delta[4] = { 4*Inner1+6*Step, 4*Inner1+10*Step, 4*Inner1+14*Step, 4*Inner1+18*Step };
+#if LIGHT_SSE2
+		__m128i Inner    = _mm_loadu_si128( (__m128i*)Start );
+		__m128i Diff     = _mm_loadu_si128( (__m128i*)Delta );
+		__m128i Step16   = _mm_set1_epi32( 16*Step );
+		__m128i Zero     = _mm_setzero_si128();
+		__m128  Scales   = _mm_set1_ps( Diffuse );
+		__m128  Magic    = _mm_set1_ps( (FLOAT)(2<<22) );
+		__m128i LowByte  = _mm_set1_epi32( 0xff );
+		for( ; U+4<=Info->MaxU; U+=4,Src+=4,Dest+=4 )
+		{
+			__m128i Index  = _mm_and_si128( _mm_srli_epi32(Inner,12), _mm_set1_epi32(4095) );
+			__m128  Atten  = _mm_setr_ps
+			(
+				LightSqrt[_mm_cvtsi128_si32(Index)],
+				LightSqrt[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index,1))],
+				LightSqrt[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index,2))],
+				LightSqrt[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index,3))]
+			);
+			INT     Bytes;
+			appMemcpy( &Bytes, Src, 4 );
+			__m128i Shadow = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128(Bytes), Zero ), Zero );
+			__m128i Lit    = _mm_andnot_si128( _mm_cmpeq_epi32(Shadow,Zero), _mm_cmpeq_epi32(_mm_srli_epi32(Inner,24),Zero) );
+			__m128  Value  = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( _mm_cvtepi32_ps(Shadow), Scales ), Atten ), Magic );
+			__m128i Result = _mm_and_si128( _mm_castps_si128(Value), _mm_and_si128(Lit,LowByte) );
+			Bytes = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_packs_epi32(Result,Zero), Zero ) );
+			appMemcpy( Dest, &Bytes, 4 );
+			Inner = _mm_add_epi32( Inner, Diff );
+			Diff  = _mm_add_epi32( Diff, Step16 );
+		}
+		_mm_storeu_si128( (__m128i*)Start, Inner );
+#else
+		uint32x4_t  Inner  = vld1q_u32( (uint32_t*)Start );
+		uint32x4_t  Diff   = vld1q_u32( (uint32_t*)Delta );
+		uint32x4_t  Step16 = vdupq_n_u32( 16*Step );
+		uint32x4_t  Zero   = vdupq_n_u32( 0 );
+		float32x4_t Scales = vdupq_n_f32( Diffuse );
+		float32x4_t Magic  = vdupq_n_f32( (FLOAT)(2<<22) );
+		DWORD       Ofs[4];
+		for( ; U+4<=Info->MaxU; U+=4,Src+=4,Dest+=4 )
+		{
+			vst1q_u32( (uint32_t*)Ofs, vandq_u32( vshrq_n_u32(Inner,12), vdupq_n_u32(4095) ) );
+			FLOAT       Attens[4] = { LightSqrt[Ofs[0]], LightSqrt[Ofs[1]], LightSqrt[Ofs[2]], LightSqrt[Ofs[3]] };
+			uint32_t    Shadows[4]= { Src[0], Src[1], Src[2], Src[3] };
+			uint32x4_t  Shadow    = vld1q_u32( Shadows );
+			uint32x4_t  Lit       = vandq_u32( vtstq_u32(Shadow,Shadow), vceqq_u32(vshrq_n_u32(Inner,24),Zero) );
+			float32x4_t Value     = vaddq_f32( vmulq_f32( vmulq_f32( vcvtq_f32_u32(Shadow), Scales ), vld1q_f32(Attens) ), Magic );
+			vst1q_u32( (uint32_t*)Ofs, vandq_u32( vreinterpretq_u32_f32(Value), Lit ) );
+			Dest[0] = Ofs[0]; Dest[1] = Ofs[1]; Dest[2] = Ofs[2]; Dest[3] = Ofs[3];
+			Inner = vaddq_u32( Inner, Diff );
+			Diff  = vaddq_u32( Diff, Step16 );
+		}
+		vst1q_u32( (uint32_t*)Start, Inner );
+#endif
+		Inner0 = Start[0];
+		Inner1 = Interp01 + (U-Info->MinU)*Step;
+#endif
+		for( ; U<Info->MaxU; U++ )
 		{
 			if( *Src!=0 && Inner0<4096*4096 ) 
 			{
@@ -886,7 +1249,7 @@ void FLightManager::spatial_None( FTextureInfo& Map, FLightInfo* Info, BYTE* Src
 	unguardSlow;
 }
 
-inline FLOAT FLightManager::Volumetric( FLightInfo* Info, FVector &Vertex )
+inline FLOAT FLightManager::Volumetric( FLightInfo* Info, FVector &Vertex, INT& FogRejectionMethod )
 {
 	// Optimize: there's 2 sqrtapproxes and 2 divides -   too many?
 	//
@@ -897,7 +1260,9 @@ inline FLOAT FLightManager::Volumetric( FLightInfo* Info, FVector &Vertex )
 	//
 	// FLOAT VertexSize = SqrtApprox(Vertex.SizeSquared());	// Distance eye-to-vertex.
 	//
-	static int FogRejectionMethod = 0;
+	// FogRejectionMethod remembers which rejection test worked last; callers
+	// keep one each so fog can be generated on several threads.
+	//
 
 	FLOAT c1, c2, d, F, h, c0, S, S2; 
 	
@@ -1491,6 +1856,174 @@ void FLightManager::FLightInfo::ComputeFromActor( FTextureInfo& Map, FSceneNode*
 	unguard;
 }
 
+/*------------------------------------------------------------------------------------
+	Map generation jobs.
+------------------------------------------------------------------------------------*/
+
+//
+// Queue a light's maps for generation by FlushMapJobs.  The maps must already
+// be allocated, since GMem and the cache are only used from this thread.
+//
+void FLightManager::AddMapJob( FLightInfo* Info, BYTE* ShadowBits, BYTE* ShadowMap, UBOOL NeedShadow, UBOOL NeedIllum )
+{
+	FMapJob& Job   = MapJobs[NumMapJobs++];
+	Job.Info       = Info;
+	Job.ShadowBits = ShadowBits;
+	Job.ShadowMap  = ShadowMap;
+	Job.NeedShadow = NeedShadow;
+	Job.NeedIllum  = NeedIllum;
+}
+
+//
+// Generate the queued lights' maps and merge them into Stream in light order.
+// Each stage is one batch of jobs, spread over the worker threads when there's
+// enough to do: shadow maps and illumination maps by light, merging by rows.
+//
+void FLightManager::FlushMapJobs( DWORD* Stream, INT Key )
+{
+	guard(FLightManager::FlushMapJobs);
+	if( !NumMapJobs )
+		return;
+
+	// See whether it's worth going parallel.
+	INT Texels = 0;
+	for( INT i=0; i<NumMapJobs; i++ )
+	{
+		if( MapJobs[i].NeedShadow || MapJobs[i].NeedIllum )
+			Texels += LightMap.UClamp * LightMap.VClamp;
+		if( MapJobs[i].NeedIllum )
+		{
+			STAT(GStat.MeshPtsGen += LightMap.UClamp * LightMap.VClamp);
+			STAT(GStat.MeshesGen++);
+		}
+	}
+	UBOOL Parallel = Texels >= PARALLEL_TEXELS;
+
+	// Generate the maps.
+	STAT(uclock(GStat.IllumShadowTime));
+	RunJobs( ShadowJob, NumMapJobs, Parallel );
+	STAT(uunclock(GStat.IllumShadowTime));
+	STAT(uclock(GStat.IllumSpatialTime));
+	RunJobs( SpatialJob, NumMapJobs, Parallel );
+	STAT(uunclock(GStat.IllumSpatialTime));
+
+	// Merge them.
+	STAT(uclock(GStat.IllumMergeTime));
+	MergeStream = Stream;
+	MergeKey    = Key;
+	MergeBands  = NumBands( LightMap.VClamp, Parallel );
+	RunJobs( MergeJob, MergeBands, Parallel );
+	STAT(uunclock(GStat.IllumMergeTime));
+
+	STAT(GStat.IllumMaps += NumMapJobs);
+	STAT(GStat.IllumParallel += Parallel);
+	NumMapJobs = 0;
+	unguard;
+}
+
+//
+// Run jobs 0 to NumJobs-1, on the worker threads if Parallel.
+//
+void FLightManager::RunJobs( void (*Func)( INT Job ), INT NumJobs, UBOOL Parallel )
+{
+	if( Parallel )
+		GLightWorkers.Run( Func, NumJobs );
+	else for( INT i=0; i<NumJobs; i++ )
+		Func( i );
+}
+
+//
+// Number of bands of rows to split a map into.
+//
+INT FLightManager::NumBands( INT Rows, UBOOL Parallel )
+{
+	return Parallel ? Clamp( GLightWorkers.GetNumThreads()*2, 1, Rows ) : 1;
+}
+
+void FLightManager::ShadowJob( INT Job )
+{
+	FMapJob& MapJob = MapJobs[Job];
+	if( MapJob.NeedShadow )
+		ShadowMapGen( LightMap, MapJob.ShadowBits, MapJob.ShadowMap );
+}
+
+void FLightManager::SpatialJob( INT Job )
+{
+	FMapJob& MapJob = MapJobs[Job];
+	if( MapJob.NeedIllum )
+		MapJob.Info->Effect.SpatialFxFunc( LightMap, MapJob.Info, MapJob.ShadowMap, MapJob.Info->IlluminationMap );
+}
+
+void FLightManager::MergeJob( INT Band )
+{
+	INT StartV = LightMap.VClamp * (Band+0) / MergeBands;
+	INT EndV   = LightMap.VClamp * (Band+1) / MergeBands;
+	for( INT i=0; i<NumMapJobs; i++ )
+		Merge( LightMap, MapJobs[i].Info->Actor->LightEffect, MergeKey, MapJobs[i].Info, MergeStream, MergeStream, StartV, EndV );
+}
+
+//
+// Generate a band of rows of the fog map, merging in each volumetric in turn.
+//
+void FLightManager::FogJob( INT Band )
+{
+	guardSlow(FLightManager::FogJob);
+	INT StartV = FogMap.VClamp * (Band+0) / FogBands;
+	INT EndV   = FogMap.VClamp * (Band+1) / FogBands;
+	INT RejectionMethod = 0;
+	for( INT k=0; k<NumFogLights; k++ )
+	{
+		FLightInfo* Info    = FogLights[k];
+		FVector     Vertex1 = FogBase + FogDV*StartV;
+		FColor*     Dest    = (FColor*)FogMip.DataPtr + StartV*FogMap.USize;
+		if( k==0 )
+		{
+			// First-time fog calculation, no merging required.
+			for( INT i=StartV; i<EndV; i++ )
+			{
+				FVector Vertex = Vertex1;
+				for( INT j=0; j<FogMap.UClamp; j++ )
+				{
+					DWORD Light = appRound( Volumetric( Info, Vertex, RejectionMethod ) * 255.0f );
+					Vertex+=FogDU;
+					Dest[j] = Info->VolPalette[Light];
+				}
+				Vertex1 += FogDV;
+				Dest += FogMap.USize; 
+			}
+		}
+		else
+		{
+			// Merge in more fog. 
+			// Todo: MMX-optimize ? & nonMMX assembly-optimize ( unpack to 15:15:15:15... )
+			// -> Optimize for recurrence, AND most merging will STILL be with one component
+			// Completely black // or saturated.... - worth a few mispredicted jumps !!!!!
+			// Todo: after alpha-aware merging is in, also check for original value being
+			// zero as a quick bailout.
+			for( INT i=StartV; i<EndV; i++ )
+			{
+				FVector Vertex = Vertex1;
+				for( INT j=0; j<FogMap.UClamp; j++ )
+				{
+					FLOAT FogAdd = Volumetric( Info, Vertex, RejectionMethod );
+					Vertex +=FogDU;
+					if (*(DWORD*)&FogAdd != 0) // bailout if 0...
+					{
+						DWORD Light = appRound( FogAdd  * 255.0f );
+						Dest[j].R = ByteMuck[Dest[j].R+128*(INT)Info->VolPalette[Light].R]; 
+						Dest[j].G = ByteMuck[Dest[j].G+128*(INT)Info->VolPalette[Light].G]; 
+						Dest[j].B = ByteMuck[Dest[j].B+128*(INT)Info->VolPalette[Light].B]; 
+						Dest[j].A = ByteMuck[Dest[j].A+128*(INT)Info->VolPalette[Light].A];
+					}
+				}
+				Vertex1 += FogDV;
+				Dest += FogMap.USize;
+			}
+		}
+	}
+	unguardSlow;
+}
+
 /*------------------------------------------------------------------------------------
 	Implementation of FLightList class
 ------------------------------------------------------------------------------------*/
@@ -1730,70 +2263,28 @@ void FLightManager::SetupForSurf
 		
 		// Merge the volumetrics.
 		guard(MergeVolumetrics);
-		UBOOL VirginFog = true;
+		NumFogLights = 0;
 		for( FLightInfo* Info=FirstLight; Info<LastLight; Info++ )
 		{
 			if( Info->IsVolumetric )
 			{
 				// Compute the volumetric.
 				Info->ComputeFromActor( FogMap, Frame, 1 );
-
-				FVector	Vertex1  = VertexBase.TransformPointBy ( Frame->Coords );
-				FVector VertDU   = VertexDU  .TransformVectorBy( Frame->Coords );
-				FVector VertDV   = VertexDV  .TransformVectorBy( Frame->Coords );
-
-				if (VirginFog)
-				{					
-					// first-time fog calculation, no merging required.
-					FColor* Dest = (FColor*)FogMip.DataPtr;
-					for( int i=0; i<FogMap.VClamp; i++ )
-					{
-						FVector Vertex = Vertex1;
-						for( int j=0; j<FogMap.UClamp; j++ )
-						{
-							DWORD Light = appRound( Volumetric( Info, Vertex ) * 255.0f );
-							Vertex+=VertDU;
-							Dest[j] = Info->VolPalette[Light];
-						}
-						Vertex1 += VertDV;
-						Dest += FogMap.USize; 
-					}
-					VirginFog = false;
-				}
-				else
-				{
-					// Merge in more fog. 
-					// Todo: MMX-optimize ? & nonMMX assembly-optimize ( unpack to 15:15:15:15... )
-					// -> Optimize for recurrence, AND most merging will STILL be with one component
-					// Completely black // or saturated.... - worth a few mispredicted jumps !!!!!
-					// Todo: after alpha-aware merging is in, also check for original value being
-					// zero as a quick bailout.
-					
-					FColor* Dest = (FColor*)FogMip.DataPtr;
-
-					for( int i=0; i<FogMap.VClamp; i++ )
-					{
-						FVector Vertex = Vertex1;
-						for( int j=0; j<FogMap.UClamp; j++ )
-						{
-							FLOAT FogAdd = Volumetric( Info, Vertex );
-							Vertex +=VertDU;
-						    if (*(DWORD*)&FogAdd != 0) // bailout if 0...
-							{
-								DWORD Light = appRound( FogAdd  * 255.0f );
-								Dest[j].R = ByteMuck[Dest[j].R+128*(INT)Info->VolPalette[Light].R]; 
-								Dest[j].G = ByteMuck[Dest[j].G+128*(INT)Info->VolPalette[Light].G]; 
-								Dest[j].B = ByteMuck[Dest[j].B+128*(INT)Info->VolPalette[Light].B]; 
-								Dest[j].A = ByteMuck[Dest[j].A+128*(INT)Info->VolPalette[Light].A];
-							}
-						}
-						Vertex1 += VertDV;
-						Dest += FogMap.USize;
-					}
-
-				}
+				FogLights[NumFogLights++] = Info;
 			}
 		}
+		if( NumFogLights )
+		{
+			// Generate the fog map in bands of rows.
+			FogBase  = VertexBase.TransformPointBy ( Frame->Coords );
+			FogDU    = VertexDU  .TransformVectorBy( Frame->Coords );
+			FogDV    = VertexDV  .TransformVectorBy( Frame->Coords );
+			UBOOL Parallel = NumFogLights * FogMap.UClamp * FogMap.VClamp >= PARALLEL_TEXELS;
+			FogBands = NumBands( FogMap.VClamp, Parallel );
+			STAT(uclock(GStat.IllumFogTime));
+			RunJobs( FogJob, FogBands, Parallel );
+			STAT(uunclock(GStat.IllumFogTime));
+		}
 		unguard;
 	}
 
@@ -1852,7 +2343,7 @@ void FLightManager::SetupForSurf
 			Temp += LightMap.USize;
 		}
 
-		// Add in all static lights.
+		// Add in all static lights, a batch at a time.
 		FMemMark Mark(GMem);
 		for( FLightInfo* Info = FirstLight; Info < LastLight; Info++ )
 		{
@@ -1860,14 +2351,17 @@ void FLightManager::SetupForSurf
 			{
 				// Static lighting.
 				Info->ComputeFromActor( LightMap, Frame, 1 );
-				BYTE* ShadowMap = New<BYTE>(GMem,ShadowMaskSpace*8);
-				ShadowMapGen( LightMap, Info->ShadowBits, ShadowMap );
 				Info->IlluminationMap = New<BYTE>(GMem,LightMap.UClamp*LightMap.VClamp);
-				Info->Effect.SpatialFxFunc( LightMap, Info, ShadowMap, Info->IlluminationMap );
-				Merge( LightMap, Info->Actor->LightEffect, 0, Info, Stream, Stream );
-				Mark.Pop();
+				AddMapJob( Info, Info->ShadowBits, New<BYTE>(GMem,ShadowMaskSpace*8), 1, 1 );
+				if( NumMapJobs == MAX_BATCH )
+				{
+					FlushMapJobs( Stream, 0 );
+					Mark.Pop();
+				}
 			}
 		}
+		FlushMapJobs( Stream, 0 );
+		Mark.Pop();
 		unguard;
 	}
 	else
@@ -1881,6 +2375,7 @@ void FLightManager::SetupForSurf
 	{
 		guard(DynamicLight);
 		DWORD* Static = Stream;
+		FLayerStamp* Stamp = NULL;
 		LightMap.CacheID = MakeCacheID( CID_DynamicMap, iLightMap, ZoneID, Model );
 		if( Merged )
 		{
@@ -1891,20 +2386,66 @@ void FLightManager::SetupForSurf
 		else
 		{
 			// Cache it.
-			Stream = (DWORD*)GCache.Get( LightMap.CacheID, *TopItemToUnlock++ );
-			if( !Stream || *(DOUBLE*)Stream!=Frame->Viewport->CurrentTime )
+			Stamp = (FLayerStamp*)GCache.Get( LightMap.CacheID, *TopItemToUnlock++ );
+			if( !Stamp )
 			{
-				if( !Stream )
-					Stream = (DWORD*)GCache.Create( LightMap.CacheID, TopItemToUnlock[-1], (LightMap.USize*LightMap.VClamp + 3) * sizeof(DWORD), DEFAULT_ALIGNMENT, LightMap.USize*(LightMap.VSize-LightMap.VClamp) );
-				*(DOUBLE*)Stream = Frame->Viewport->CurrentTime;
-				Stream += 2;
-				LightMap.MaxColor = (FColor*)Stream++;
+				Stamp = (FLayerStamp*)GCache.Create( LightMap.CacheID, TopItemToUnlock[-1], sizeof(FLayerStamp) + (LightMap.USize*LightMap.VClamp + 1) * sizeof(DWORD), DEFAULT_ALIGNMENT, LightMap.USize*(LightMap.VSize-LightMap.VClamp) );
+				Stamp->Time      = -1.0;
+				Stamp->NumLayers = MAX_LAYERS+1;
 			}
-			else
+			Stream = (DWORD*)(Stamp+1);
+			LightMap.MaxColor = (FColor*)Stream++;
+			if( Stamp->Time==Frame->Viewport->CurrentTime )
+			{
+				// Already lit this frame.
+				goto SkipDynamicLight;
+			}
+		}
+
+		// Compute the dynamic lights and the layers they'll be merged in as.  Lights
+		// whose illumination maps change by more than their brightness and color
+		// are animated, and so are lights whose maps were invalidated.
+		FLayerStamp Layers;
+		Layers.Time      = Frame->Viewport->CurrentTime;
+		Layers.NumLayers = 0;
+		Layers.Pad       = 0;
+		UBOOL Animated   = StaticLightingChanged;
+		for( FLightInfo* Info=FirstLight; Info<LastLight; Info++ )
+		{
+			if( Info->Opt==ALO_DynamicLight || Info->Opt==ALO_MovingLight )
+			{
+				Info->ComputeFromActor( LightMap, Frame, 1 );
+				if( Layers.NumLayers < MAX_LAYERS )
+				{
+					FLightLayer& Layer = Layers.Layers[Layers.NumLayers];
+					appMemset( &Layer, 0, sizeof(FLightLayer) ); // Padding is compared too.
+					Layer.Actor    = Info->Actor;
+					Layer.Location = Info->Actor->Location;
+					Layer.Rotation = Info->Actor->GetViewRotation();
+					Layer.Color    = Info->FloatColor;
+					Layer.Radius   = Info->Radius;
+					Layer.Shape    = Info->Actor->LightEffect + (Info->Actor->LightCone << 8);
+				}
+				Layers.NumLayers++;
+				FColor& Max = Info->Palette[255];
+				if( Max.R || Max.G || Max.B )
+					Animated |= Info->Effect.IsSpatialDynamic || Info->Effect.IsMergeDynamic || Info->Actor->bLightChanged;
+			}
+		}
+
+		// If the map was last composited from the same layers, it's still good.
+		if( Stamp )
+		{
+			UBOOL Reuse
+			=	!Animated
+			&&	Layers.NumLayers==Stamp->NumLayers
+			&&	appMemcmp( Layers.Layers, Stamp->Layers, Layers.NumLayers*sizeof(FLightLayer) )==0;
+			*Stamp = Layers;
+			if( Animated || Layers.NumLayers>MAX_LAYERS )
+				Stamp->NumLayers = MAX_LAYERS+1;
+			if( Reuse )
 			{
-				*(DOUBLE*)Stream = Frame->Viewport->CurrentTime;
-				Stream += 2;
-				LightMap.MaxColor = (FColor*)Stream++;
+				STAT(GStat.IllumReused++);
 				goto SkipDynamicLight;
 			}
 		}
@@ -1919,43 +2460,40 @@ void FLightManager::SetupForSurf
 			TmpStream += LightMap.USize;
 		}
 
-		// Merge in the dynamic lights.
+		// Merge in the dynamic lights, a batch at a time.
 		FMemMark Mark(GMem);
 		LightMap.TextureFlags |= TF_RealtimeChanged;
 		for( FLightInfo* Info=FirstLight; Info<LastLight; Info++ )
 		{
 			if( Info->Opt==ALO_DynamicLight || Info->Opt==ALO_MovingLight )
 			{	
-				// Set up.
-				BYTE* ShadowMap;
-				Info->ComputeFromActor( LightMap, Frame, 1 );
+				// Dark lights add nothing.
+				FColor& Max = Info->Palette[255];
+				if( !Max.R && !Max.G && !Max.B )
+					continue;
 				if( Info->Opt==ALO_MovingLight )
 				{
-					// Build a temporary shadow map and fill it with max.
-					ShadowMap = New<BYTE>(GMem,ShadowMaskSpace*8);
-					ShadowMapGen( LightMap, NULL, ShadowMap );
-
-					// Build a temporary illumination map.
+					// Build a temporary shadow map filled with max, and a temporary illumination map.
 					Info->IlluminationMap = New<BYTE>(GMem,LightMap.UClamp*LightMap.VClamp);
-					Info->Effect.SpatialFxFunc( LightMap, Info, ShadowMap, Info->IlluminationMap );
+					AddMapJob( Info, NULL, New<BYTE>(GMem,ShadowMaskSpace*8), 1, 1 );
 				}
 				else if( Info->Effect.IsSpatialDynamic )
 				{
 					// This light has spatial effects, so we must cache its shadow map since
 					// we will be generating its illumination map per frame.
 					//note: we use iSurf because only (iLightMap,Actor,Mover) is unique.
-					QWORD CacheID = MakeCacheID( CID_ShadowMap, Draw->iSurf/*iLightMap*/, 0, Info->Actor );
-					ShadowMap = (BYTE *)GCache.Get( CacheID, *TopItemToUnlock++ );
+					QWORD CacheID  = MakeCacheID( CID_ShadowMap, Draw->iSurf/*iLightMap*/, 0, Info->Actor );
+					BYTE* ShadowMap = (BYTE *)GCache.Get( CacheID, *TopItemToUnlock++ );
+					UBOOL NeedShadow = (ShadowMap==NULL);
 					if( !ShadowMap  )
 					{
-						// Create and generate its shadow map.
+						// Create it, to be generated with the batch.
 						ShadowMap = (BYTE *)GCache.Create( CacheID, TopItemToUnlock[-1], ShadowMaskSpace*8 );
-						ShadowMapGen( LightMap, Info->ShadowBits, ShadowMap );
 					}
 
 					// Build a temporary illumination map:
 					Info->IlluminationMap = New<BYTE>(GMem,LightMap.UClamp*LightMap.VClamp);
-					Info->Effect.SpatialFxFunc( LightMap, Info, ShadowMap, Info->IlluminationMap );
+					AddMapJob( Info, Info->ShadowBits, ShadowMap, NeedShadow, 1 );
 				}
 				else
 				{
@@ -1966,22 +2504,24 @@ void FLightManager::SetupForSurf
 					Info->IlluminationMap = (BYTE *)GCache.Get( CacheID, *TopItemToUnlock++ );
 					if( !Info->IlluminationMap || Info->Actor->bLightChanged )
 					{
-						// Build a temporary shadow map.
-						ShadowMap = New<BYTE>(GMem,ShadowMaskSpace*8);
-						ShadowMapGen( LightMap, Info->ShadowBits, ShadowMap );
-
-						// Build and cache an illumination map
+						// Build and cache an illumination map from a temporary shadow map.
 						if( !Info->IlluminationMap )
 							Info->IlluminationMap = (BYTE *)GCache.Create( CacheID, TopItemToUnlock[-1], (LightMap.UClamp*(LightMap.VClamp+1)+1) * sizeof(BYTE) );
-						Info->Effect.SpatialFxFunc( LightMap, Info, ShadowMap, Info->IlluminationMap );
+						AddMapJob( Info, Info->ShadowBits, New<BYTE>(GMem,ShadowMaskSpace*8), 1, 1 );
 					}
+					else AddMapJob( Info, NULL, NULL, 0, 0 );
 				}
 
-				// Merge the illumination map in.
-				Merge( LightMap, Info->Actor->LightEffect, Key, Info, Stream, Stream );
-				Mark.Pop();
+				// Merge the illumination maps in.
+				if( NumMapJobs == MAX_BATCH )
+				{
+					FlushMapJobs( Stream, Key );
+					Mark.Pop();
+				}
 			}
 		}
+		FlushMapJobs( Stream, Key );
+		Mark.Pop();
 		unguard;
 	}
 	SkipDynamicLight:;
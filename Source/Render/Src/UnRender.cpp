@@ -218,6 +218,20 @@ void URender::DrawStats( FSceneNode* Frame )
 	}
 	if( IllumStats )
 	{
+		ShowStat( Frame, StatYL, "ILLUM: %04.1f", GSecondsPerCycle*1000 * GStat.IllumTime );
+		ShowStat
+		(
+			Frame,
+			StatYL,
+			"  Shadow=%04.1f Spatial=%04.1f Merge=%04.1f Fog=%04.1f Setup=%04.1f",
+			GSecondsPerCycle*1000 * GStat.IllumShadowTime,
+			GSecondsPerCycle*1000 * GStat.IllumSpatialTime,
+			GSecondsPerCycle*1000 * GStat.IllumMergeTime,
+			GSecondsPerCycle*1000 * GStat.IllumFogTime,
+			GSecondsPerCycle*1000 * (GStat.IllumTime - GStat.IllumShadowTime - GStat.IllumSpatialTime - GStat.IllumMergeTime - GStat.IllumFogTime)
+		);
+		ShowStat( Frame, StatYL, "  Maps=%i Parallel=%i Reused=%i", GStat.IllumMaps, GStat.IllumParallel, GStat.IllumReused );
+		ShowStat( Frame, StatYL, "" );
 	}
 	if( MeshStats )
 	{